@@ -24,13 +24,53 @@ g_resources.addSearchPath(g_resources.getWorkDir() .. "mods", true)
 -- setup directory for saving configurations
 g_resources.setupUserWriteDir(('%s/'):format(g_app.getCompactName()))
 
+-- keep compiled scripts in the write dir, so later starts skip the lua compiler
+g_lua.setBytecodeCacheEnabled(true)
+
 -- search all packages
 g_resources.searchAndAddPackages('/', '.otpkg', true)
 
+-- fill the bytecode cache for every script and quit, used when packaging
+if g_app.getStartupOptions():find('-precompile-scripts', 1, true) then
+  g_logger.info(('Precompiled %d scripts'):format(g_lua.precompileScripts('/')))
+  g_app.exit()
+  return
+end
+
+-- build native packs of the data and modules directories into packs/ and quit, used when packaging
+-- to compare against the zip path, zip the same directories first, e.g. (cd data && zip -r ../packs/data.zip .),
+-- every packs/<dir>.zip found is benchmarked the same way
+if g_app.getStartupOptions():find('-build-packs', 1, true) then
+  local function benchmark(package, name)
+    local stats = g_resources.benchmarkPackage(package, 3)
+    if stats.files then
+      g_logger.info(('%s: %d files, exists %.2f us, open %.2f us, read %.2f us per file'):format(
+        name, stats.files, stats.existsMicros, stats.openMicros, stats.readMicros))
+    end
+  end
+
+  for _,dir in ipairs({'data', 'modules'}) do
+    local package = g_resources.getWorkDir() .. 'packs/' .. dir .. '.otpkg'
+    if g_resources.createPackage(g_resources.getWorkDir() .. dir, package, 9) then
+      benchmark(package, dir .. '.otpkg')
+    end
+
+    local zip = g_resources.getWorkDir() .. 'packs/' .. dir .. '.zip'
+    local file = io.open(zip, 'rb')
+    if file then
+      file:close()
+      benchmark(zip, dir .. '.zip')
+    end
+  end
+  g_app.exit()
+  return
+end
+
 -- load settings
 g_configs.loadSettings("/config.otml")
 
 g_modules.discoverModules()
+g_modules.preloadModules()
 
 -- libraries modules 0-99
 g_modules.autoLoadModules(99)
@@ -48,6 +88,8 @@ g_modules.ensureModuleLoaded("game_interface")
 -- mods 1000-9999
 g_modules.autoLoadModules(9999)
 
+g_modules.printStartupTimes()
+
 local script = '/' .. g_app.getCompactName() .. 'rc.lua'
 
 if g_resources.fileExists(script) then
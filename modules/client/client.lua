@@ -58,6 +58,9 @@ function init()
 
   g_window.setMinimumSize({ width = 600, height = 480 })
   g_sounds.preload(musicFilename)
+  if g_resources.fileExists('/sounds/preload.txt') then
+    g_sounds.preloadManifest('/sounds/preload.txt')
+  end
 
   -- initialize in fullscreen mode on mobile devices
   if g_window.getPlatformType() == "X11-EGL" then
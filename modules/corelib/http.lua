@@ -0,0 +1,105 @@
+-- @docclass
+HTTP = {}
+
+local pending = {}
+
+local Promise = {}
+Promise.__index = Promise
+
+local function newPromise()
+  return setmetatable({ callbacks = {} }, Promise)
+end
+
+local function settle(promise, ok, value)
+  if promise.settled then return end
+  promise.settled = true
+  promise.ok = ok
+  promise.value = value
+  for _,callback in ipairs(promise.callbacks) do
+    callback()
+  end
+  promise.callbacks = nil
+end
+
+-- onResolve(response) and onReject(error) may return a value or another promise to chain
+function Promise:next(onResolve, onReject)
+  local chained = newPromise()
+  chained.id = self.id
+  chained.request = self.request or self
+  local run = function()
+    local handler = self.ok and onResolve or onReject
+    if not handler then
+      settle(chained, self.ok, self.value)
+      return
+    end
+    local ok, result = pcall(handler, self.value)
+    if not ok then
+      settle(chained, false, result)
+    elseif getmetatable(result) == Promise then
+      result:next(function(value) settle(chained, true, value) end,
+                  function(err) settle(chained, false, err) end)
+    else
+      settle(chained, true, result)
+    end
+  end
+  if self.settled then
+    run()
+  else
+    table.insert(self.callbacks, run)
+  end
+  return chained
+end
+
+function Promise:catch(onReject)
+  return self:next(nil, onReject)
+end
+
+-- cancels the request the promise was chained from, every promise on its chain is rejected with 'canceled'
+function Promise:cancel()
+  local request = self.request or self
+  if request.id and not request.settled and ProtocolHttp.cancel(request.id) then
+    pending[request.id] = nil
+    settle(request, false, 'canceled')
+  end
+end
+
+-- response is { id, status, body, headers }, non 2xx statuses still resolve
+function HTTP.request(method, url, headers, body, outputFile)
+  local promise = newPromise()
+  promise.id = ProtocolHttp.request(method, url, headers or {}, body or '', outputFile or '')
+  pending[promise.id] = promise
+  return promise
+end
+
+function HTTP.get(url, headers)
+  return HTTP.request('GET', url, headers)
+end
+
+function HTTP.post(url, body, headers)
+  return HTTP.request('POST', url, headers, body)
+end
+
+-- the body is written to the file as it arrives and not kept in the response
+function HTTP.download(url, outputFile, headers)
+  return HTTP.request('GET', url, headers, nil, outputFile)
+end
+
+function HTTP.cancelAll()
+  ProtocolHttp.cancelAll()
+  for id,promise in pairs(pending) do
+    settle(promise, false, 'canceled')
+  end
+  pending = {}
+end
+
+function ProtocolHttp.onResponse(id, status, body, headers, err)
+  local promise = pending[id]
+  if not promise then return end
+  pending[id] = nil
+
+  if err and err:len() > 0 then
+    settle(promise, false, err)
+  else
+    settle(promise, true, { id = id, status = status, body = body, headers = headers })
+  end
+end
@@ -340,4 +340,9 @@ ChannelEvent = {
   Exclude = 3,
 }
 
+OtmmCodec = {
+  Zlib = 0,
+  None = 1,
+}
+
 -- @}
@@ -29,6 +29,7 @@
 #include "shadermanager.h"
 #include "spritemanager.h"
 #include "minimap.h"
+#include "pathfinder.h"
 #include <framework/core/configmanager.h>
 
 Client g_client;
@@ -40,6 +41,7 @@ void Client::init(std::vector<std::string>& args)
 
     g_map.init();
     g_minimap.init();
+    g_pathFinder.init();
     g_game.init();
     g_shaders.init();
     g_things.init();
@@ -83,6 +85,7 @@ void Client::init(std::vector<std::string>& args)
 
 void Client::terminate()
 {
+    g_pathFinder.terminate();
     g_creatures.terminate();
     g_game.terminate();
     g_map.terminate();
@@ -223,7 +223,7 @@ void Creature::drawOutfit(const Rect& destRect, bool resize)
     }
 }
 
-void Creature::drawInformation(const Point& point, bool useGray, const Rect& parentRect, int drawFlags)
+void Creature::drawInformation(const Point& point, bool useGray, const Rect& parentRect, int drawFlags, TextBatch *namesBatch)
 {
     if(m_healthPercent < 1) // creature is dead
         return;
@@ -290,9 +290,13 @@ void Creature::drawInformation(const Point& point, bool useGray, const Rect& par
     }
 
     if(drawFlags & Otc::DrawNames) {
-        if(g_painter->getColor() != fillColor)
-            g_painter->setColor(fillColor);
-        m_nameCache.draw(textRect);
+        if(namesBatch)
+            m_nameCache.draw(textRect, *namesBatch, fillColor);
+        else {
+            if(g_painter->getColor() != fillColor)
+                g_painter->setColor(fillColor);
+            m_nameCache.draw(textRect);
+        }
     }
 
     if(m_skull != Otc::SkullNone && m_skullTexture) {
@@ -272,9 +272,11 @@ void Game::processPingBack()
 {
     m_pingReceived++;
 
-    if(m_pingReceived == m_pingSent)
+    if(m_pingReceived == m_pingSent) {
         m_ping = m_pingTimer.elapsed_millis();
-    else
+        if(m_protocolGame && m_protocolGame->getConnection())
+            m_protocolGame->getConnection()->getTelemetry().recordRoundTrip(m_ping);
+    } else
         g_logger.error("got an invalid ping from server");
 
     g_lua.callGlobalField("g_game", "onPingBack", m_ping);
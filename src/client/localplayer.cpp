@@ -24,6 +24,7 @@
 #include "map.h"
 #include "game.h"
 #include "tile.h"
+#include "pathfinder.h"
 #include <framework/core/eventdispatcher.h>
 #include <framework/graphics/graphics.h>
 
@@ -33,6 +34,7 @@ LocalPlayer::LocalPlayer()
     m_vocation = 0;
     m_blessings = Otc::BlessingNone;
     m_walkLockExpiration = 0;
+    m_autoWalkSearch = 0;
 
     m_skillsLevel.fill(-1);
     m_skillsBaseLevel.fill(-1);
@@ -175,35 +177,69 @@ bool LocalPlayer::autoWalk(const Position& destination)
         tryKnownPath = true;
     }
 
-    std::tuple<std::vector<Otc::Direction>, Otc::PathFindResult> result;
-    std::vector<Otc::Direction> limitedPath;
-
     if(destination == m_position)
         return true;
 
-    // try to find a path that we know
-    if(tryKnownPath || m_knownCompletePath) {
-        result = g_map.findPath(m_position, destination, 50000, 0);
-        if(std::get<1>(result) == Otc::PathFindResultOk) {
-            limitedPath = std::get<0>(result);
-            // limit to 127 steps
-            if(limitedPath.size() > 127)
-                limitedPath.resize(127);
-            m_knownCompletePath = true;
-        }
+    if(m_autoWalkSearch) {
+        g_pathFinder.cancel(m_autoWalkSearch);
+        m_autoWalkSearch = 0;
     }
 
-    // no known path found, try to discover one
-    if(limitedPath.empty()) {
-        result = g_map.findPath(m_position, destination, 50000, Otc::PathFindAllowNotSeenTiles);
-        if(std::get<1>(result) != Otc::PathFindResultOk) {
-            callLuaField("onAutoWalkFail", std::get<1>(result));
+    // the search runs on the pathfinder workers, walking starts when the path arrives
+    m_autoWalkDestination = destination;
+    findAutoWalkPath(tryKnownPath || m_knownCompletePath);
+    return true;
+}
+
+void LocalPlayer::findAutoWalkPath(bool knownPath)
+{
+    auto self = asLocalPlayer();
+    Position start = m_position;
+    Position destination = m_autoWalkDestination;
+    int flags = knownPath ? 0 : Otc::PathFindAllowNotSeenTiles;
+    m_autoWalkSearch = g_pathFinder.findPath(start, destination, 50000, flags,
+        [self, start, destination, knownPath](uint, std::vector<Otc::Direction> dirs, Otc::PathFindResult result) {
+            self->onAutoWalkPath(start, destination, knownPath, dirs, result);
+        });
+}
+
+void LocalPlayer::onAutoWalkPath(const Position& start, const Position& destination, bool knownPath,
+                                 const std::vector<Otc::Direction>& dirs, Otc::PathFindResult result)
+{
+    m_autoWalkSearch = 0;
+
+    // stopped or sent elsewhere while searching
+    if(destination != m_autoWalkDestination)
+        return;
+
+    // moved while searching, the path no longer starts here
+    if(start != m_position) {
+        autoWalk(destination);
+        return;
+    }
+
+    std::vector<Otc::Direction> limitedPath;
+    if(knownPath) {
+        // no known path found, try to discover one
+        if(result != Otc::PathFindResultOk) {
+            findAutoWalkPath(false);
+            return;
+        }
+
+        limitedPath = dirs;
+        // limit to 127 steps
+        if(limitedPath.size() > 127)
+            limitedPath.resize(127);
+        m_knownCompletePath = true;
+    } else {
+        if(result != Otc::PathFindResultOk) {
+            callLuaField("onAutoWalkFail", result);
             stopAutoWalk();
-            return false;
+            return;
         }
 
         Position currentPos = m_position;
-        for(auto dir : std::get<0>(result)) {
+        for(auto dir : dirs) {
             currentPos = currentPos.translatedToDirection(dir);
             if(!hasSight(currentPos))
                 break;
@@ -212,7 +248,6 @@ bool LocalPlayer::autoWalk(const Position& destination)
         }
     }
 
-    m_autoWalkDestination = destination;
     m_lastAutoWalkPosition = m_position.translatedToDirections(limitedPath).back();
 
     /*
@@ -224,7 +259,6 @@ bool LocalPlayer::autoWalk(const Position& destination)
     */
 
     g_game.autoWalk(limitedPath);
-    return true;
 }
 
 void LocalPlayer::stopAutoWalk()
@@ -233,6 +267,11 @@ void LocalPlayer::stopAutoWalk()
     m_lastAutoWalkPosition = Position();
     m_knownCompletePath = false;
 
+    if(m_autoWalkSearch) {
+        g_pathFinder.cancel(m_autoWalkSearch);
+        m_autoWalkSearch = 0;
+    }
+
     if(m_autoWalkContinueEvent)
         m_autoWalkContinueEvent->cancel();
 }
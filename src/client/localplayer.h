@@ -117,12 +117,17 @@ protected:
     void terminateWalk();
 
 private:
+    void findAutoWalkPath(bool knownPath);
+    void onAutoWalkPath(const Position& start, const Position& destination, bool knownPath,
+                        const std::vector<Otc::Direction>& dirs, Otc::PathFindResult result);
+
     // walk related
     Position m_lastPrewalkDestination;
     Position m_autoWalkDestination;
     Position m_lastAutoWalkPosition;
     ScheduledEventPtr m_serverWalkEndEvent;
     ScheduledEventPtr m_autoWalkContinueEvent;
+    uint m_autoWalkSearch; // pending g_pathFinder query, 0 when none
     ticks_t m_walkLockExpiration;
     stdext::boolean<false> m_preWalking;
     stdext::boolean<true> m_lastPrewalkDone;
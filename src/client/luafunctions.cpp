@@ -37,6 +37,7 @@
 #include "localplayer.h"
 #include "map.h"
 #include "minimap.h"
+#include "pathfinder.h"
 #include "thingtypemanager.h"
 #include "spritemanager.h"
 #include "shadermanager.h"
@@ -60,6 +61,8 @@ void Client::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_things", "loadOtb", &ThingTypeManager::loadOtb, &g_things);
     g_lua.bindSingletonFunction("g_things", "loadXml", &ThingTypeManager::loadXml, &g_things);
     g_lua.bindSingletonFunction("g_things", "loadOtml", &ThingTypeManager::loadOtml, &g_things);
+    g_lua.bindSingletonFunction("g_things", "setDatCacheEnabled", &ThingTypeManager::setDatCacheEnabled, &g_things);
+    g_lua.bindSingletonFunction("g_things", "isDatCacheEnabled", &ThingTypeManager::isDatCacheEnabled, &g_things);
     g_lua.bindSingletonFunction("g_things", "isDatLoaded", &ThingTypeManager::isDatLoaded, &g_things);
     g_lua.bindSingletonFunction("g_things", "isOtbLoaded", &ThingTypeManager::isOtbLoaded, &g_things);
     g_lua.bindSingletonFunction("g_things", "getDatSignature", &ThingTypeManager::getDatSignature, &g_things);
@@ -71,6 +74,7 @@ void Client::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_things", "findItemTypeByName", &ThingTypeManager::findItemTypeByName, &g_things);
     g_lua.bindSingletonFunction("g_things", "findItemTypesByName", &ThingTypeManager::findItemTypesByName, &g_things);
     g_lua.bindSingletonFunction("g_things", "findItemTypesByString", &ThingTypeManager::findItemTypesByString, &g_things);
+    g_lua.bindSingletonFunction("g_things", "searchItemTypes", &ThingTypeManager::searchItemTypes, &g_things);
     g_lua.bindSingletonFunction("g_things", "findItemTypeByCategory", &ThingTypeManager::findItemTypeByCategory, &g_things);
     g_lua.bindSingletonFunction("g_things", "findThingTypeByAttr", &ThingTypeManager::findThingTypeByAttr, &g_things);
 
@@ -160,6 +164,29 @@ void Client::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_minimap", "saveImage", &Minimap::saveImage, &g_minimap);
     g_lua.bindSingletonFunction("g_minimap", "loadOtmm", &Minimap::loadOtmm, &g_minimap);
     g_lua.bindSingletonFunction("g_minimap", "saveOtmm", &Minimap::saveOtmm, &g_minimap);
+    g_lua.bindSingletonFunction("g_minimap", "setOtmmCodec", &Minimap::setOtmmCodec, &g_minimap);
+    g_lua.bindSingletonFunction("g_minimap", "setOtmmCompressionLevel", &Minimap::setOtmmCompressionLevel, &g_minimap);
+    g_lua.bindSingletonFunction("g_minimap", "setMaxTextures", &Minimap::setMaxTextures, &g_minimap);
+    g_lua.bindSingletonFunction("g_minimap", "getMaxTextures", &Minimap::getMaxTextures, &g_minimap);
+    g_lua.bindSingletonFunction("g_minimap", "getTextureCount", &Minimap::getTextureCount, &g_minimap);
+    g_lua.bindSingletonFunction("g_minimap", "getTextureMemory", &Minimap::getTextureMemory, &g_minimap);
+
+    g_lua.registerSingletonClass("g_pathFinder");
+    g_lua.bindSingletonFunction("g_pathFinder", "findPath", &PathFinder::findPath, &g_pathFinder);
+    g_lua.bindSingletonFunction("g_pathFinder", "findPaths", &PathFinder::findPaths, &g_pathFinder);
+    g_lua.bindSingletonFunction("g_pathFinder", "cancel", &PathFinder::cancel, &g_pathFinder);
+    g_lua.bindSingletonFunction("g_pathFinder", "cancelAll", &PathFinder::cancelAll, &g_pathFinder);
+    g_lua.bindSingletonFunction("g_pathFinder", "invalidate", &PathFinder::invalidate, &g_pathFinder);
+    g_lua.bindSingletonFunction("g_pathFinder", "clearCache", &PathFinder::clearCache, &g_pathFinder);
+    g_lua.bindSingletonFunction("g_pathFinder", "setCacheTime", &PathFinder::setCacheTime, &g_pathFinder);
+    g_lua.bindSingletonFunction("g_pathFinder", "getCacheTime", &PathFinder::getCacheTime, &g_pathFinder);
+    g_lua.bindSingletonFunction("g_pathFinder", "getPendingCount", &PathFinder::getPendingCount, &g_pathFinder);
+    g_lua.bindSingletonFunction("g_pathFinder", "getCacheSize", &PathFinder::getCacheSize, &g_pathFinder);
+    g_lua.bindSingletonFunction("g_pathFinder", "getCacheHits", &PathFinder::getCacheHits, &g_pathFinder);
+    g_lua.bindSingletonFunction("g_pathFinder", "getCacheMisses", &PathFinder::getCacheMisses, &g_pathFinder);
+    g_lua.bindSingletonFunction("g_pathFinder", "getSearchCount", &PathFinder::getSearchCount, &g_pathFinder);
+    g_lua.bindSingletonFunction("g_pathFinder", "getSearchTime", &PathFinder::getSearchTime, &g_pathFinder);
+    g_lua.bindSingletonFunction("g_pathFinder", "resetStats", &PathFinder::resetStats, &g_pathFinder);
 
     g_lua.registerSingletonClass("g_creatures");
     g_lua.bindSingletonFunction("g_creatures", "getCreatures", &CreatureManager::getCreatures, &g_creatures);
@@ -326,6 +353,10 @@ void Client::registerLuaFunctions()
     g_lua.bindClassStaticFunction<ProtocolGame>("create", []{ return ProtocolGamePtr(new ProtocolGame); });
     g_lua.bindClassMemberFunction<ProtocolGame>("login", &ProtocolGame::login);
     g_lua.bindClassMemberFunction<ProtocolGame>("sendExtendedOpcode", &ProtocolGame::sendExtendedOpcode);
+    g_lua.bindClassMemberFunction<ProtocolGame>("flushSendQueue", &ProtocolGame::flushSendQueue);
+    g_lua.bindClassMemberFunction<ProtocolGame>("setSendRateLimit", &ProtocolGame::setSendRateLimit);
+    g_lua.bindClassMemberFunction<ProtocolGame>("getSendStats", &ProtocolGame::getSendStats);
+    g_lua.bindClassMemberFunction<ProtocolGame>("resetSendStats", &ProtocolGame::resetSendStats);
     g_lua.bindClassMemberFunction<ProtocolGame>("addPosition", &ProtocolGame::addPosition);
     g_lua.bindClassMemberFunction<ProtocolGame>("setMapDescription", &ProtocolGame::setMapDescription);
     g_lua.bindClassMemberFunction<ProtocolGame>("setFloorDescription", &ProtocolGame::setFloorDescription);
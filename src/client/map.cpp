@@ -29,6 +29,7 @@
 #include "statictext.h"
 #include "mapview.h"
 #include "minimap.h"
+#include "pathfinder.h"
 
 #include <framework/core/eventdispatcher.h>
 #include <framework/core/application.h>
@@ -67,6 +68,7 @@ void Map::notificateTileUpdate(const Position& pos)
     for(const MapViewPtr& mapView : m_mapViews)
         mapView->onTileUpdate(pos);
     g_minimap.updateTile(pos, getTile(pos));
+    g_pathFinder.invalidate(pos);
 }
 
 void Map::clean()
@@ -77,6 +79,7 @@ void Map::clean()
         m_tileBlocks[i].clear();
 
     m_waypoints.clear();
+    g_pathFinder.clearCache();
 
     g_towns.clear();
     g_houses.clear();
@@ -712,7 +715,29 @@ int Map::getLastAwareFloor()
         return Otc::SEA_FLOOR;
 }
 
+PathFindTile Map::getPathFindTile(const Position& pos)
+{
+    PathFindTile ret;
+    if(isAwareOfPosition(pos)) {
+        ret.wasSeen = true;
+        if(const TilePtr& tile = getTile(pos)) {
+            ret.hasCreature = tile->hasCreature();
+            ret.isNotWalkable = !tile->isWalkable();
+            ret.isNotPathable = !tile->isPathable();
+            ret.speed = tile->getGroundSpeed();
+        }
+    } else
+        ret = PathFindTile(g_minimap.getTile(pos));
+    return ret;
+}
+
 std::tuple<std::vector<Otc::Direction>, Otc::PathFindResult> Map::findPath(const Position& startPos, const Position& goalPos, int maxComplexity, int flags)
+{
+    return searchPath(startPos, goalPos, maxComplexity, flags, [this](const Position& pos) { return getPathFindTile(pos); });
+}
+
+std::tuple<std::vector<Otc::Direction>, Otc::PathFindResult> Map::searchPath(const Position& startPos, const Position& goalPos, int maxComplexity, int flags,
+                                                                             const PathFindTileGetter& getPathTile, const std::atomic<bool>* canceled)
 {
     // pathfinding using A* search algorithm
     // as described in http://en.wikipedia.org/wiki/A*_search_algorithm
@@ -749,18 +774,8 @@ std::tuple<std::vector<Otc::Direction>, Otc::PathFindResult> Map::findPath(const
     }
 
     // check the goal pos is walkable
-    if(g_map.isAwareOfPosition(goalPos)) {
-        const TilePtr goalTile = getTile(goalPos);
-        if(!goalTile || !goalTile->isWalkable()) {
-            return ret;
-        }
-    }
-    else {
-        const MinimapTile& goalTile = g_minimap.getTile(goalPos);
-        if(goalTile.hasFlag(MinimapTileNotWalkable)) {
-            return ret;
-        }
-    }
+    if(getPathTile(goalPos).isNotWalkable)
+        return ret;
 
     std::unordered_map<Position, Node*, PositionHasher> nodes;
     std::priority_queue<std::pair<Node*, float>, std::vector<std::pair<Node*, float>>, LessNode> searchList;
@@ -769,12 +784,19 @@ std::tuple<std::vector<Otc::Direction>, Otc::PathFindResult> Map::findPath(const
     currentNode->pos = startPos;
     nodes[startPos] = currentNode;
     Node *foundNode = nullptr;
+    uint iterations = 0;
     while(currentNode) {
         if((int)nodes.size() > maxComplexity) {
             result = Otc::PathFindResultTooFar;
             break;
         }
 
+        // abandoned by the caller, checked every few hundred nodes only
+        if(canceled && (++iterations & 255) == 0 && canceled->load(std::memory_order_relaxed)) {
+            foundNode = nullptr;
+            break;
+        }
+
         // path found
         if(currentNode->pos == goalPos && (!foundNode || currentNode->cost < foundNode->cost))
             foundNode = currentNode;
@@ -788,30 +810,13 @@ std::tuple<std::vector<Otc::Direction>, Otc::PathFindResult> Map::findPath(const
                 if(i == 0 && j == 0)
                     continue;
 
-                bool wasSeen = false;
-                bool hasCreature = false;
-                bool isNotWalkable = true;
-                bool isNotPathable = true;
-                int speed = 100;
-
                 Position neighborPos = currentNode->pos.translated(i, j);
-                if(g_map.isAwareOfPosition(neighborPos)) {
-                    wasSeen = true;
-                    if(const TilePtr& tile = getTile(neighborPos)) {
-                        hasCreature = tile->hasCreature();
-                        isNotWalkable = !tile->isWalkable();
-                        isNotPathable = !tile->isPathable();
-                        speed = tile->getGroundSpeed();
-                    }
-                } else {
-                    const MinimapTile& mtile = g_minimap.getTile(neighborPos);
-                    wasSeen = mtile.hasFlag(MinimapTileWasSeen);
-                    isNotWalkable = mtile.hasFlag(MinimapTileNotWalkable);
-                    isNotPathable = mtile.hasFlag(MinimapTileNotPathable);
-                    if(isNotWalkable || isNotPathable)
-                        wasSeen = true;
-                    speed = mtile.getSpeed();
-                }
+                const PathFindTile pathTile = getPathTile(neighborPos);
+                const bool wasSeen = pathTile.wasSeen;
+                const bool hasCreature = pathTile.hasCreature;
+                const bool isNotWalkable = pathTile.isNotWalkable;
+                const bool isNotPathable = pathTile.isNotPathable;
+                const int speed = pathTile.speed;
 
                 float walkFactor = 0;
                 if(neighborPos != goalPos) {
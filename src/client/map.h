@@ -30,6 +30,7 @@
 #include "animatedtext.h"
 #include "statictext.h"
 #include "tile.h"
+#include "minimap.h"
 
 #include <framework/core/clock.h>
 
@@ -135,6 +136,26 @@ struct AwareRange
     int vertical() { return top + bottom + 1; }
 };
 
+// what the pathfinder needs to know about a tile, from the live map or the minimap
+struct PathFindTile
+{
+    PathFindTile() : wasSeen(false), hasCreature(false), isNotWalkable(true), isNotPathable(true), speed(100) { }
+    explicit PathFindTile(const MinimapTile& mtile) : hasCreature(false) {
+        isNotWalkable = mtile.hasFlag(MinimapTileNotWalkable);
+        isNotPathable = mtile.hasFlag(MinimapTileNotPathable);
+        wasSeen = mtile.hasFlag(MinimapTileWasSeen) || isNotWalkable || isNotPathable;
+        speed = mtile.getSpeed();
+    }
+
+    bool wasSeen;
+    bool hasCreature;
+    bool isNotWalkable;
+    bool isNotPathable;
+    int speed;
+};
+
+typedef std::function<PathFindTile(const Position&)> PathFindTileGetter;
+
 //@bindsingleton g_map
 class Map
 {
@@ -242,6 +263,11 @@ public:
     std::vector<StaticTextPtr> getStaticTexts() { return m_staticTexts; }
 
     std::tuple<std::vector<Otc::Direction>, Otc::PathFindResult> findPath(const Position& start, const Position& goal, int maxComplexity, int flags = 0);
+    PathFindTile getPathFindTile(const Position& pos);
+
+    // A* search over any tile source, safe to run outside the main thread when the getter is
+    static std::tuple<std::vector<Otc::Direction>, Otc::PathFindResult> searchPath(const Position& start, const Position& goal, int maxComplexity, int flags,
+                                                                                   const PathFindTileGetter& getPathTile, const std::atomic<bool>* canceled = nullptr);
 
 private:
     void removeUnawareThings();
@@ -235,8 +235,11 @@ void MapView::draw(const Rect& rect)
             if(m_drawNames){ flags = Otc::DrawNames; }
             if(m_drawHealthBars) { flags |= Otc::DrawBars; }
             if(m_drawManaBar) { flags |= Otc::DrawManaBar; }
-            creature->drawInformation(p, g_map.isCovered(pos, m_cachedFirstVisibleFloor), rect, flags);
+            creature->drawInformation(p, g_map.isCovered(pos, m_cachedFirstVisibleFloor), rect, flags, &m_namesBatch);
         }
+
+        // names share one font, so they are drawn together above every bar
+        m_namesBatch.flush();
     }
 
     // lights are drawn after names and before texts
@@ -25,6 +25,7 @@
 
 #include "declarations.h"
 #include <framework/graphics/paintershaderprogram.h>
+#include <framework/graphics/textbatch.h>
 #include <framework/graphics/declarations.h>
 #include <framework/luaengine/luaobject.h>
 #include <framework/core/declarations.h>
@@ -162,6 +163,7 @@ private:
     stdext::boolean<true> m_follow;
     std::vector<TilePtr> m_cachedVisibleTiles;
     std::vector<CreaturePtr> m_cachedFloorVisibleCreatures;
+    TextBatch m_namesBatch;
     CreaturePtr m_followingCreature;
     FrameBufferPtr m_framebuffer;
     PainterShaderProgramPtr m_shader;
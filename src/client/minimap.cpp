@@ -23,6 +23,7 @@
 
 #include "minimap.h"
 #include "tile.h"
+#include "pathfinder.h"
 
 #include <framework/graphics/image.h>
 #include <framework/graphics/texture.h>
@@ -31,71 +32,230 @@
 #include <framework/graphics/framebuffermanager.h>
 #include <framework/core/resourcemanager.h>
 #include <framework/core/filestream.h>
+#include <framework/core/asyncdispatcher.h>
+#include <framework/core/application.h>
 #include <zlib.h>
 
 Minimap g_minimap;
 
+enum {
+    OTMM_RECORD_HEADER_SIZE = 7, // x, y, z and data length
+    OTMM_BLOCKS_PER_TASK = 64
+};
+
+struct OtmmRecord {
+    Position pos;
+    MinimapBlock *block;
+    std::vector<uchar> data;
+    bool ok;
+};
+
 void MinimapBlock::clean()
 {
     m_tiles.fill(MinimapTile());
-    m_texture.reset();
-    m_mustUpdate = false;
+    m_mustUpdate = true;
 }
 
-void MinimapBlock::update()
+bool MinimapBlock::updateImage(const ImagePtr& image, const std::array<uint32, 256>& palette)
 {
-    if(!m_mustUpdate)
-        return;
-
-    ImagePtr image(new Image(Size(MMBLOCK_SIZE, MMBLOCK_SIZE)));
-
+    uint32 *pixels = (uint32*)image->getPixelData();
     bool shouldDraw = false;
-    for(int x=0;x<MMBLOCK_SIZE;++x) {
-        for(int y=0;y<MMBLOCK_SIZE;++y) {
-            uint8 c = getTile(x, y).color;
-            uint32 col;
-            if(c != 255) {
-                col = Color::from8bit(c).rgba();
-                shouldDraw = true;
-            } else
-                col = Color::alpha.rgba();
-            image->setPixel(x, y, col);
-        }
+    for(uint i = 0; i < m_tiles.size(); ++i) {
+        uint8 c = m_tiles[i].color;
+        pixels[i] = palette[c];
+        shouldDraw |= c != 255;
     }
-
-    if(shouldDraw) {
-        if(!m_texture) {
-            m_texture = TexturePtr(new Texture(image, true));
-        } else {
-            m_texture->uploadPixels(image, true);
-        }
-    } else
-        m_texture.reset();
-
     m_mustUpdate = false;
+    return shouldDraw;
 }
 
 void MinimapBlock::updateTile(int x, int y, const MinimapTile& tile)
 {
-    if(m_tiles[getTileIndex(x,y)].color != tile.color)
+    MinimapTile& current = m_tiles[getTileIndex(x,y)];
+    if(current.color != tile.color)
         m_mustUpdate = true;
+    if(current != tile)
+        m_mustSave = true;
 
-    m_tiles[getTileIndex(x,y)] = tile;
+    current = tile;
 }
 
 void Minimap::init()
 {
+    for(int c = 0; c < 256; ++c)
+        m_palette[c] = c == 255 ? Color::alpha.rgba() : Color::from8bit(c).rgba();
+    m_blockImage = ImagePtr(new Image(Size(MMBLOCK_SIZE, MMBLOCK_SIZE)));
+    m_maxTextures = MMBLOCK_MAX_TEXTURES;
+    m_otmmCodec = OtmmCodecZlib;
+    m_otmmCompressionLevel = 3;
+    m_otmmFileCodec = OtmmCodecZlib;
+    m_otmmFileBytes = 0;
+    m_otmmLiveBytes = 0;
 }
 
 void Minimap::terminate()
 {
     clean();
+    m_blockImage = nullptr;
 }
 
 void Minimap::clean()
 {
-    for(int i=0;i<=Otc::MAX_Z;++i)
+    finishOtmmSaves(true);
+    m_textureBlocks.clear();
+    m_freeTextures.clear();
+    m_otmmFile.clear();
+    m_otmmFileBytes = 0;
+    m_otmmLiveBytes = 0;
+    for(int i=0;i<=Otc::MAX_Z;++i) {
         m_tileBlocks[i].clear();
+        for(int level=1;level<MMBLOCK_LEVELS;++level)
+            m_superBlocks[level-1][i].clear();
+    }
+}
+
+void Minimap::setMaxTextures(int maxTextures)
+{
+    m_maxTextures = std::max<int>(maxTextures, 1);
+    m_freeTextures.clear();
+    while(m_textureBlocks.size() > m_maxTextures) {
+        MinimapBlock& block = *m_textureBlocks.back();
+        releaseBlockTexture(block);
+        block.mustUpdate();
+    }
+}
+
+void Minimap::setOtmmCodec(int codec)
+{
+    // the codec ends up in the file header, loadOtmm refuses anything it doesn't know
+    if(codec != OtmmCodecZlib && codec != OtmmCodecNone) {
+        g_logger.traceError(stdext::format("invalid OTMM codec %d", codec));
+        return;
+    }
+    m_otmmCodec = codec;
+}
+
+const TexturePtr& Minimap::updateBlockTexture(MinimapBlock& block)
+{
+    if(block.m_texture)
+        m_textureBlocks.splice(m_textureBlocks.begin(), m_textureBlocks, block.m_textureIt);
+
+    if(!block.m_mustUpdate)
+        return block.m_texture;
+
+    if(!block.updateImage(m_blockImage, m_palette)) {
+        releaseBlockTexture(block);
+        return block.m_texture;
+    }
+
+    if(!block.m_texture) {
+        // recycle a texture from the pool, evicting the least recently drawn block when it's full
+        if(m_freeTextures.empty() && m_textureBlocks.size() >= m_maxTextures) {
+            MinimapBlock& lruBlock = *m_textureBlocks.back();
+            releaseBlockTexture(lruBlock);
+            lruBlock.mustUpdate(); // regenerated from its tiles next time it is drawn
+        }
+
+        if(!m_freeTextures.empty()) {
+            block.m_texture = m_freeTextures.back();
+            m_freeTextures.pop_back();
+        } else
+            block.m_texture = TexturePtr(new Texture(Size(MMBLOCK_SIZE, MMBLOCK_SIZE)));
+        m_textureBlocks.push_front(&block);
+        block.m_textureIt = m_textureBlocks.begin();
+    }
+
+    // building mipmaps shrinks the uploaded image, so the shared block image is never handed over
+    ImagePtr image(new Image(m_blockImage->getSize(), m_blockImage->getBpp(), m_blockImage->getPixelData()));
+    block.m_texture->uploadPixels(image, true);
+    return block.m_texture;
+}
+
+void Minimap::releaseBlockTexture(MinimapBlock& block)
+{
+    if(!block.m_texture)
+        return;
+
+    m_textureBlocks.erase(block.m_textureIt);
+    if(m_textureBlocks.size() + m_freeTextures.size() < m_maxTextures)
+        m_freeTextures.push_back(block.m_texture);
+    block.m_texture = nullptr;
+}
+
+void Minimap::invalidateSuperBlocks(const Position& pos)
+{
+    for(int level = 1; level < MMBLOCK_LEVELS; ++level)
+        m_superBlocks[level-1][pos.z][getLevelBlockIndex(pos, level)].m_mustResample = true;
+}
+
+MinimapBlock* Minimap::getSuperBlock(int level, uint index, int z)
+{
+    auto& blocks = m_superBlocks[level-1][z];
+    auto it = blocks.find(index);
+    if(it == blocks.end())
+        return nullptr;
+
+    MinimapBlock& block = it->second;
+    if(!block.m_mustResample)
+        return &block;
+
+    // every child block is shrunk into a square of this block, keeping the first colored tile of each group
+    const int childSize = getLevelBlockSize(level-1);
+    const int childPixels = MMBLOCK_SIZE / MMBLOCK_LEVEL_FACTOR;
+    Position origin = getLevelIndexPosition(index, z, level);
+    for(int cy = 0; cy < MMBLOCK_LEVEL_FACTOR; ++cy) {
+        for(int cx = 0; cx < MMBLOCK_LEVEL_FACTOR; ++cx) {
+            Position childPos(origin.x + cx * childSize, origin.y + cy * childSize, z);
+            MinimapBlock *child = nullptr;
+            if(level == 1) {
+                if(hasBlock(childPos))
+                    child = &getBlock(childPos);
+            } else
+                child = getSuperBlock(level-1, getLevelBlockIndex(childPos, level-1), z);
+
+            for(int py = 0; py < childPixels; ++py) {
+                for(int px = 0; px < childPixels; ++px) {
+                    MinimapTile tile;
+                    if(child) {
+                        for(int i = 0; i < MMBLOCK_LEVEL_FACTOR * MMBLOCK_LEVEL_FACTOR; ++i) {
+                            const MinimapTile& childTile = child->getTile(px * MMBLOCK_LEVEL_FACTOR + i % MMBLOCK_LEVEL_FACTOR,
+                                                                          py * MMBLOCK_LEVEL_FACTOR + i / MMBLOCK_LEVEL_FACTOR);
+                            if(childTile.color != 255) {
+                                tile = childTile;
+                                break;
+                            }
+                        }
+                    }
+                    block.getTile(cx * childPixels + px, cy * childPixels + py) = tile;
+                }
+            }
+        }
+    }
+
+    block.m_mustResample = false;
+    block.mustUpdate();
+    return &block;
+}
+
+int Minimap::getLevelForScale(float scale)
+{
+    // use the coarsest level whose pixels are still no bigger than a screen pixel
+    int level = 0;
+    while(level + 1 < MMBLOCK_LEVELS && (getLevelBlockSize(level + 1) / MMBLOCK_SIZE) * scale <= 1.0f)
+        level++;
+    return level;
+}
+
+uint Minimap::getLevelBlockIndex(const Position& pos, int level)
+{
+    int size = getLevelBlockSize(level);
+    return ((pos.y / size) * (65536 / size)) + (pos.x / size);
+}
+
+Position Minimap::getLevelIndexPosition(uint index, int z, int level)
+{
+    int size = getLevelBlockSize(level);
+    return Position((index % (65536 / size)) * size, (index / (65536 / size)) * size, z);
 }
 
 void Minimap::draw(const Rect& screenRect, const Position& mapCenter, float scale, const Color& color)
@@ -110,39 +270,46 @@ void Minimap::draw(const Rect& screenRect, const Position& mapCenter, float scal
     g_painter->resetColor();
     g_painter->setClipRect(screenRect);
 
-    if(MMBLOCK_SIZE*scale <= 1 || !mapCenter.isMapPosition()) {
+    int level = getLevelForScale(scale);
+    int blockSize = getLevelBlockSize(level);
+    if(blockSize*scale <= 1 || !mapCenter.isMapPosition()) {
         g_painter->restoreSavedState();
         return;
     }
 
-    Point blockOff = getBlockOffset(mapRect.topLeft());
+    Point blockOff = Point(mapRect.left() - mapRect.left() % blockSize, mapRect.top() - mapRect.top() % blockSize);
     Point off = Point((mapRect.size() * scale).toPoint() - screenRect.size().toPoint())/2;
     Point start = screenRect.topLeft() -(mapRect.topLeft() - blockOff)*scale - off;
 
-    for(int y = blockOff.y, ys = start.y;ys<screenRect.bottom();y += MMBLOCK_SIZE, ys += MMBLOCK_SIZE*scale) {
+    for(int y = blockOff.y, ys = start.y;ys<screenRect.bottom();y += blockSize, ys += blockSize*scale) {
         if(y < 0 || y >= 65536)
             continue;
 
-        for(int x = blockOff.x, xs = start.x;xs<screenRect.right();x += MMBLOCK_SIZE, xs += MMBLOCK_SIZE*scale) {
+        for(int x = blockOff.x, xs = start.x;xs<screenRect.right();x += blockSize, xs += blockSize*scale) {
             if(x < 0 || x >= 65536)
                 continue;
 
             Position blockPos(x, y, mapCenter.z);
-            if(!hasBlock(blockPos))
-                continue;
-
-            MinimapBlock& block = getBlock(Position(x, y, mapCenter.z));
-            block.update();
+            MinimapBlock *block;
+            if(level == 0) {
+                if(!hasBlock(blockPos))
+                    continue;
+                block = &getBlock(blockPos);
+            } else {
+                block = getSuperBlock(level, getLevelBlockIndex(blockPos, level), mapCenter.z);
+                if(!block)
+                    continue;
+            }
 
-            const TexturePtr& tex = block.getTexture();
+            const TexturePtr& tex = updateBlockTexture(*block);
             if(tex) {
                 Rect src(0, 0, MMBLOCK_SIZE, MMBLOCK_SIZE);
-                Rect dest(Point(xs,ys), src.size() * scale);
+                Rect dest(Point(xs,ys), Size(blockSize, blockSize) * scale);
 
-                tex->setSmooth(scale < 1.0f);
+                tex->setSmooth((blockSize / MMBLOCK_SIZE) * scale < 1.0f);
                 g_painter->drawTexturedRect(dest, tex, src);
             }
-            //g_painter->drawBoundingRect(Rect(xs,ys, MMBLOCK_SIZE * scale, MMBLOCK_SIZE * scale));
+            //g_painter->drawBoundingRect(Rect(xs,ys, blockSize * scale, blockSize * scale));
         }
     }
 
@@ -206,8 +373,11 @@ void Minimap::updateTile(const Position& pos, const TilePtr& tile)
     if(minimapTile != MinimapTile()) {
         MinimapBlock& block = getBlock(pos);
         Point offsetPos = getBlockOffset(Point(pos.x, pos.y));
+        bool colorChanged = block.getTile(pos.x - offsetPos.x, pos.y - offsetPos.y).color != minimapTile.color;
         block.updateTile(pos.x - offsetPos.x, pos.y - offsetPos.y, minimapTile);
         block.justSaw();
+        if(colorChanged)
+            invalidateSuperBlocks(pos);
     }
 }
 
@@ -222,6 +392,27 @@ const MinimapTile& Minimap::getTile(const Position& pos)
     return nulltile;
 }
 
+bool Minimap::copyBlockTiles(const Position& pos, std::array<MinimapTile, MMBLOCK_SIZE *MMBLOCK_SIZE>& tiles)
+{
+    if(pos.z > Otc::MAX_Z || !hasBlock(pos))
+        return false;
+    tiles = getBlock(pos).getTiles();
+    return true;
+}
+
+std::vector<Position> Minimap::getBlockPositions(int z, const Rect& area)
+{
+    std::vector<Position> positions;
+    if(z < 0 || z > Otc::MAX_Z)
+        return positions;
+    for(auto& it : m_tileBlocks[z]) {
+        Position pos = getIndexPosition(it.first, z);
+        if(area.intersects(Rect(pos.x, pos.y, MMBLOCK_SIZE, MMBLOCK_SIZE)))
+            positions.push_back(pos);
+    }
+    return positions;
+}
+
 bool Minimap::loadImage(const std::string& fileName, const Position& topLeft, float colorFactor)
 {
     if(colorFactor <= 0.01f)
@@ -288,9 +479,11 @@ bool Minimap::loadImage(const std::string& fileName, const Position& topLeft, fl
                     tile.color = c;
                     tile.flags = flags;
                     block.mustUpdate();
+                    invalidateSuperBlocks(pos);
                 }
             }
         }
+        g_pathFinder.clearCache();
         return true;
     } catch(stdext::exception& e) {
         g_logger.error(stdext::format("failed to load OTMM minimap: %s", e.what()));
@@ -305,6 +498,9 @@ void Minimap::saveImage(const std::string& fileName, const Rect& mapRect)
 
 bool Minimap::loadOtmm(const std::string& fileName)
 {
+    // the file may still be being written
+    finishOtmmSaves(true);
+
     try {
         FileStreamPtr fin = g_resources.openFile(fileName);
         if(!fin)
@@ -318,24 +514,41 @@ bool Minimap::loadOtmm(const std::string& fileName)
 
         uint16 start = fin->getU16();
         uint16 version = fin->getU16();
-        fin->getU32(); // flags
+        uint32 flags = fin->getU32();
 
+        int codec = OtmmCodecZlib;
         switch(version) {
             case 1: {
                 fin->getString(); // description
                 break;
             }
+            case 2: {
+                fin->getString(); // description
+                codec = flags & 0xFF;
+                if(codec != OtmmCodecZlib && codec != OtmmCodecNone)
+                    stdext::throw_exception("OTMM codec not supported");
+                break;
+            }
             default:
                 stdext::throw_exception("OTMM version not supported");
         }
 
         fin->seek(start);
 
-        uint blockSize = MMBLOCK_SIZE * MMBLOCK_SIZE * sizeof(MinimapTile);
-        std::vector<uchar> compressBuffer(compressBound(blockSize));
-        std::vector<uchar> decompressBuffer(blockSize);
+        // blocks already in memory are not part of this file anymore
+        for(uint8 z = 0; z <= Otc::MAX_Z; ++z) {
+            for(auto& it : m_tileBlocks[z]) {
+                it.second.m_savedSize = 0;
+                it.second.m_mustSave = true;
+            }
+        }
 
-        while(true) {
+        // version 1 ends with an invalid position, version 2 is appended to and ends with the file,
+        // where a later record of a block replaces the earlier ones
+        std::vector<OtmmRecord> records;
+        std::unordered_map<uint64, size_t> recordIndexes;
+        uint fileBytes = 0;
+        while(fin->tell() + OTMM_RECORD_HEADER_SIZE <= fin->size()) {
             Position pos;
             pos.x = fin->getU16();
             pos.y = fin->getU16();
@@ -345,20 +558,84 @@ bool Minimap::loadOtmm(const std::string& fileName)
             if(!pos.isValid() || pos.z >= Otc::MAX_Z+1)
                 break;
 
-            MinimapBlock& block = getBlock(pos);
-            ulong len = fin->getU16();
-            ulong destLen = blockSize;
-            fin->read(compressBuffer.data(), len);
-            int ret = uncompress(decompressBuffer.data(), &destLen, compressBuffer.data(), len);
-            if(ret != Z_OK || destLen != blockSize)
+            uint len = fin->getU16();
+            if(fin->tell() + len > fin->size())
                 break;
 
-            memcpy((uchar*)&block.getTiles(), decompressBuffer.data(), blockSize);
+            OtmmRecord record;
+            record.pos = pos;
+            record.block = nullptr;
+            record.ok = false;
+            record.data.resize(len);
+            fin->read(record.data.data(), len);
+            fileBytes += OTMM_RECORD_HEADER_SIZE + len;
+
+            uint64 key = (uint64)pos.z << 32 | getBlockIndex(pos);
+            auto it = recordIndexes.find(key);
+            if(it != recordIndexes.end())
+                records[it->second] = std::move(record);
+            else {
+                recordIndexes[key] = records.size();
+                records.push_back(std::move(record));
+            }
+        }
+        fin->close();
+
+        // blocks must be created here, the workers only fill their tiles
+        for(OtmmRecord& record : records)
+            record.block = &getBlock(record.pos);
+
+        std::vector<boost::shared_future<bool>> tasks;
+        for(size_t first = 0; first < records.size(); first += OTMM_BLOCKS_PER_TASK) {
+            OtmmRecord *begin = &records[first];
+            OtmmRecord *end = begin + std::min<size_t>(OTMM_BLOCKS_PER_TASK, records.size() - first);
+            tasks.push_back(g_asyncDispatcher.schedule([=]() {
+                const uint blockSize = MMBLOCK_SIZE * MMBLOCK_SIZE * sizeof(MinimapTile);
+                std::vector<uchar> decompressBuffer(blockSize);
+                for(OtmmRecord *record = begin; record != end; ++record) {
+                    if(codec == OtmmCodecNone) {
+                        if(record->data.size() != blockSize)
+                            continue;
+                        memcpy(decompressBuffer.data(), record->data.data(), blockSize);
+                    } else {
+                        ulong destLen = blockSize;
+                        int ret = uncompress(decompressBuffer.data(), &destLen, record->data.data(), record->data.size());
+                        if(ret != Z_OK || destLen != blockSize)
+                            continue;
+                    }
+                    memcpy((uchar*)&record->block->getTiles(), decompressBuffer.data(), blockSize);
+                    record->ok = true;
+                }
+                return true;
+            }));
+        }
+        for(auto& task : tasks)
+            task.wait();
+
+        uint liveBytes = 0;
+        for(OtmmRecord& record : records) {
+            if(!record.ok)
+                continue;
+
+            MinimapBlock& block = *record.block;
             block.mustUpdate();
             block.justSaw();
+            block.m_mustSave = false;
+            block.m_savedSize = OTMM_RECORD_HEADER_SIZE + record.data.size();
+            liveBytes += block.m_savedSize;
+            invalidateSuperBlocks(record.pos);
         }
 
-        fin->close();
+        // only version 2 files can be appended to
+        if(version == 2) {
+            m_otmmFile = g_resources.resolvePath(fileName);
+            m_otmmFileCodec = codec;
+            m_otmmFileBytes = fileBytes;
+            m_otmmLiveBytes = liveBytes;
+        } else
+            m_otmmFile.clear();
+
+        g_pathFinder.clearCache();
         return true;
     } catch(stdext::exception& e) {
         g_logger.error(stdext::format("failed to load OTMM minimap: %s", e.what()));
@@ -368,64 +645,197 @@ bool Minimap::loadOtmm(const std::string& fileName)
 
 void Minimap::saveOtmm(const std::string& fileName)
 {
-    try {
-        stdext::timer saveTimer;
-
-        FileStreamPtr fin = g_resources.createFile(fileName);
-        fin->cache();
-
-        //TODO: compression flag with zlib
-        uint32 flags = 0;
-
-        // header
-        fin->addU32(OTMM_SIGNATURE);
-        fin->addU16(0); // data start, will be overwritten later
-        fin->addU16(OTMM_VERSION);
-        fin->addU32(flags);
-
-        // version 1 header
-        fin->addString("OTMM 1.0"); // description
+    finishOtmmSaves(false);
 
-        // go back and rewrite where the map data starts
-        uint32 start = fin->tell();
-        fin->seek(4);
-        fin->addU16(start);
-        fin->seek(start);
-
-        uint blockSize = MMBLOCK_SIZE * MMBLOCK_SIZE * sizeof(MinimapTile);
-        std::vector<uchar> compressBuffer(compressBound(blockSize));
-        const int COMPRESS_LEVEL = 3;
-
-        for(uint8_t z = 0; z <= Otc::MAX_Z; ++z) {
+    try {
+        std::string filePath = g_resources.resolvePath(fileName);
+
+        // append the changed blocks to the file they were loaded from or last saved to,
+        // unless superseded records would take more space than the live ones, appending
+        // is only possible when the write dir really holds the file, not another search path
+        bool append = filePath == m_otmmFile && m_otmmFileCodec == m_otmmCodec && !g_resources.getWriteDir().empty() &&
+                      boost::filesystem::exists(g_resources.getWriteDir() + "/" + filePath);
+        auto records = std::make_shared<std::vector<OtmmRecord>>();
+        uint staleBytes = m_otmmFileBytes - m_otmmLiveBytes;
+        for(uint8 z = 0; z <= Otc::MAX_Z; ++z) {
             for(auto& it : m_tileBlocks[z]) {
-                int index = it.first;
                 MinimapBlock& block = it.second;
                 if(!block.wasSeen())
                     continue;
+                if(append && !block.m_mustSave)
+                    continue;
+
+                OtmmRecord record;
+                record.pos = getIndexPosition(it.first, z);
+                record.block = nullptr;
+                record.ok = false;
+                records->push_back(std::move(record));
+                staleBytes += block.m_savedSize;
+            }
+        }
 
-                Position pos = getIndexPosition(index, z);
-                fin->addU16(pos.x);
-                fin->addU16(pos.y);
-                fin->addU8(pos.z);
+        if(append && staleBytes > m_otmmLiveBytes) {
+            m_otmmFile.clear();
+            saveOtmm(fileName);
+            return;
+        }
+
+        if(append && records->empty())
+            return;
+
+        // the tiles are copied here, the workers never touch blocks the game keeps updating
+        const uint blockSize = MMBLOCK_SIZE * MMBLOCK_SIZE * sizeof(MinimapTile);
+        for(OtmmRecord& record : *records) {
+            MinimapBlock& block = getBlock(record.pos);
+            const uchar *tiles = (const uchar*)&block.getTiles();
+            record.data.assign(tiles, tiles + blockSize);
+            block.m_mustSave = false;
+        }
 
-                ulong len = blockSize;
-                int ret = compress2(compressBuffer.data(), &len, (uchar*)&block.getTiles(), blockSize, COMPRESS_LEVEL);
-                assert(ret == Z_OK);
-                fin->addU16(len);
-                fin->write(compressBuffer.data(), len);
+        if(!append) {
+            m_otmmFile = filePath;
+            m_otmmFileCodec = m_otmmCodec;
+        }
+
+        const int codec = m_otmmCodec;
+        const int level = m_otmmCompressionLevel;
+        std::vector<boost::shared_future<bool>> tasks;
+        if(codec != OtmmCodecNone) {
+            for(size_t first = 0; first < records->size(); first += OTMM_BLOCKS_PER_TASK) {
+                OtmmRecord *begin = &(*records)[first];
+                OtmmRecord *end = begin + std::min<size_t>(OTMM_BLOCKS_PER_TASK, records->size() - first);
+                tasks.push_back(g_asyncDispatcher.schedule([=]() {
+                    std::vector<uchar> compressed;
+                    for(OtmmRecord *record = begin; record != end; ++record) {
+                        ulong len = compressBound(blockSize);
+                        compressed.resize(len);
+                        if(compress2(compressed.data(), &len, record->data.data(), blockSize, level) != Z_OK)
+                            continue;
+                        compressed.resize(len);
+                        record->data.swap(compressed);
+                        record->ok = true;
+                    }
+                    return true;
+                }));
             }
+        } else {
+            for(OtmmRecord& record : *records)
+                record.ok = true;
         }
 
-        // end of file
-        Position invalidPos;
-        fin->addU16(invalidPos.x);
-        fin->addU16(invalidPos.y);
-        fin->addU8(invalidPos.z);
+        // the writer is queued after the compression tasks and the previous save, so waiting on them can't
+        // starve the workers, and saves reach the file in the order they were requested
+        boost::shared_future<std::string> previousSave;
+        if(!m_otmmSaves.empty())
+            previousSave = m_otmmSaves.back().task;
+
+        OtmmSave save;
+        save.records = records;
+        save.append = append;
+        save.task = g_asyncDispatcher.schedule([=]() -> std::string {
+            try {
+                stdext::timer saveTimer;
+                for(const boost::shared_future<bool>& task : tasks)
+                    task.wait();
+                if(previousSave.valid())
+                    previousSave.wait();
+
+                std::string buffer;
+                for(const OtmmRecord& record : *records) {
+                    if(!record.ok)
+                        stdext::throw_exception("failed to compress minimap block");
+
+                    uint8 header[OTMM_RECORD_HEADER_SIZE];
+                    stdext::writeULE16(header, record.pos.x);
+                    stdext::writeULE16(header + 2, record.pos.y);
+                    header[4] = record.pos.z;
+                    stdext::writeULE16(header + 5, record.data.size());
+                    buffer.append((char*)header, OTMM_RECORD_HEADER_SIZE);
+                    buffer.append((char*)record.data.data(), record.data.size());
+                }
 
-        fin->flush();
+                FileStreamPtr fin;
+                if(append) {
+                    fin = g_resources.appendFile(filePath);
+                    fin->write(buffer.data(), buffer.size());
+                } else {
+                    fin = g_resources.createFile(filePath);
+                    fin->cache();
+
+                    uint32 flags = codec;
+
+                    // header
+                    fin->addU32(OTMM_SIGNATURE);
+                    fin->addU16(0); // data start, will be overwritten later
+                    fin->addU16(OTMM_VERSION);
+                    fin->addU32(flags);
+
+                    // version 1 and 2 header
+                    fin->addString("OTMM 2.0"); // description
+
+                    // go back and rewrite where the map data starts
+                    uint32 start = fin->tell();
+                    fin->seek(4);
+                    fin->addU16(start);
+                    fin->seek(start);
+
+                    // version 2 has no end marker, so blocks can be appended later
+                    fin->write(buffer.data(), buffer.size());
+                }
 
-        fin->close();
+                fin->flush();
+                fin->close();
+                return std::string();
+            } catch(stdext::exception& e) {
+                return std::string(e.what());
+            }
+        });
+        m_otmmSaves.push_back(save);
+
+        // saves issued while the application shuts down must reach the disk before the dispatcher drops its queue
+        if(!g_app.isRunning())
+            finishOtmmSaves(true);
     } catch(stdext::exception& e) {
         g_logger.error(stdext::format("failed to save OTMM minimap: %s", e.what()));
     }
 }
+
+void Minimap::finishOtmmSaves(bool wait)
+{
+    while(!m_otmmSaves.empty()) {
+        OtmmSave& save = m_otmmSaves.front();
+        if(!wait && !save.task.is_ready())
+            break;
+
+        std::string error;
+        try {
+            error = save.task.get();
+        } catch(std::exception& e) {
+            error = e.what();
+        }
+
+        if(!error.empty()) {
+            // the file can't be trusted anymore, the next save rewrites it
+            g_logger.error(stdext::format("failed to save OTMM minimap: %s", error));
+            m_otmmFile.clear();
+        } else {
+            if(!save.append) {
+                m_otmmFileBytes = 0;
+                m_otmmLiveBytes = 0;
+            }
+            for(const OtmmRecord& record : *save.records) {
+                uint size = OTMM_RECORD_HEADER_SIZE + record.data.size();
+                m_otmmFileBytes += size;
+                m_otmmLiveBytes += size;
+                if(!hasBlock(record.pos))
+                    continue;
+                MinimapBlock& block = getBlock(record.pos);
+                if(save.append)
+                    m_otmmLiveBytes -= block.m_savedSize;
+                block.m_savedSize = size;
+            }
+            g_logger.debug(stdext::format("saved %d minimap blocks to '%s'", save.records->size(), m_otmmFile));
+        }
+        m_otmmSaves.pop_front();
+    }
+}
@@ -26,11 +26,21 @@
 
 #include "declarations.h"
 #include <framework/graphics/declarations.h>
+#include <framework/stdext/thread.h>
 
 enum {
     MMBLOCK_SIZE = 64,
+    MMBLOCK_TEXTURE_MEMORY = MMBLOCK_SIZE * MMBLOCK_SIZE * 4 * 4 / 3, // rgba plus mipmaps
+    MMBLOCK_MAX_TEXTURES = 1024,
+    MMBLOCK_LEVELS = 4, // 1:1 blocks plus 1:4, 1:16 and 1:64 super blocks
+    MMBLOCK_LEVEL_FACTOR = 4, // blocks per side merged into one block of the next level
     OTMM_SIGNATURE = 0x4D4d544F,
-    OTMM_VERSION = 1
+    OTMM_VERSION = 2
+};
+
+enum OtmmCodec {
+    OtmmCodecZlib = 0,
+    OtmmCodecNone = 1
 };
 
 enum MinimapTileFlags {
@@ -52,11 +62,15 @@ struct MinimapTile
     bool operator!=(const MinimapTile& other) const { return !(*this == other); }
 };
 
+#pragma pack(pop)
+
 class MinimapBlock
 {
 public:
+    MinimapBlock() : m_savedSize(0) { }
+
     void clean();
-    void update();
+    bool updateImage(const ImagePtr& image, const std::array<uint32, 256>& palette);
     void updateTile(int x, int y, const MinimapTile& tile);
     MinimapTile& getTile(int x, int y) { return m_tiles[getTileIndex(x,y)]; }
     void resetTile(int x, int y) { m_tiles[getTileIndex(x,y)] = MinimapTile(); }
@@ -64,16 +78,30 @@ public:
     const TexturePtr& getTexture() { return m_texture; }
     std::array<MinimapTile, MMBLOCK_SIZE *MMBLOCK_SIZE>& getTiles() { return m_tiles; }
     void mustUpdate() { m_mustUpdate = true; }
+    bool needsUpdate() { return m_mustUpdate; }
     void justSaw() { m_wasSeen = true; }
     bool wasSeen() { return m_wasSeen; }
 private:
+    friend class Minimap;
+
     TexturePtr m_texture;
+    std::list<MinimapBlock*>::iterator m_textureIt;
     std::array<MinimapTile, MMBLOCK_SIZE *MMBLOCK_SIZE> m_tiles;
     stdext::boolean<true> m_mustUpdate;
+    stdext::boolean<true> m_mustResample; // super blocks only, tiles are stale
     stdext::boolean<false> m_wasSeen;
+    stdext::boolean<true> m_mustSave; // tiles differ from the last saved otmm record
+    uint m_savedSize; // size of the last otmm record of this block, 0 when not saved
 };
 
-#pragma pack(pop)
+struct OtmmRecord;
+
+// a save running on the workers, its results are applied on the main thread
+struct OtmmSave {
+    boost::shared_future<std::string> task; // error message, empty on success
+    std::shared_ptr<std::vector<OtmmRecord>> records;
+    bool append;
+};
 
 class Minimap
 {
@@ -91,13 +119,31 @@ public:
 
     void updateTile(const Position& pos, const TilePtr& tile);
     const MinimapTile& getTile(const Position& pos);
+    bool copyBlockTiles(const Position& pos, std::array<MinimapTile, MMBLOCK_SIZE *MMBLOCK_SIZE>& tiles);
+    int getBlockCount(int z) { return z >= 0 && z <= Otc::MAX_Z ? m_tileBlocks[z].size() : 0; }
+    std::vector<Position> getBlockPositions(int z, const Rect& area);
 
     bool loadImage(const std::string& fileName, const Position& topLeft, float colorFactor);
     void saveImage(const std::string& fileName, const Rect& mapRect);
     bool loadOtmm(const std::string& fileName);
     void saveOtmm(const std::string& fileName);
+    void setOtmmCodec(int codec);
+    void setOtmmCompressionLevel(int level) { m_otmmCompressionLevel = std::min<int>(std::max<int>(level, 0), 9); }
+
+    void setMaxTextures(int maxTextures);
+    int getMaxTextures() { return m_maxTextures; }
+    int getTextureCount() { return m_textureBlocks.size(); }
+    int getTextureMemory() { return (m_textureBlocks.size() + m_freeTextures.size()) * MMBLOCK_TEXTURE_MEMORY; }
 
 private:
+    const TexturePtr& updateBlockTexture(MinimapBlock& block);
+    void releaseBlockTexture(MinimapBlock& block);
+    void invalidateSuperBlocks(const Position& pos);
+    MinimapBlock* getSuperBlock(int level, uint index, int z);
+    int getLevelForScale(float scale);
+    int getLevelBlockSize(int level) { return MMBLOCK_SIZE * (1 << (2 * level)); }
+    uint getLevelBlockIndex(const Position& pos, int level);
+    Position getLevelIndexPosition(uint index, int z, int level);
     Rect calcMapRect(const Rect& screenRect, const Position& mapCenter, float scale);
     bool hasBlock(const Position& pos) { return m_tileBlocks[pos.z].find(getBlockIndex(pos)) != m_tileBlocks[pos.z].end(); }
     MinimapBlock& getBlock(const Position& pos) { return m_tileBlocks[pos.z][getBlockIndex(pos)]; }
@@ -105,8 +151,25 @@ private:
                                                           pos.y - pos.y % MMBLOCK_SIZE); }
     Position getIndexPosition(int index, int z) { return Position((index % (65536 / MMBLOCK_SIZE))*MMBLOCK_SIZE,
                                                                   (index / (65536 / MMBLOCK_SIZE))*MMBLOCK_SIZE, z); }
+    void finishOtmmSaves(bool wait);
+
     uint getBlockIndex(const Position& pos) { return ((pos.y / MMBLOCK_SIZE) * (65536 / MMBLOCK_SIZE)) + (pos.x / MMBLOCK_SIZE); }
     std::unordered_map<uint, MinimapBlock> m_tileBlocks[Otc::MAX_Z+1];
+    std::unordered_map<uint, MinimapBlock> m_superBlocks[MMBLOCK_LEVELS-1][Otc::MAX_Z+1];
+
+    std::list<MinimapBlock*> m_textureBlocks; // blocks holding a texture, most recently drawn first
+    std::vector<TexturePtr> m_freeTextures;
+    std::array<uint32, 256> m_palette;
+    ImagePtr m_blockImage;
+    uint m_maxTextures;
+
+    int m_otmmCodec;
+    int m_otmmCompressionLevel;
+    std::string m_otmmFile; // file the saved state of the blocks refers to
+    int m_otmmFileCodec;
+    uint m_otmmFileBytes; // bytes of all block records in the file
+    uint m_otmmLiveBytes; // bytes of the records that were not superseded by an appended one
+    std::deque<OtmmSave> m_otmmSaves;
 };
 
 extern Minimap g_minimap;
@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "pathfinder.h"
+#include "minimap.h"
+
+#include <framework/core/eventdispatcher.h>
+#include <framework/core/asyncdispatcher.h>
+#include <framework/luaengine/luainterface.h>
+
+PathFinder g_pathFinder;
+
+static uint getMinimapBlockIndex(const Position& pos)
+{
+    return ((pos.y / MMBLOCK_SIZE) * (65536 / MMBLOCK_SIZE)) + (pos.x / MMBLOCK_SIZE);
+}
+
+PathFindTile PathFindSnapshot::getTile(const Position& pos) const
+{
+    if(pos.z != m_z)
+        return PathFindTile(MinimapTile());
+
+    if(m_awareRect.contains(Point(pos.x, pos.y))) {
+        uint index = (pos.y - m_awareRect.top()) * m_awareRect.width() + (pos.x - m_awareRect.left());
+        if(m_aware[index])
+            return m_awareTiles[index];
+    }
+
+    auto it = m_blocks.find(getMinimapBlockIndex(pos));
+    if(it == m_blocks.end())
+        return PathFindTile(MinimapTile());
+    return PathFindTile((*it->second)[((pos.y % MMBLOCK_SIZE) * MMBLOCK_SIZE) + (pos.x % MMBLOCK_SIZE)]);
+}
+
+PathFinder::PathFinder()
+{
+    m_lastId = 0;
+    m_cacheTime = CACHE_TIME;
+    resetStats();
+}
+
+void PathFinder::init()
+{
+    clearCache();
+}
+
+void PathFinder::terminate()
+{
+    cancelAll();
+
+    // the workers still hold their snapshots, let them finish before the process goes down
+    for(Batch& batch : m_batches)
+        batch.future.wait();
+    m_batches.clear();
+
+    if(m_pollEvent) {
+        m_pollEvent->cancel();
+        m_pollEvent = nullptr;
+    }
+    clearCache();
+}
+
+uint PathFinder::findPath(const Position& start, const Position& goal, int maxComplexity, int flags, const Callback& callback)
+{
+    return findPaths(start, {goal}, maxComplexity, flags, callback)[0];
+}
+
+std::vector<uint> PathFinder::findPaths(const Position& start, const std::vector<Position>& goals, int maxComplexity, int flags, const Callback& callback)
+{
+    std::vector<uint> ids;
+    Batch batch;
+    batch.start = start;
+    batch.maxComplexity = maxComplexity;
+    batch.flags = flags;
+
+    for(const Position& goal : goals) {
+        if(++m_lastId == 0)
+            ++m_lastId;
+        uint id = m_lastId;
+        ids.push_back(id);
+        m_callbacks[id] = callback;
+
+        // results are always delivered from the event loop, never before the id reaches the caller
+        PathFindOutcome outcome;
+        if(!start.isMapPosition()) {
+            std::get<1>(outcome) = Otc::PathFindResultImpossible;
+            g_dispatcher.addEvent([this, id, outcome] { deliver(id, outcome); });
+        } else if(lookupCache(CacheKey{start, goal, maxComplexity, flags}, outcome)) {
+            m_cacheHits++;
+            g_dispatcher.addEvent([this, id, outcome] { deliver(id, outcome); });
+        } else {
+            m_cacheMisses++;
+            batch.ids.push_back(id);
+            batch.goals.push_back(goal);
+        }
+    }
+
+    if(batch.goals.empty())
+        return ids;
+
+    PathFindSnapshotPtr snapshot = takeSnapshot(start, batch.goals, maxComplexity);
+    std::shared_ptr<std::atomic<bool>> canceled = std::make_shared<std::atomic<bool>>(false);
+    std::vector<Position> searchGoals = batch.goals;
+    batch.changesOverflow = false;
+    batch.canceled = canceled;
+    batch.future = g_asyncDispatcher.schedule([snapshot, canceled, start, searchGoals, maxComplexity, flags]() {
+        BatchResult result;
+        stdext::timer timer;
+        for(const Position& goal : searchGoals) {
+            if(canceled->load())
+                break;
+
+            // the bounds of every tile the search looks at, only changes inside them can alter its outcome
+            int left = start.x, top = start.y, right = start.x, bottom = start.y;
+            PathFindTileGetter getter = [&](const Position& pos) {
+                left = std::min<int>(left, pos.x);
+                top = std::min<int>(top, pos.y);
+                right = std::max<int>(right, pos.x);
+                bottom = std::max<int>(bottom, pos.y);
+                return snapshot->getTile(pos);
+            };
+            result.outcomes.push_back(Map::searchPath(start, goal, maxComplexity, flags, getter, canceled.get()));
+            result.areas.push_back(Rect(left, top, right - left + 1, bottom - top + 1));
+        }
+        result.seconds = timer.elapsed_seconds();
+        return result;
+    });
+    m_batches.push_back(std::move(batch));
+
+    if(!m_pollEvent)
+        m_pollEvent = g_dispatcher.cycleEvent([this] { poll(); }, POLL_INTERVAL);
+    return ids;
+}
+
+void PathFinder::cancel(uint id)
+{
+    if(m_callbacks.erase(id) == 0)
+        return;
+
+    // stop the worker once nobody waits on any path of its batch
+    for(Batch& batch : m_batches) {
+        if(std::find(batch.ids.begin(), batch.ids.end(), id) == batch.ids.end())
+            continue;
+        bool waited = std::any_of(batch.ids.begin(), batch.ids.end(), [this](uint other) { return m_callbacks.count(other) > 0; });
+        if(!waited)
+            batch.canceled->store(true);
+        break;
+    }
+}
+
+void PathFinder::cancelAll()
+{
+    m_callbacks.clear();
+    for(Batch& batch : m_batches)
+        batch.canceled->store(true);
+}
+
+void PathFinder::invalidate(const Position& pos)
+{
+    if(!pos.isMapPosition())
+        return;
+
+    m_minimapTiles[pos.z].erase(getMinimapBlockIndex(pos));
+
+    Point point(pos.x, pos.y);
+    for(Batch& batch : m_batches) {
+        if(batch.start.z != pos.z || batch.changesOverflow)
+            continue;
+        if(batch.changes.size() < MAX_BATCH_CHANGES)
+            batch.changes.push_back(point);
+        else
+            batch.changesOverflow = true;
+    }
+
+    for(auto it = m_cache.begin(); it != m_cache.end();) {
+        if(it->first.start.z == pos.z && it->second.area.contains(point))
+            it = m_cache.erase(it);
+        else
+            ++it;
+    }
+}
+
+void PathFinder::clearCache()
+{
+    // snapshots taken before may not match the minimap anymore, results of running searches are not cached
+    for(Batch& batch : m_batches)
+        batch.changesOverflow = true;
+    m_cache.clear();
+    for(auto& blocks : m_minimapTiles)
+        blocks.clear();
+}
+
+void PathFinder::resetStats()
+{
+    m_cacheHits = 0;
+    m_cacheMisses = 0;
+    m_searchCount = 0;
+    m_searchTime = 0;
+}
+
+PathFindSnapshotPtr PathFinder::takeSnapshot(const Position& start, const std::vector<Position>& goals, int maxComplexity)
+{
+    std::shared_ptr<PathFindSnapshot> snapshot = std::make_shared<PathFindSnapshot>();
+    snapshot->m_z = start.z;
+
+    // the aware range seen from another floor is shifted by one tile per floor, take a rect large enough for any floor
+    Position central = g_map.getCentralPosition();
+    AwareRange range = g_map.getAwareRange();
+    int shift = std::abs((int)central.z - (int)start.z);
+    int left = std::max<int>(central.x - range.left - shift, 0);
+    int top = std::max<int>(central.y - range.top - shift, 0);
+    int right = std::min<int>(central.x + range.right + shift, 65534);
+    int bottom = std::min<int>(central.y + range.bottom + shift, 65534);
+    if(central.isMapPosition() && left <= right && top <= bottom) {
+        snapshot->m_awareRect = Rect(left, top, right - left + 1, bottom - top + 1);
+        snapshot->m_awareTiles.resize(snapshot->m_awareRect.width() * snapshot->m_awareRect.height());
+        snapshot->m_aware.resize(snapshot->m_awareRect.width() * snapshot->m_awareRect.height(), false);
+        uint index = 0;
+        for(int y = top; y <= bottom; ++y) {
+            for(int x = left; x <= right; ++x, ++index) {
+                Position pos(x, y, start.z);
+                if(!g_map.isAwareOfPosition(pos))
+                    continue;
+                snapshot->m_aware[index] = true;
+                snapshot->m_awareTiles[index] = g_map.getPathFindTile(pos);
+            }
+        }
+    }
+
+    // minimap blocks the search can reach, every node is at most one step further than the previous one so
+    // nothing beyond maxComplexity tiles from the start is looked at, besides the goal tiles themselves; a large
+    // budget would still copy most of the floor, so the detour around the start and goals is also bounded by the
+    // distance to the farthest goal, tiles beyond read as unseen like any unexplored area
+    int reach = std::max<int>(maxComplexity, 0) + 1;
+    int minX = start.x, minY = start.y, maxX = start.x, maxY = start.y;
+    int distance = 0;
+    for(const Position& goal : goals) {
+        if(goal.z != start.z)
+            continue;
+        minX = std::min<int>(minX, goal.x);
+        minY = std::min<int>(minY, goal.y);
+        maxX = std::max<int>(maxX, goal.x);
+        maxY = std::max<int>(maxY, goal.y);
+        distance = std::max<int>(distance, std::max<int>(std::abs(goal.x - start.x), std::abs(goal.y - start.y)));
+    }
+    int margin = std::min<int>(reach, std::max<int>(distance, SNAPSHOT_MIN_MARGIN) + 1);
+    left = std::max<int>(std::max<int>(minX - margin, start.x - reach), 0);
+    top = std::max<int>(std::max<int>(minY - margin, start.y - reach), 0);
+    right = std::min<int>(std::min<int>(maxX + margin, start.x + reach), 65534);
+    bottom = std::min<int>(std::min<int>(maxY + margin, start.y + reach), 65534);
+    Rect area(left, top, right - left + 1, bottom - top + 1);
+
+    std::vector<Position> blockPositions;
+    int gridBlocks = (area.width() / MMBLOCK_SIZE + 2) * (area.height() / MMBLOCK_SIZE + 2);
+    if(gridBlocks > g_minimap.getBlockCount(start.z))
+        blockPositions = g_minimap.getBlockPositions(start.z, area);
+    else {
+        for(int y = top - top % MMBLOCK_SIZE; y <= bottom; y += MMBLOCK_SIZE) {
+            for(int x = left - left % MMBLOCK_SIZE; x <= right; x += MMBLOCK_SIZE)
+                blockPositions.push_back(Position(x, y, start.z));
+        }
+    }
+    for(const Position& goal : goals) {
+        if(goal.z == start.z && !area.contains(Point(goal.x, goal.y)))
+            blockPositions.push_back(goal);
+    }
+
+    for(const Position& blockPos : blockPositions) {
+        if(auto tiles = getMinimapTiles(blockPos))
+            snapshot->m_blocks[getMinimapBlockIndex(blockPos)] = tiles;
+    }
+    return snapshot;
+}
+
+std::shared_ptr<const PathFindSnapshot::MinimapTiles> PathFinder::getMinimapTiles(const Position& blockPos)
+{
+    // blocks are copied once and shared by every snapshot until a tile inside them changes
+    uint index = getMinimapBlockIndex(blockPos);
+    auto it = m_minimapTiles[blockPos.z].find(index);
+    if(it != m_minimapTiles[blockPos.z].end())
+        return it->second;
+
+    std::shared_ptr<PathFindSnapshot::MinimapTiles> tiles = std::make_shared<PathFindSnapshot::MinimapTiles>();
+    if(!g_minimap.copyBlockTiles(blockPos, *tiles))
+        return nullptr;
+    m_minimapTiles[blockPos.z][index] = tiles;
+    return tiles;
+}
+
+bool PathFinder::lookupCache(const CacheKey& key, PathFindOutcome& outcome)
+{
+    auto it = m_cache.find(key);
+    if(it == m_cache.end())
+        return false;
+    if(g_clock.millis() - it->second.time > m_cacheTime) {
+        m_cache.erase(it);
+        return false;
+    }
+    outcome = it->second.outcome;
+    return true;
+}
+
+void PathFinder::storeCache(const CacheKey& key, const PathFindOutcome& outcome, const Rect& area)
+{
+    if(m_cacheTime <= 0)
+        return;
+
+    ticks_t now = g_clock.millis();
+    if((int)m_cache.size() >= CACHE_MAX_ENTRIES && m_cache.find(key) == m_cache.end()) {
+        for(auto it = m_cache.begin(); it != m_cache.end();) {
+            if(now - it->second.time > m_cacheTime)
+                it = m_cache.erase(it);
+            else
+                ++it;
+        }
+        if((int)m_cache.size() >= CACHE_MAX_ENTRIES) {
+            auto oldest = std::min_element(m_cache.begin(), m_cache.end(), [](const std::pair<const CacheKey, CacheEntry>& a, const std::pair<const CacheKey, CacheEntry>& b) {
+                return a.second.time < b.second.time;
+            });
+            m_cache.erase(oldest);
+        }
+    }
+
+    CacheEntry& entry = m_cache[key];
+    entry.outcome = outcome;
+    entry.time = now;
+    entry.area = area;
+}
+
+void PathFinder::deliver(uint id, const PathFindOutcome& outcome)
+{
+    auto it = m_callbacks.find(id);
+    if(it == m_callbacks.end())
+        return;
+
+    Callback callback = it->second;
+    m_callbacks.erase(it);
+    if(callback)
+        callback(id, std::get<0>(outcome), std::get<1>(outcome));
+    else
+        g_lua.callGlobalField("g_pathFinder", "onPathFind", id, std::get<0>(outcome), std::get<1>(outcome));
+}
+
+void PathFinder::poll()
+{
+    // take the finished batches out first, callbacks may queue or cancel searches
+    std::vector<Batch> finished;
+    for(auto it = m_batches.begin(); it != m_batches.end();) {
+        if(it->future.is_ready()) {
+            finished.push_back(std::move(*it));
+            it = m_batches.erase(it);
+        } else
+            ++it;
+    }
+
+    if(m_batches.empty() && m_pollEvent) {
+        m_pollEvent->cancel();
+        m_pollEvent = nullptr;
+    }
+
+    for(const Batch& batch : finished) {
+        const BatchResult& result = batch.future.get();
+        m_searchCount += result.outcomes.size();
+        m_searchTime += result.seconds;
+
+        bool cacheable = !batch.canceled->load() && !batch.changesOverflow;
+        for(uint i = 0; i < batch.ids.size(); ++i) {
+            if(i >= result.outcomes.size()) {
+                m_callbacks.erase(batch.ids[i]);
+                continue;
+            }
+
+            // a result is only cached when no tile it looked at changed since the snapshot
+            const Rect& area = result.areas[i];
+            if(cacheable && std::none_of(batch.changes.begin(), batch.changes.end(), [&area](const Point& point) { return area.contains(point); }))
+                storeCache(CacheKey{batch.start, batch.goals[i], batch.maxComplexity, batch.flags}, result.outcomes[i], area);
+            deliver(batch.ids[i], result.outcomes[i]);
+        }
+    }
+}
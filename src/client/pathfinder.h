@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef PATHFINDER_H
+#define PATHFINDER_H
+
+#include "map.h"
+
+#include <boost/thread/future.hpp>
+
+typedef std::tuple<std::vector<Otc::Direction>, Otc::PathFindResult> PathFindOutcome;
+
+// walkability of one floor captured on the main thread, read by the worker threads
+class PathFindSnapshot
+{
+public:
+    typedef std::array<MinimapTile, MMBLOCK_SIZE *MMBLOCK_SIZE> MinimapTiles;
+
+    PathFindTile getTile(const Position& pos) const;
+
+private:
+    friend class PathFinder;
+
+    int m_z;
+    Rect m_awareRect;
+    std::vector<PathFindTile> m_awareTiles;
+    std::vector<bool> m_aware;
+    std::unordered_map<uint, std::shared_ptr<const MinimapTiles>> m_blocks;
+};
+typedef std::shared_ptr<const PathFindSnapshot> PathFindSnapshotPtr;
+
+//@bindsingleton g_pathFinder
+class PathFinder
+{
+public:
+    typedef std::function<void(uint, std::vector<Otc::Direction>, Otc::PathFindResult)> Callback;
+
+    enum {
+        POLL_INTERVAL = 10, // ms between checks for finished searches
+        CACHE_TIME = 10000, // ms a result stays valid when no tile on its way changed
+        CACHE_MAX_ENTRIES = 256,
+        MAX_BATCH_CHANGES = 64, // tile changes remembered while a batch runs, beyond that its results are not cached
+        SNAPSHOT_MIN_MARGIN = 64 // tiles around the start and goals copied for a search, even for near goals
+    };
+
+    PathFinder();
+
+    void init();
+    void terminate();
+
+    // the callback runs on the main thread, when empty the result goes to g_pathFinder.onPathFind(id, dirs, result)
+    uint findPath(const Position& start, const Position& goal, int maxComplexity, int flags, const Callback& callback);
+    // many goals from one start share a single snapshot and worker task, ids are in the goals order
+    std::vector<uint> findPaths(const Position& start, const std::vector<Position>& goals, int maxComplexity, int flags, const Callback& callback);
+    void cancel(uint id);
+    void cancelAll();
+
+    void invalidate(const Position& pos);
+    void clearCache();
+
+    void setCacheTime(int cacheTime) { m_cacheTime = std::max<int>(cacheTime, 0); clearCache(); }
+    int getCacheTime() { return m_cacheTime; }
+    int getPendingCount() { return m_callbacks.size(); }
+    int getCacheSize() { return m_cache.size(); }
+    int getCacheHits() { return m_cacheHits; }
+    int getCacheMisses() { return m_cacheMisses; }
+    int getSearchCount() { return m_searchCount; }
+    double getSearchTime() { return m_searchTime; }
+    void resetStats();
+
+private:
+    struct CacheKey {
+        Position start;
+        Position goal;
+        int maxComplexity;
+        int flags;
+        bool operator==(const CacheKey& other) const {
+            return start == other.start && goal == other.goal && maxComplexity == other.maxComplexity && flags == other.flags;
+        }
+    };
+    struct CacheKeyHasher {
+        std::size_t operator()(const CacheKey& key) const {
+            return PositionHasher()(key.start) * 31 + PositionHasher()(key.goal) + key.flags * 7 + key.maxComplexity;
+        }
+    };
+    struct CacheEntry {
+        PathFindOutcome outcome;
+        Rect area; // tiles the search looked at, a change inside drops the entry
+        ticks_t time;
+    };
+    struct BatchResult {
+        std::vector<PathFindOutcome> outcomes;
+        std::vector<Rect> areas;
+        double seconds;
+    };
+    struct Batch {
+        Position start;
+        int maxComplexity;
+        int flags;
+        std::vector<Point> changes; // tiles changed after the snapshot was taken
+        bool changesOverflow;
+        std::vector<uint> ids;
+        std::vector<Position> goals;
+        std::shared_ptr<std::atomic<bool>> canceled;
+        boost::shared_future<BatchResult> future;
+    };
+
+    PathFindSnapshotPtr takeSnapshot(const Position& start, const std::vector<Position>& goals, int maxComplexity);
+    std::shared_ptr<const PathFindSnapshot::MinimapTiles> getMinimapTiles(const Position& blockPos);
+    bool lookupCache(const CacheKey& key, PathFindOutcome& outcome);
+    void storeCache(const CacheKey& key, const PathFindOutcome& outcome, const Rect& area);
+    void deliver(uint id, const PathFindOutcome& outcome);
+    void poll();
+
+    uint m_lastId;
+    int m_cacheTime;
+    std::unordered_map<uint, Callback> m_callbacks;
+    std::list<Batch> m_batches;
+    std::unordered_map<CacheKey, CacheEntry, CacheKeyHasher> m_cache;
+    std::unordered_map<uint, std::shared_ptr<const PathFindSnapshot::MinimapTiles>> m_minimapTiles[Otc::MAX_Z+1];
+    ScheduledEventPtr m_pollEvent;
+    int m_cacheHits;
+    int m_cacheMisses;
+    int m_searchCount;
+    double m_searchTime;
+};
+
+extern PathFinder g_pathFinder;
+
+#endif
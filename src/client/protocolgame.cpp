@@ -26,6 +26,29 @@
 #include "item.h"
 #include "localplayer.h"
 
+ProtocolGame::ProtocolGame()
+{
+    // chat and interface requests are the ones scripts flood, movement and combat are never held back
+    static const int rates[LastSendCategory][2] = {
+        { 0, 0 },   // control
+        { 0, 0 },   // movement
+        { 0, 0 },   // combat
+        { 30, 30 }, // action
+        { 4, 8 },   // chat
+        { 20, 20 }  // interface
+    };
+    for(int i = 0; i < LastSendCategory; ++i) {
+        SendQueue& queue = m_sendQueues[i];
+        queue.rate = rates[i][0];
+        queue.burst = rates[i][1];
+        queue.tokens = queue.burst;
+        queue.lastRefill = stdext::micros();
+        queue.overflowed = false;
+    }
+    m_sendFlushPending = false;
+    resetSendStats();
+}
+
 void ProtocolGame::login(const std::string& accountName, const std::string& accountPassword, const std::string& host, uint16 port, const std::string& characterName, const std::string& authenticatorToken, const std::string& sessionKey)
 {
     m_accountName = accountName;
@@ -40,6 +63,7 @@ void ProtocolGame::login(const std::string& accountName, const std::string& acco
 void ProtocolGame::onConnect()
 {
     m_firstRecv = true;
+    clearSendQueue();
     Protocol::onConnect();
 
     m_localPlayer = g_game.getLocalPlayer();
@@ -73,6 +97,7 @@ void ProtocolGame::onRecv(const InputMessagePtr& inputMessage)
 
 void ProtocolGame::onError(const boost::system::error_code& error)
 {
+    clearSendQueue();
     g_game.processConnectionError(error);
     disconnect();
 }
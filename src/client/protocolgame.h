@@ -31,9 +31,23 @@
 class ProtocolGame : public Protocol
 {
 public:
+    enum {
+        MAX_SEND_QUEUE = 64, // messages waiting per category, newer ones are dropped
+        SEND_CONGESTION_BYTES = 4096, // unwritten bytes that hold back chat and interface requests
+        SEND_CONGESTION_RETRY = 10
+    };
+
+    ProtocolGame();
+
     void login(const std::string& accountName, const std::string& accountPassword, const std::string& host, uint16 port, const std::string& characterName, const std::string& authenticatorToken, const std::string& sessionKey);
     void send(const OutputMessagePtr& outputMessage);
 
+    // messages sent within a frame leave together, movement and combat first
+    void flushSendQueue();
+    void setSendRateLimit(const std::string& category, int messagesPerSecond, int burst);
+    std::map<std::string, double> getSendStats();
+    void resetSendStats();
+
     void sendExtendedOpcode(uint8 opcode, const std::string& buffer);
     void sendLoginPacket(uint challengeTimestamp, uint8 challengeRandom);
     void sendEnterGame();
@@ -257,6 +271,40 @@ public:
     Position getPosition(const InputMessagePtr& msg);
 
 private:
+    enum SendCategory {
+        SendControl = 0,
+        SendMovement,
+        SendCombat,
+        SendAction,
+        SendChat,
+        SendInterface,
+        LastSendCategory
+    };
+
+    struct SendQueue {
+        std::deque<std::pair<OutputMessagePtr, ticks_t>> messages;
+        int rate; // messages per second, 0 is unlimited
+        int burst;
+        double tokens;
+        ticks_t lastRefill;
+        int sent;
+        int dropped;
+        int peakSize;
+        bool overflowed;
+    };
+
+    static SendCategory getSendCategory(uint8 opcode);
+    void queueSend(const OutputMessagePtr& outputMessage, SendCategory category);
+    void scheduleSendFlush(int delay);
+    void clearSendQueue();
+
+    std::array<SendQueue, LastSendCategory> m_sendQueues;
+    bool m_sendFlushPending;
+    ScheduledEventPtr m_sendRetryEvent;
+    int m_sendLatency;
+    int m_sendPeakLatency;
+    int m_sendFlushes;
+
     stdext::boolean<false> m_enableSendExtendedOpcode;
     stdext::boolean<false> m_gameInitialized;
     stdext::boolean<false> m_mapKnown;
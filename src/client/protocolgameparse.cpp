@@ -37,9 +37,13 @@ void ProtocolGame::parseMessage(const InputMessagePtr& msg)
 {
     int opcode = -1;
     int prevOpcode = -1;
+    ConnectionPtr connection = getConnection();
+    ticks_t messageStart = stdext::micros();
+    ticks_t opcodeStart = messageStart;
 
     try {
         while(!msg->eof()) {
+            opcodeStart = stdext::micros();
             opcode = msg->getU8();
 
             // must be > so extended will be enabled before GameStart.
@@ -400,11 +404,16 @@ void ProtocolGame::parseMessage(const InputMessagePtr& msg)
                 break;
             }
             prevOpcode = opcode;
+            if(connection)
+                connection->getTelemetry().recordParse(opcode, (int)(stdext::micros() - opcodeStart));
         }
     } catch(stdext::exception& e) {
         g_logger.error(stdext::format("ProtocolGame parse message exception (%d bytes unread, last opcode is %d, prev opcode is %d): %s",
                                       msg->getUnreadSize(), opcode, prevOpcode, e.what()));
     }
+
+    if(connection)
+        connection->getTelemetry().recordMessageParse((int)(stdext::micros() - messageStart));
 }
 
 void ProtocolGame::parseLogin(const InputMessagePtr& msg)
@@ -24,15 +24,233 @@
 #include "game.h"
 #include "client.h"
 #include <framework/core/application.h>
+#include <framework/core/eventdispatcher.h>
 #include <framework/platform/platform.h>
 #include <framework/util/crypt.h>
 
+static const char *sendCategoryNames[] = { "control", "movement", "combat", "action", "chat", "interface" };
+
 void ProtocolGame::send(const OutputMessagePtr& outputMessage)
 {
     // avoid usage of automated sends (bot modules)
     if(!g_game.checkBotProtection())
         return;
-    Protocol::send(outputMessage);
+
+    queueSend(outputMessage, getSendCategory(outputMessage->peekU8()));
+}
+
+void ProtocolGame::queueSend(const OutputMessagePtr& outputMessage, SendCategory category)
+{
+    // login, ping and logout can't wait, the login packet also switches encryption on right after it is sent
+    SendQueue& queue = m_sendQueues[category];
+    if(category == SendControl) {
+        flushSendQueue();
+        Protocol::send(outputMessage);
+        queue.sent++;
+        return;
+    }
+
+    if((int)queue.messages.size() >= MAX_SEND_QUEUE) {
+        // report once per overflow, a flooding script would otherwise flood the log as well
+        if(!queue.overflowed)
+            g_logger.warning(stdext::format("%s send queue is full, dropping messages (opcode %d)", sendCategoryNames[category], (int)outputMessage->peekU8()));
+        queue.overflowed = true;
+        queue.dropped++;
+        return;
+    }
+    queue.overflowed = false;
+    queue.messages.push_back(std::make_pair(outputMessage, stdext::micros()));
+    queue.peakSize = std::max<int>(queue.peakSize, queue.messages.size());
+    scheduleSendFlush(0);
+}
+
+void ProtocolGame::flushSendQueue()
+{
+    m_sendFlushPending = false;
+    if(!isConnected()) {
+        clearSendQueue();
+        return;
+    }
+
+    ticks_t now = stdext::micros();
+    bool congested = getConnection()->getOutputQueuedBytes() > SEND_CONGESTION_BYTES;
+    int retryDelay = -1;
+    bool flushed = false;
+
+    // categories are in priority order, the connection writes everything sent here in a single call
+    for(int i = SendMovement; i < LastSendCategory; ++i) {
+        SendQueue& queue = m_sendQueues[i];
+        if(queue.messages.empty())
+            continue;
+
+        if(congested && i >= SendChat) {
+            retryDelay = retryDelay < 0 ? (int)SEND_CONGESTION_RETRY : std::min<int>(retryDelay, SEND_CONGESTION_RETRY);
+            continue;
+        }
+
+        if(queue.rate > 0) {
+            queue.tokens = std::min<double>(queue.burst, queue.tokens + (now - queue.lastRefill) * queue.rate / 1000000.0);
+            queue.lastRefill = now;
+        }
+
+        while(!queue.messages.empty()) {
+            if(queue.rate > 0) {
+                if(queue.tokens < 1.0) {
+                    int delay = std::ceil((1.0 - queue.tokens) * 1000.0 / queue.rate);
+                    retryDelay = retryDelay < 0 ? delay : std::min<int>(retryDelay, delay);
+                    break;
+                }
+                queue.tokens -= 1.0;
+            }
+
+            int latency = (int)(now - queue.messages.front().second);
+            m_sendLatency = (m_sendLatency * 15 + latency) / 16;
+            m_sendPeakLatency = std::max<int>(m_sendPeakLatency, latency);
+
+            Protocol::send(queue.messages.front().first);
+            queue.messages.pop_front();
+            queue.sent++;
+            flushed = true;
+        }
+    }
+
+    if(flushed)
+        m_sendFlushes++;
+    if(retryDelay >= 0)
+        scheduleSendFlush(retryDelay);
+}
+
+void ProtocolGame::setSendRateLimit(const std::string& category, int messagesPerSecond, int burst)
+{
+    for(int i = SendMovement; i < LastSendCategory; ++i) {
+        if(category != sendCategoryNames[i])
+            continue;
+        SendQueue& queue = m_sendQueues[i];
+        queue.rate = std::max<int>(messagesPerSecond, 0);
+        queue.burst = std::max<int>(burst, 1);
+        queue.tokens = std::min<double>(queue.tokens, queue.burst);
+        queue.lastRefill = stdext::micros();
+        scheduleSendFlush(0);
+        return;
+    }
+    g_logger.error(stdext::format("unknown send category '%s'", category));
+}
+
+std::map<std::string, double> ProtocolGame::getSendStats()
+{
+    std::map<std::string, double> stats;
+    int queued = 0;
+    for(int i = 0; i < LastSendCategory; ++i) {
+        const SendQueue& queue = m_sendQueues[i];
+        std::string name = sendCategoryNames[i];
+        stats[name + "Queued"] = queue.messages.size();
+        stats[name + "PeakQueued"] = queue.peakSize;
+        stats[name + "Sent"] = queue.sent;
+        stats[name + "Dropped"] = queue.dropped;
+        stats[name + "RateLimit"] = queue.rate;
+        queued += queue.messages.size();
+    }
+    stats["queued"] = queued;
+    stats["flushes"] = m_sendFlushes;
+    stats["latency"] = m_sendLatency / 1000.0;
+    stats["peakLatency"] = m_sendPeakLatency / 1000.0;
+    return stats;
+}
+
+void ProtocolGame::resetSendStats()
+{
+    for(SendQueue& queue : m_sendQueues) {
+        queue.sent = 0;
+        queue.dropped = 0;
+        queue.peakSize = queue.messages.size();
+    }
+    m_sendLatency = 0;
+    m_sendPeakLatency = 0;
+    m_sendFlushes = 0;
+}
+
+ProtocolGame::SendCategory ProtocolGame::getSendCategory(uint8 opcode)
+{
+    switch(opcode) {
+        case Proto::ClientPendingGame:
+        case Proto::ClientEnterGame:
+        case Proto::ClientLeaveGame:
+        case Proto::ClientPing:
+        case Proto::ClientPingBack:
+        // module pings and server side module traffic, these were never throttled
+        case Proto::ClientExtendedOpcode:
+            return SendControl;
+        case Proto::ClientAutoWalk:
+        case Proto::ClientWalkNorth:
+        case Proto::ClientWalkEast:
+        case Proto::ClientWalkSouth:
+        case Proto::ClientWalkWest:
+        case Proto::ClientStop:
+        case Proto::ClientWalkNorthEast:
+        case Proto::ClientWalkSouthEast:
+        case Proto::ClientWalkSouthWest:
+        case Proto::ClientWalkNorthWest:
+        case Proto::ClientTurnNorth:
+        case Proto::ClientTurnEast:
+        case Proto::ClientTurnSouth:
+        case Proto::ClientTurnWest:
+            return SendMovement;
+        case Proto::ClientChangeFightModes:
+        case Proto::ClientAttack:
+        case Proto::ClientFollow:
+        case Proto::ClientCancelAttackAndFollow:
+        case Proto::ClientUseOnCreature:
+            return SendCombat;
+        case Proto::ClientEquipItem:
+        case Proto::ClientMove:
+        case Proto::ClientUseItem:
+        case Proto::ClientUseItemWith:
+        case Proto::ClientRotateItem:
+        case Proto::ClientLook:
+        case Proto::ClientLookCreature:
+            return SendAction;
+        case Proto::ClientTalk:
+        case Proto::ClientRequestChannels:
+        case Proto::ClientJoinChannel:
+        case Proto::ClientLeaveChannel:
+        case Proto::ClientOpenPrivateChannel:
+        case Proto::ClientOpenOwnChannel:
+        case Proto::ClientInviteToOwnChannel:
+        case Proto::ClientExcludeFromOwnChannel:
+            return SendChat;
+        default:
+            return SendInterface;
+    }
+}
+
+void ProtocolGame::scheduleSendFlush(int delay)
+{
+    ProtocolGamePtr self = static_self_cast<ProtocolGame>();
+    if(delay == 0) {
+        // the dispatcher runs it later this frame, after everything else queued by then
+        if(m_sendFlushPending)
+            return;
+        m_sendFlushPending = true;
+        g_dispatcher.addEvent([self]() { self->flushSendQueue(); });
+        return;
+    }
+
+    if(m_sendRetryEvent && !m_sendRetryEvent->isExecuted() && !m_sendRetryEvent->isCanceled()) {
+        if(m_sendRetryEvent->remainingTicks() <= delay)
+            return;
+        m_sendRetryEvent->cancel();
+    }
+    m_sendRetryEvent = g_dispatcher.scheduleEvent([self]() { self->flushSendQueue(); }, delay);
+}
+
+void ProtocolGame::clearSendQueue()
+{
+    for(SendQueue& queue : m_sendQueues)
+        queue.messages.clear();
+    if(m_sendRetryEvent) {
+        m_sendRetryEvent->cancel();
+        m_sendRetryEvent = nullptr;
+    }
 }
 
 void ProtocolGame::sendExtendedOpcode(uint8 opcode, const std::string& buffer)
@@ -512,6 +730,13 @@ void ProtocolGame::sendTalk(Otc::MessageMode mode, int channelId, const std::str
     }
 
     msg->addString(message);
+
+    // spells are cast by saying their words, they must not wait behind the chat rate limit
+    if(mode == Otc::MessageSay) {
+        if(g_game.checkBotProtection())
+            queueSend(msg, SendCombat);
+        return;
+    }
     send(msg);
 }
 
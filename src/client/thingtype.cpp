@@ -323,6 +323,152 @@ void ThingType::unserialize(uint16 clientId, ThingCategory category, const FileS
     m_texturesFramesOffsets.resize(m_animationPhases);
 }
 
+void ThingType::serializeCache(const FileStreamPtr& fin)
+{
+    // attributes are stored with their internal ids, so no version translation is needed when reading back
+    for(int i = 0; i < ThingLastAttr; ++i) {
+        if(!hasAttr((ThingAttr)i))
+            continue;
+
+        fin->addU8(i);
+        switch(i) {
+            case ThingAttrLight: {
+                Light light = m_attribs.get<Light>(i);
+                fin->addU8(light.intensity);
+                fin->addU8(light.color);
+                break;
+            }
+            case ThingAttrMarket: {
+                MarketData market = m_attribs.get<MarketData>(i);
+                fin->addU16(market.category);
+                fin->addU16(market.tradeAs);
+                fin->addU16(market.showAs);
+                fin->addString(market.name);
+                fin->addU16(market.restrictVocation);
+                fin->addU16(market.requiredLevel);
+                break;
+            }
+            case ThingAttrElevation:
+                fin->addU16(m_elevation);
+                break;
+            case ThingAttrUsable:
+            case ThingAttrGround:
+            case ThingAttrWritable:
+            case ThingAttrWritableOnce:
+            case ThingAttrMinimapColor:
+            case ThingAttrCloth:
+            case ThingAttrLensHelp:
+                fin->addU16(m_attribs.get<uint16>(i));
+                break;
+            default:
+                break;
+        }
+    }
+    fin->addU8(ThingLastAttr);
+
+    fin->add16(m_displacement.x);
+    fin->add16(m_displacement.y);
+    fin->addU8(m_size.width());
+    fin->addU8(m_size.height());
+    fin->addU16(m_realSize);
+    fin->addU16(m_exactSize);
+    fin->addU8(m_layers);
+    fin->addU8(m_numPatternX);
+    fin->addU8(m_numPatternY);
+    fin->addU8(m_numPatternZ);
+    fin->addU16(m_animationPhases);
+
+    if(m_animator) {
+        fin->addU8(m_animator->getAnimationPhases());
+        m_animator->serialize(fin);
+    } else
+        fin->addU8(0);
+
+    fin->addU16(m_spritesIndex.size());
+    for(int i : m_spritesIndex)
+        fin->addU32(i);
+}
+
+void ThingType::unserializeCache(uint16 clientId, ThingCategory category, const FileStreamPtr& fin)
+{
+    m_null = false;
+    m_id = clientId;
+    m_category = category;
+
+    int attr;
+    while((attr = fin->getU8()) != ThingLastAttr) {
+        switch(attr) {
+            case ThingAttrLight: {
+                Light light;
+                light.intensity = fin->getU8();
+                light.color = fin->getU8();
+                m_attribs.set(attr, light);
+                break;
+            }
+            case ThingAttrMarket: {
+                MarketData market;
+                market.category = fin->getU16();
+                market.tradeAs = fin->getU16();
+                market.showAs = fin->getU16();
+                market.name = fin->getString();
+                market.restrictVocation = fin->getU16();
+                market.requiredLevel = fin->getU16();
+                m_attribs.set(attr, market);
+                break;
+            }
+            case ThingAttrElevation: {
+                m_elevation = fin->getU16();
+                m_attribs.set(attr, m_elevation);
+                break;
+            }
+            case ThingAttrUsable:
+            case ThingAttrGround:
+            case ThingAttrWritable:
+            case ThingAttrWritableOnce:
+            case ThingAttrMinimapColor:
+            case ThingAttrCloth:
+            case ThingAttrLensHelp:
+                m_attribs.set(attr, fin->getU16());
+                break;
+            default:
+                m_attribs.set(attr, true);
+                break;
+        }
+    }
+
+    m_displacement.x = fin->get16();
+    m_displacement.y = fin->get16();
+    int width = fin->getU8();
+    int height = fin->getU8();
+    m_size = Size(width, height);
+    m_realSize = fin->getU16();
+    m_exactSize = fin->getU16();
+    m_layers = fin->getU8();
+    m_numPatternX = fin->getU8();
+    m_numPatternY = fin->getU8();
+    m_numPatternZ = fin->getU8();
+    m_animationPhases = fin->getU16();
+
+    int animatorPhases = fin->getU8();
+    if(animatorPhases > 0) {
+        m_animator = AnimatorPtr(new Animator);
+        m_animator->unserialize(animatorPhases, fin);
+    }
+
+    int spritesCount = fin->getU16();
+    if(spritesCount > 4096)
+        stdext::throw_exception("a thing type has more than 4096 sprites");
+
+    m_spritesIndex.resize(spritesCount);
+    for(int i = 0; i < spritesCount; ++i)
+        m_spritesIndex[i] = fin->getU32();
+
+    m_textures.resize(m_animationPhases);
+    m_texturesFramesRects.resize(m_animationPhases);
+    m_texturesFramesOriginRects.resize(m_animationPhases);
+    m_texturesFramesOffsets.resize(m_animationPhases);
+}
+
 void ThingType::exportImage(std::string fileName)
 {
     if(m_null)
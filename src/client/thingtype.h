@@ -127,8 +127,10 @@ public:
 
     void unserialize(uint16 clientId, ThingCategory category, const FileStreamPtr& fin);
     void unserializeOtml(const OTMLNodePtr& node);
+    void unserializeCache(uint16 clientId, ThingCategory category, const FileStreamPtr& fin);
 
     void serialize(const FileStreamPtr& fin);
+    void serializeCache(const FileStreamPtr& fin);
     void exportImage(std::string fileName);
 
     void draw(const Point& dest, float scaleFactor, int layer, int xPattern, int yPattern, int zPattern, int animationPhase, LightView *lightView = nullptr);
@@ -37,6 +37,11 @@
 
 ThingTypeManager g_things;
 
+enum {
+    DAT_CACHE_SIGNATURE = 0x4344544F, // "OTDC"
+    DAT_CACHE_VERSION = 1
+};
+
 void ThingTypeManager::init()
 {
     m_nullThingType = ThingTypePtr(new ThingType);
@@ -48,6 +53,8 @@ void ThingTypeManager::init()
     m_datLoaded = false;
     m_xmlLoaded = false;
     m_otbLoaded = false;
+    m_datCacheEnabled = false;
+    m_itemTypeIndexDirty = true;
     for(auto &m_thingType: m_thingTypes)
         m_thingType.resize(1, m_nullThingType);
     m_itemTypes.resize(1, m_nullItemType);
@@ -59,6 +66,10 @@ void ThingTypeManager::terminate()
         m_thingType.clear();
     m_itemTypes.clear();
     m_reverseItemTypes.clear();
+    m_itemTypeNames.clear();
+    m_itemTypeNameIndex.clear();
+    m_itemTypeTrigramIndex.clear();
+    m_itemTypeIndexDirty = true;
     m_nullThingType = nullptr;
     m_nullItemType = nullptr;
 }
@@ -110,6 +121,17 @@ bool ThingTypeManager::loadDat(std::string file)
         m_datSignature = fin->getU32();
         m_contentRevision = static_cast<uint16_t>(m_datSignature);
 
+        uint32 datSize = fin->size();
+        if(m_datCacheEnabled && loadDatCache(datSize)) {
+            fin->close();
+            m_datLoaded = true;
+            g_lua.callGlobalField("g_things", "onLoadDat", file);
+            return true;
+        }
+
+        // read the whole file at once, parsing from disk byte by byte is way too slow
+        fin->cache();
+
         for(auto &m_thingType: m_thingTypes) {
             int count = fin->getU16() + 1;
             m_thingType.clear();
@@ -126,6 +148,10 @@ bool ThingTypeManager::loadDat(std::string file)
                 m_thingTypes[category][id] = type;
             }
         }
+        fin->close();
+
+        if(m_datCacheEnabled)
+            saveDatCache(datSize);
 
         m_datLoaded = true;
         g_lua.callGlobalField("g_things", "onLoadDat", file);
@@ -136,6 +162,103 @@ bool ThingTypeManager::loadDat(std::string file)
     }
 }
 
+std::string ThingTypeManager::getDatCacheFile()
+{
+    return stdext::format("/things-%d-%08X.otdc", g_game.getClientVersion(), m_datSignature);
+}
+
+uint8 ThingTypeManager::getDatCacheFeatures()
+{
+    // features that change how the dat is parsed, a cache made with different ones is stale
+    uint8 features = 0;
+    if(g_game.getFeature(Otc::GameSpritesU32))
+        features |= 1 << 0;
+    if(g_game.getFeature(Otc::GameEnhancedAnimations))
+        features |= 1 << 1;
+    if(g_game.getFeature(Otc::GameIdleAnimations))
+        features |= 1 << 2;
+    return features;
+}
+
+bool ThingTypeManager::loadDatCache(uint32 datSize)
+{
+    std::string file = getDatCacheFile();
+    if(!g_resources.fileExists(file))
+        return false;
+
+    try {
+        FileStreamPtr fin = g_resources.openFile(file);
+        fin->cache();
+
+        if(fin->getU32() != DAT_CACHE_SIGNATURE || fin->getU16() != DAT_CACHE_VERSION)
+            return false;
+
+        if(fin->getU32() != m_datSignature || fin->getU32() != datSize ||
+           fin->getU16() != g_game.getClientVersion() || fin->getU8() != getDatCacheFeatures())
+            return false;
+
+        for(auto &m_thingType: m_thingTypes) {
+            int count = fin->getU16() + 1;
+            m_thingType.clear();
+            m_thingType.resize(count, m_nullThingType);
+        }
+
+        for(int category = 0; category < ThingLastCategory; ++category) {
+            uint16 firstId = 1;
+            if(category == ThingCategoryItem)
+                firstId = 100;
+            for(uint16 id = firstId; id < m_thingTypes[category].size(); ++id) {
+                ThingTypePtr type(new ThingType);
+                type->unserializeCache(id, (ThingCategory)category, fin);
+                m_thingTypes[category][id] = type;
+            }
+        }
+
+        fin->close();
+        return true;
+    } catch(stdext::exception& e) {
+        g_logger.warning(stdext::format("Discarding dat cache '%s': %s", file, e.what()));
+        for(auto &m_thingType: m_thingTypes)
+            m_thingType.resize(1, m_nullThingType);
+        return false;
+    }
+}
+
+void ThingTypeManager::saveDatCache(uint32 datSize)
+{
+    std::string file = getDatCacheFile();
+    try {
+        FileStreamPtr fin = g_resources.createFile(file);
+        if(!fin)
+            stdext::throw_exception(stdext::format("failed to open file '%s' for write", file));
+
+        fin->cache();
+
+        fin->addU32(DAT_CACHE_SIGNATURE);
+        fin->addU16(DAT_CACHE_VERSION);
+        fin->addU32(m_datSignature);
+        fin->addU32(datSize);
+        fin->addU16(g_game.getClientVersion());
+        fin->addU8(getDatCacheFeatures());
+
+        for(auto &m_thingType: m_thingTypes)
+            fin->addU16(m_thingType.size() - 1);
+
+        for(int category = 0; category < ThingLastCategory; ++category) {
+            uint16 firstId = 1;
+            if(category == ThingCategoryItem)
+                firstId = 100;
+            for(uint16 id = firstId; id < m_thingTypes[category].size(); ++id)
+                m_thingTypes[category][id]->serializeCache(fin);
+        }
+
+        fin->flush();
+        fin->close();
+    } catch(std::exception& e) {
+        g_logger.error(stdext::format("Failed to save dat cache '%s': %s", file, e.what()));
+    }
+}
+
 bool ThingTypeManager::loadOtml(std::string file)
 {
     try {
@@ -216,6 +339,7 @@ void ThingTypeManager::loadOtb(const std::string& file)
         }
 
         m_otbLoaded = true;
+        m_itemTypeIndexDirty = true;
         g_lua.callGlobalField("g_things", "onLoadOtb", file);
     } catch(std::exception& e) {
         g_logger.error(stdext::format("Failed to load '%s' (OTB file): %s", file, e.what()));
@@ -267,6 +391,7 @@ void ThingTypeManager::loadXml(const std::string& file)
 
         doc.Clear();
         m_xmlLoaded = true;
+        m_itemTypeIndexDirty = true;
         g_logger.debug("items.xml read successfully.");
     } catch(std::exception& e) {
         g_logger.error(stdext::format("Failed to load '%s' (XML file): %s", file, e.what()));
@@ -335,6 +460,7 @@ void ThingTypeManager::addItemType(const ItemTypePtr& itemType)
     if(unlikely(id >= m_itemTypes.size()))
         m_itemTypes.resize(id + 1, m_nullItemType);
     m_itemTypes[id] = itemType;
+    m_itemTypeIndexDirty = true;
 }
 
 const ItemTypePtr& ThingTypeManager::findItemTypeByClientId(uint16 id)
@@ -350,30 +476,153 @@ const ItemTypePtr& ThingTypeManager::findItemTypeByClientId(uint16 id)
 
 const ItemTypePtr& ThingTypeManager::findItemTypeByName(std::string name)
 {
-    for(const ItemTypePtr& it : m_itemTypes)
-        if(it->getName() == name)
-            return it;
+    updateItemTypeIndex();
+
+    std::string lowerName = name;
+    stdext::tolower(lowerName);
+    auto it = m_itemTypeNameIndex.find(lowerName);
+    if(it == m_itemTypeNameIndex.end())
+        return m_nullItemType;
+
+    for(uint16 id : it->second)
+        if(m_itemTypes[id]->getName() == name)
+            return m_itemTypes[id];
     return m_nullItemType;
 }
 
 ItemTypeList ThingTypeManager::findItemTypesByName(std::string name)
 {
+    updateItemTypeIndex();
+
     ItemTypeList ret;
-    for(const ItemTypePtr& it : m_itemTypes)
-        if(it->getName() == name)
-            ret.push_back(it);
+    std::string lowerName = name;
+    stdext::tolower(lowerName);
+    auto it = m_itemTypeNameIndex.find(lowerName);
+    if(it == m_itemTypeNameIndex.end())
+        return ret;
+
+    for(uint16 id : it->second)
+        if(m_itemTypes[id]->getName() == name)
+            ret.push_back(m_itemTypes[id]);
     return ret;
 }
 
 ItemTypeList ThingTypeManager::findItemTypesByString(std::string name)
+{
+    updateItemTypeIndex();
+
+    std::string lowerName = name;
+    stdext::tolower(lowerName);
+
+    ItemTypeList ret;
+    const std::vector<uint16> *candidates = findItemTypeCandidates(lowerName);
+    if(candidates) {
+        for(uint16 id : *candidates)
+            if(m_itemTypes[id]->getName().find(name) != std::string::npos)
+                ret.push_back(m_itemTypes[id]);
+    } else {
+        for(const ItemTypePtr& it : m_itemTypes)
+            if(it->getName().find(name) != std::string::npos)
+                ret.push_back(it);
+    }
+    return ret;
+}
+
+ItemTypeList ThingTypeManager::searchItemTypes(std::string query, int maxResults)
 {
     ItemTypeList ret;
-    for(const ItemTypePtr& it : m_itemTypes)
-        if(it->getName().find(name) != std::string::npos)
-            ret.push_back(it);
+    stdext::tolower(query);
+    if(query.empty())
+        return ret;
+
+    updateItemTypeIndex();
+
+    // rank: 0 exact name, 1 name prefix, 2 word prefix, 3 anywhere in the name
+    std::vector<std::tuple<int, size_t, uint16>> matches;
+    auto match = [&](uint16 id) {
+        if(m_itemTypes[id] == m_nullItemType)
+            return;
+        const std::string& name = m_itemTypeNames[id];
+        size_t pos = name.find(query);
+        if(pos == std::string::npos)
+            return;
+
+        int rank;
+        if(pos == 0)
+            rank = name.length() == query.length() ? 0 : 1;
+        else if(name[pos - 1] == ' ')
+            rank = 2;
+        else
+            rank = 3;
+        matches.push_back(std::make_tuple(rank, name.length(), id));
+    };
+
+    const std::vector<uint16> *candidates = findItemTypeCandidates(query);
+    if(candidates) {
+        for(uint16 id : *candidates)
+            match(id);
+    } else {
+        for(uint id = 0; id < m_itemTypeNames.size(); ++id)
+            match(id);
+    }
+
+    std::sort(matches.begin(), matches.end());
+    if(maxResults > 0 && matches.size() > (size_t)maxResults)
+        matches.resize(maxResults);
+
+    ret.reserve(matches.size());
+    for(const auto& m : matches)
+        ret.push_back(m_itemTypes[std::get<2>(m)]);
     return ret;
 }
 
+void ThingTypeManager::updateItemTypeIndex()
+{
+    if(!m_itemTypeIndexDirty)
+        return;
+
+    m_itemTypeNames.clear();
+    m_itemTypeNameIndex.clear();
+    m_itemTypeTrigramIndex.clear();
+    m_itemTypeNames.resize(m_itemTypes.size());
+
+    for(uint id = 0; id < m_itemTypes.size(); ++id) {
+        std::string name = m_itemTypes[id]->getName();
+        stdext::tolower(name);
+        m_itemTypeNameIndex[name].push_back(id);
+
+        for(size_t i = 0; i + 3 <= name.length(); ++i) {
+            uint32 trigram = (uint8)name[i] << 16 | (uint8)name[i+1] << 8 | (uint8)name[i+2];
+            std::vector<uint16>& ids = m_itemTypeTrigramIndex[trigram];
+            if(ids.empty() || ids.back() != id)
+                ids.push_back(id);
+        }
+
+        m_itemTypeNames[id] = std::move(name);
+    }
+
+    m_itemTypeIndexDirty = false;
+}
+
+const std::vector<uint16>* ThingTypeManager::findItemTypeCandidates(const std::string& lowerName)
+{
+    // names shorter than a trigram can't be narrowed down, the caller must scan everything
+    if(lowerName.length() < 3)
+        return nullptr;
+
+    static const std::vector<uint16> emptyCandidates;
+    const std::vector<uint16> *best = nullptr;
+    for(size_t i = 0; i + 3 <= lowerName.length(); ++i) {
+        uint32 trigram = (uint8)lowerName[i] << 16 | (uint8)lowerName[i+1] << 8 | (uint8)lowerName[i+2];
+        auto it = m_itemTypeTrigramIndex.find(trigram);
+        if(it == m_itemTypeTrigramIndex.end())
+            return &emptyCandidates;
+        if(!best || it->second.size() < best->size())
+            best = &it->second;
+    }
+    return best;
+}
+
 const ThingTypePtr& ThingTypeManager::getThingType(uint16 id, ThingCategory category)
 {
     if(category >= ThingLastCategory || id >= m_thingTypes[category].size()) {
@@ -43,11 +43,15 @@ public:
 
     void saveDat(std::string fileName);
 
+    void setDatCacheEnabled(bool enabled) { m_datCacheEnabled = enabled; }
+    bool isDatCacheEnabled() { return m_datCacheEnabled; }
+
     void addItemType(const ItemTypePtr& itemType);
     const ItemTypePtr& findItemTypeByClientId(uint16 id);
     const ItemTypePtr& findItemTypeByName(std::string name);
     ItemTypeList findItemTypesByName(std::string name);
     ItemTypeList findItemTypesByString(std::string name);
+    ItemTypeList searchItemTypes(std::string query, int maxResults);
 
     const ThingTypePtr& getNullThingType() { return m_nullThingType; }
     const ItemTypePtr& getNullItemType() { return m_nullItemType; }
@@ -76,6 +80,14 @@ public:
     bool isValidOtbId(uint16 id) { return id >= 1 && id < m_itemTypes.size(); }
 
 private:
+    std::string getDatCacheFile();
+    uint8 getDatCacheFeatures();
+    bool loadDatCache(uint32 datSize);
+    void saveDatCache(uint32 datSize);
+
+    void updateItemTypeIndex();
+    const std::vector<uint16>* findItemTypeCandidates(const std::string& lowerName);
+
     ThingTypeList m_thingTypes[ThingLastCategory];
     ItemTypeList m_reverseItemTypes;
     ItemTypeList m_itemTypes;
@@ -83,9 +95,16 @@ private:
     ThingTypePtr m_nullThingType;
     ItemTypePtr m_nullItemType;
 
+    // lowercase names indexed by server id, plus whole name and trigram lookups into it
+    std::vector<std::string> m_itemTypeNames;
+    std::unordered_map<std::string, std::vector<uint16>> m_itemTypeNameIndex;
+    std::unordered_map<uint32, std::vector<uint16>> m_itemTypeTrigramIndex;
+    bool m_itemTypeIndexDirty;
+
     bool m_datLoaded;
     bool m_xmlLoaded;
     bool m_otbLoaded;
+    bool m_datCacheEnabled;
 
     uint32 m_otbMinorVersion;
     uint32 m_otbMajorVersion;
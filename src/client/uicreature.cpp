@@ -35,6 +35,9 @@ void UICreature::drawSelf(Fw::DrawPane drawPane)
         Rect drawRect = getPaddingRect();
         g_painter->setColor(m_imageColor);
         m_creature->drawOutfit(drawRect, !m_fixedCreatureSize);
+
+        // outfits animate while walking or idle, keep a cached parent redrawing
+        invalidateRenderCache();
     }
 }
 
@@ -44,6 +47,7 @@ void UICreature::setOutfit(const Outfit& outfit)
         m_creature = CreaturePtr(new Creature);
     m_creature->setDirection(Otc::South);
     m_creature->setOutfit(outfit);
+    invalidateRenderCache();
 }
 
 void UICreature::onStyleApply(const std::string& styleName, const OTMLNodePtr& styleNode)
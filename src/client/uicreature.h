@@ -32,7 +32,7 @@ class UICreature : public UIWidget
 public:
     void drawSelf(Fw::DrawPane drawPane);
 
-    void setCreature(const CreaturePtr& creature) { m_creature = creature; }
+    void setCreature(const CreaturePtr& creature) { m_creature = creature; invalidateRenderCache(); }
     void setFixedCreatureSize(bool fixed) { m_fixedCreatureSize = fixed; }
     void setOutfit(const Outfit& outfit);
 
@@ -52,6 +52,9 @@ void UIMap::drawSelf(Fw::DrawPane drawPane)
     UIWidget::drawSelf(drawPane);
 
     if(drawPane & Fw::ForegroundPane) {
+        // the map changes every frame, it is never worth caching
+        invalidateRenderCache();
+
         // draw map border
         g_painter->setColor(Color::black);
         g_painter->drawBoundingRect(m_mapRect.expanded(1));
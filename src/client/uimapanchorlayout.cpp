@@ -66,15 +66,7 @@ void UIMapAnchorLayout::addPositionAnchor(const UIWidgetPtr& anchoredWidget, Fw:
 
     assert(anchoredWidget != getParentWidget());
 
-    UIPositionAnchorPtr anchor(new UIPositionAnchor(anchoredEdge, hookedPosition, hookedEdge));
-    UIAnchorGroupPtr& anchorGroup = m_anchorsGroups[anchoredWidget];
-    if(!anchorGroup)
-        anchorGroup = UIAnchorGroupPtr(new UIAnchorGroup);
-
-    anchorGroup->addAnchor(anchor);
-
-    // layout must be updated because a new anchor got in
-    update();
+    addAnchor(anchoredWidget, UIPositionAnchorPtr(new UIPositionAnchor(anchoredEdge, hookedPosition, hookedEdge)));
 }
 
 void UIMapAnchorLayout::centerInPosition(const UIWidgetPtr& anchoredWidget, const Position& hookedPosition)
@@ -46,6 +46,9 @@ void UIMinimap::drawSelf(Fw::DrawPane drawPane)
         return;
 
     g_minimap.draw(getPaddingRect(), getCameraPosition(), m_scale, m_color);
+
+    // the minimap follows the map, it is never worth caching
+    invalidateRenderCache();
 }
 
 bool UIMinimap::setZoom(int zoom)
@@ -64,7 +67,7 @@ bool UIMinimap::setZoom(int zoom)
         m_scale = 1.0f * (1 << std::abs(zoom));
     else
         m_scale = 1;
-    m_layout->update();
+    updateLayout();
 
     onZoomChange(zoom, oldZoom);
     return true;
@@ -74,7 +77,7 @@ void UIMinimap::setCameraPosition(const Position& pos)
 {
     Position oldPos = m_cameraPosition;
     m_cameraPosition = pos;
-    m_layout->update();
+    updateLayout();
 
     onCameraPositionChange(pos, oldPos);
 }
@@ -36,10 +36,10 @@ public:
     int getSpriteId() { return m_spriteId; }
     void clearSprite() { setSpriteId(0); }
 
-    void setSpriteColor(Color color) { m_spriteColor = color; }
+    void setSpriteColor(Color color) { m_spriteColor = color; invalidateRenderCache(); }
 
     bool isSpriteVisible() { return m_spriteVisible; }
-    void setSpriteVisible(bool visible) { m_spriteVisible = visible; }
+    void setSpriteVisible(bool visible) { m_spriteVisible = visible; invalidateRenderCache(); }
 
     bool hasSprite() { return m_sprite != nullptr; }
 
@@ -36,6 +36,7 @@
 
 #ifdef FW_NET
 #include <framework/net/connection.h>
+#include <framework/net/protocolhttp.h>
 #endif
 
 void exitSignalHandler(int sig)
@@ -125,6 +126,7 @@ void Application::terminate()
 {
 #ifdef FW_NET
     // terminate network
+    ProtocolHttp::terminate();
     Connection::terminate();
 #endif
 
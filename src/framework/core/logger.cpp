@@ -34,6 +34,54 @@
 
 Logger g_logger;
 
+Logger::Logger() :
+    m_writing(false),
+    m_terminated(false),
+    m_queuedMessages(0),
+    m_writtenMessages(0),
+    m_droppedMessages(0),
+    m_suppressedMessages(0),
+    m_rateSecond(0),
+    m_pendingSuppressed(0),
+    m_maxRepeatsPerSecond(DEFAULT_MAX_REPEATS_PER_SECOND)
+{
+}
+
+Logger::~Logger()
+{
+    terminate();
+}
+
+void Logger::terminate()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        m_terminated = true;
+        m_writing = false;
+    }
+    m_writeCondition.notify_all();
+    if(m_writeThread.joinable())
+        m_writeThread.join();
+
+    // messages pushed while the thread was stopping
+    std::string *message;
+    while(m_queue.pop(message)) {
+        write(*message + "\n");
+        delete message;
+        m_writtenMessages++;
+    }
+}
+
+void Logger::flush()
+{
+    m_writeCondition.notify_one();
+
+    // bounded, a stuck disk must not hang the caller forever
+    stdext::timer timer;
+    while(m_writing && m_writtenMessages < m_queuedMessages && timer.elapsed_seconds() < 1.0)
+        stdext::millisleep(1);
+}
+
 void Logger::log(Fw::LogLevel level, const std::string& message)
 {
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
@@ -51,6 +99,10 @@ void Logger::log(Fw::LogLevel level, const std::string& message)
 
     std::string outmsg = logPrefixes[level] + message;
 
+    // a module spamming the same message must not stall the frame on disk writes
+    if(level != Fw::LogFatal && !checkRate(outmsg))
+        return;
+
     /*
 #if !defined(NDEBUG) && !defined(WIN32)
     // replace paths for improved debug with vim
@@ -67,12 +119,7 @@ void Logger::log(Fw::LogLevel level, const std::string& message)
 #endif
     */
 
-    std::cout << outmsg << std::endl;
-
-    if(m_outFile.good()) {
-        m_outFile << outmsg << std::endl;
-        m_outFile.flush();
-    }
+    output(outmsg);
 
     std::size_t now = std::time(nullptr);
     m_logMessages.emplace_back(level, outmsg, now);
@@ -88,6 +135,7 @@ void Logger::log(Fw::LogLevel level, const std::string& message)
     }
 
     if(level == Fw::LogFatal) {
+        flush();
 #ifdef FW_GRAPHICS
         g_window.displayFatalError(message);
 #endif
@@ -104,6 +152,9 @@ void Logger::logFunc(Fw::LogLevel level, const std::string& message, std::string
     if(prettyFunction.find_last_of(' ') != std::string::npos)
         prettyFunction = prettyFunction.substr(prettyFunction.find_last_of(' ') + 1);
 
+    // tracebacks are expensive, skip them for repeated messages
+    if(level != Fw::LogFatal && !checkRate(prettyFunction + message))
+        return;
 
     std::stringstream ss;
     ss << message;
@@ -133,10 +184,148 @@ void Logger::setLogFile(const std::string& file)
 {
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
-    m_outFile.open(stdext::utf8_to_latin1(file).c_str(), std::ios::out | std::ios::app);
-    if(!m_outFile.is_open() || !m_outFile.good()) {
+    bool opened;
+    {
+        std::lock_guard<std::mutex> writeLock(m_writeMutex);
+        m_outFile.open(stdext::utf8_to_latin1(file).c_str(), std::ios::out | std::ios::app);
+        opened = m_outFile.is_open() && m_outFile.good();
+        if(opened)
+            m_outFile.flush();
+    }
+
+    if(!opened)
         g_logger.error(stdext::format("Unable to save log to '%s'", file));
+}
+
+bool Logger::checkRate(const std::string& message)
+{
+    if(m_maxRepeatsPerSecond <= 0)
+        return true;
+
+    std::size_t now = std::time(nullptr);
+    if(m_pendingSuppressed > 0 && now != m_rateSecond) {
+        m_rateSecond = now;
+        outputSuppressed(now);
+    }
+
+    std::size_t key = std::hash<std::string>()(message);
+    auto it = m_rateEntries.find(key);
+    if(it == m_rateEntries.end()) {
+        if(m_rateEntries.size() >= MAX_RATE_ENTRIES) {
+            outputSuppressed(0);
+            m_rateEntries.clear();
+            m_pendingSuppressed = 0;
+        }
+        RateEntry& entry = m_rateEntries[key];
+        entry.message = message;
+        entry.second = now;
+        entry.count = 1;
+        entry.suppressed = 0;
+        return true;
+    }
+
+    RateEntry& entry = it->second;
+    if(entry.second != now) {
+        entry.second = now;
+        entry.count = 1;
+        return true;
+    }
+
+    if(++entry.count <= m_maxRepeatsPerSecond)
+        return true;
+
+    entry.suppressed++;
+    m_pendingSuppressed++;
+    m_suppressedMessages++;
+    return false;
+}
+
+void Logger::outputSuppressed(std::size_t now)
+{
+    // summaries of the seconds that are over, a burst that stopped is reported as well
+    for(auto& it : m_rateEntries) {
+        RateEntry& entry = it.second;
+        if(entry.suppressed == 0 || entry.second == now)
+            continue;
+        output(stdext::format("(%d repetitions of \"%s\" were suppressed)", entry.suppressed, entry.message));
+        m_pendingSuppressed -= entry.suppressed;
+        entry.suppressed = 0;
+    }
+}
+
+void Logger::output(const std::string& message)
+{
+    if(m_terminated) {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        write(message + "\n");
+        return;
+    }
+
+    // started on the first message, callers hold m_mutex so only one thread gets here
+    if(!m_writing) {
+        m_writing = true;
+        m_writeThread = std::thread(std::bind(&Logger::writeLoop, this));
+    }
+
+    // never block the caller, a full queue means the disk can't keep up anyway
+    std::string *entry = new std::string(message);
+    m_queuedMessages++;
+    if(!m_queue.push(entry)) {
+        delete entry;
+        m_queuedMessages--;
+        m_droppedMessages++;
         return;
     }
-    m_outFile.flush();
+    m_writeCondition.notify_one();
+}
+
+void Logger::write(const std::string& text)
+{
+    std::cout << text << std::flush;
+
+    if(m_outFile.good()) {
+        m_outFile << text;
+        m_outFile.flush();
+    }
+}
+
+void Logger::writeLoop()
+{
+    std::string batch;
+    std::unique_lock<std::mutex> lock(m_writeMutex);
+    while(true) {
+        // drain everything queued and write it at once
+        std::string *message;
+        int count = 0;
+        while(m_queue.pop(message)) {
+            batch += *message;
+            batch += '\n';
+            delete message;
+            count++;
+        }
+
+        if(count > 0) {
+            write(batch);
+            batch.clear();
+            m_writtenMessages += count;
+            continue;
+        }
+
+        if(!m_writing)
+            break;
+        m_writeCondition.wait_for(lock, std::chrono::milliseconds(100));
+
+        // nobody may log again after a burst, so its summary is written from here; the log mutex is only
+        // tried, a logging thread holding it reports the summary itself
+        lock.unlock();
+        if(m_mutex.try_lock()) {
+            std::size_t now = std::time(nullptr);
+            if(!m_terminated && m_pendingSuppressed > 0 && now != m_rateSecond) {
+                m_rateSecond = now;
+                outputSuppressed(now);
+            }
+            m_mutex.unlock();
+        }
+        lock.lock();
+    }
 }
@@ -27,6 +27,8 @@
 
 #include <framework/stdext/thread.h>
 #include <fstream>
+#include <atomic>
+#include <boost/lockfree/queue.hpp>
 
 struct LogMessage {
     LogMessage(Fw::LogLevel level, const std::string& message, std::size_t when) : level(level), message(message), when(when) { }
@@ -39,12 +41,28 @@ struct LogMessage {
 class Logger
 {
     enum {
-        MAX_LOG_HISTORY = 1000
+        MAX_LOG_HISTORY = 1000,
+        LOG_QUEUE_SIZE = 1024,
+        MAX_RATE_ENTRIES = 1024,
+        DEFAULT_MAX_REPEATS_PER_SECOND = 10
+    };
+
+    struct RateEntry {
+        std::string message;
+        std::size_t second;
+        int count;
+        int suppressed;
     };
 
     typedef std::function<void(Fw::LogLevel, const std::string&, int64)> OnLogCallback;
 
 public:
+    Logger();
+    ~Logger();
+
+    void terminate();
+    void flush();
+
     void log(Fw::LogLevel level, const std::string& message);
     void logFunc(Fw::LogLevel level, const std::string& message, std::string prettyFunction);
 
@@ -57,12 +75,41 @@ public:
     void fireOldMessages();
     void setLogFile(const std::string& file);
     void setOnLog(const OnLogCallback& onLog) { m_onLog = onLog; }
+    void setMaxRepeatsPerSecond(int repeats) { m_maxRepeatsPerSecond = repeats; }
+
+    int getMaxRepeatsPerSecond() { return m_maxRepeatsPerSecond; }
+    int getDroppedMessages() { return m_droppedMessages; }
+    int getSuppressedMessages() { return m_suppressedMessages; }
+    int getQueuedMessages() { return m_queuedMessages - m_writtenMessages; }
+    void resetStats() { m_droppedMessages = 0; m_suppressedMessages = 0; }
 
 private:
+    bool checkRate(const std::string& message);
+    void outputSuppressed(std::size_t now);
+    void output(const std::string& message);
+    void write(const std::string& text);
+    void writeLoop();
+
     std::list<LogMessage> m_logMessages;
     OnLogCallback m_onLog;
     std::ofstream m_outFile;
     std::recursive_mutex m_mutex;
+
+    // messages are written to stdout and the log file by a background thread
+    boost::lockfree::queue<std::string*, boost::lockfree::capacity<LOG_QUEUE_SIZE>> m_queue;
+    std::thread m_writeThread;
+    std::mutex m_writeMutex;
+    std::condition_variable m_writeCondition;
+    std::atomic<bool> m_writing;
+    std::atomic<bool> m_terminated;
+    std::atomic<int> m_queuedMessages;
+    std::atomic<int> m_writtenMessages;
+    std::atomic<int> m_droppedMessages;
+    std::atomic<int> m_suppressedMessages;
+    std::unordered_map<std::size_t, RateEntry> m_rateEntries;
+    std::size_t m_rateSecond;
+    int m_pendingSuppressed;
+    int m_maxRepeatsPerSecond;
 };
 
 extern Logger g_logger;
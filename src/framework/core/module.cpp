@@ -31,6 +31,7 @@ Module::Module(const std::string& name)
 {
     m_name = name;
     m_sandboxEnv = g_lua.newSandboxEnv();
+    m_loadTime = 0;
 }
 
 bool Module::load()
@@ -38,6 +39,9 @@ bool Module::load()
     if(m_loaded)
         return true;
 
+    stdext::timer loadTimer;
+    float dependenciesTime = 0;
+
     try {
         // add to package.loaded
         g_lua.getGlobalField("package", "loaded");
@@ -59,6 +63,7 @@ bool Module::load()
             if(!dep->isLoaded() && !dep->load())
                 stdext::throw_exception(stdext::format("dependency '%s' has failed to load", depName));
         }
+        dependenciesTime = loadTimer.elapsed_seconds();
 
         if(m_sandboxed)
             g_lua.setGlobalEnvironment(m_sandboxEnv);
@@ -83,6 +88,7 @@ bool Module::load()
             g_lua.resetGlobalEnvironment();
 
         m_loaded = true;
+        m_loadTime = loadTimer.elapsed_seconds() - dependenciesTime;
         g_logger.debug(stdext::format("Loaded module '%s'", m_name));
     } catch(stdext::exception& e) {
         // remove from package.loaded
@@ -189,6 +195,8 @@ int Module::getSandbox(LuaInterface* lua)
 void Module::discover(const OTMLNodePtr& moduleNode)
 {
     const static std::string none = "none";
+    std::string source = moduleNode->source();
+    m_directory = source.substr(0, source.find_last_of('/'));
     m_description = moduleNode->valueAt("description", none);
     m_author = moduleNode->valueAt("author", none);
     m_website = moduleNode->valueAt("website", none);
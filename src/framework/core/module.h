@@ -54,6 +54,8 @@ public:
     std::string getVersion() { return m_version; }
     bool isAutoLoad() { return m_autoLoad; }
     int getAutoLoadPriority() { return m_autoLoadPriority; }
+    /// Milliseconds spent loading this module, not counting its dependencies
+    float getLoadTime() { return m_loadTime * 1000.0f; }
 
     // @dontbind
     ModulePtr asModule() { return static_self_cast<Module>(); }
@@ -69,6 +71,7 @@ private:
     stdext::boolean<false> m_sandboxed;
     int m_autoLoadPriority;
     int m_sandboxEnv;
+    float m_loadTime;
     std::tuple<std::string, std::string> m_onLoadFunc;
     std::tuple<std::string, std::string> m_onUnloadFunc;
     std::string m_name;
@@ -76,6 +79,7 @@ private:
     std::string m_author;
     std::string m_website;
     std::string m_version;
+    std::string m_directory;
     std::function<void()> m_loadCallback;
     std::function<void()> m_unloadCallback;
     std::list<std::string> m_dependencies;
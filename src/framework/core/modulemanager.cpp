@@ -25,9 +25,17 @@
 
 #include <framework/otml/otml.h>
 #include <framework/core/application.h>
+#include <framework/luaengine/luainterface.h>
 
 ModuleManager g_modules;
 
+ModuleManager::ModuleManager()
+{
+    m_discoverTime = 0;
+    m_preloadTime = 0;
+    m_preloadedFiles = 0;
+}
+
 void ModuleManager::clear()
 {
     m_modules.clear();
@@ -39,17 +47,51 @@ void ModuleManager::discoverModules()
     // remove modules that are not loaded
     m_autoLoadModules.clear();
 
+    stdext::timer timer;
+    std::vector<std::string> moduleFiles;
     auto moduleDirs = g_resources.listDirectoryFiles("/");
     for(const std::string& moduleDir : moduleDirs) {
-        auto moduleFiles = g_resources.listDirectoryFiles("/" + moduleDir);
-        for(const std::string& moduleFile : moduleFiles) {
-            if(g_resources.isFileType(moduleFile, "otmod")) {
-                ModulePtr module = discoverModule("/" + moduleDir + "/" + moduleFile);
-                if(module && module->isAutoLoad())
-                    m_autoLoadModules.insert(std::make_pair(module->getAutoLoadPriority(), module));
-            }
+        for(const std::string& moduleFile : g_resources.listDirectoryFiles("/" + moduleDir)) {
+            if(g_resources.isFileType(moduleFile, "otmod"))
+                moduleFiles.push_back("/" + moduleDir + "/" + moduleFile);
         }
     }
+
+    // parse all module files on worker threads, then register them in the usual order
+    OTMLDocument::preload(moduleFiles);
+    for(const std::string& moduleFile : moduleFiles) {
+        ModulePtr module = discoverModule(moduleFile);
+        if(module && module->isAutoLoad())
+            m_autoLoadModules.insert(std::make_pair(module->getAutoLoadPriority(), module));
+    }
+    m_discoverTime = timer.elapsed_seconds();
+}
+
+void ModuleManager::preloadModules()
+{
+    stdext::timer timer;
+    std::vector<std::string> styleFiles;
+    std::vector<std::string> scriptFiles;
+    for(auto& pair : m_autoLoadModules) {
+        const ModulePtr& module = pair.second;
+        if(!module->isLoaded())
+            collectModuleFiles(module->m_directory, styleFiles, scriptFiles);
+    }
+
+    // scripts with a bytecode cache are loaded from the cache, only the cache file is worth reading
+    if(g_lua.isBytecodeCacheEnabled() && !g_resources.getWriteDir().empty()) {
+        for(std::string& scriptFile : scriptFiles) {
+            std::string cacheFile = g_lua.getBytecodeCacheFile(scriptFile);
+            if(g_resources.fileExists(cacheFile))
+                scriptFile = cacheFile;
+        }
+    }
+
+    g_resources.preloadFiles(scriptFiles);
+    OTMLDocument::preload(styleFiles);
+
+    m_preloadedFiles = styleFiles.size() + scriptFiles.size();
+    m_preloadTime = timer.elapsed_seconds();
 }
 
 void ModuleManager::autoLoadModules(int maxPriority)
@@ -122,6 +164,27 @@ void ModuleManager::reloadModules()
         module->load();
 }
 
+void ModuleManager::printStartupTimes()
+{
+    g_logger.info(stdext::format("Modules discovered in %.2f ms, %d files preloaded in %.2f ms",
+                                 m_discoverTime * 1000.0f, m_preloadedFiles, m_preloadTime * 1000.0f));
+
+    // loaded modules are kept in reverse load order
+    float totalTime = 0;
+    for(auto it = m_modules.rbegin(); it != m_modules.rend(); ++it) {
+        const ModulePtr& module = *it;
+        if(!module->isLoaded())
+            continue;
+        g_logger.info(stdext::format("  %-24s %8.2f ms", module->getName(), module->getLoadTime()));
+        totalTime += module->getLoadTime();
+    }
+    g_logger.info(stdext::format("Modules loaded in %.2f ms", totalTime));
+
+    // whatever was preloaded and not used by now will not be needed
+    g_resources.clearPreloadedFiles();
+    OTMLDocument::clearPreloaded();
+}
+
 ModulePtr ModuleManager::getModule(const std::string& moduleName)
 {
     for(const ModulePtr& module : m_modules)
@@ -130,6 +193,19 @@ ModulePtr ModuleManager::getModule(const std::string& moduleName)
     return nullptr;
 }
 
+void ModuleManager::collectModuleFiles(const std::string& directory, std::vector<std::string>& styleFiles, std::vector<std::string>& scriptFiles)
+{
+    for(const std::string& fileName : g_resources.listDirectoryFiles(directory)) {
+        std::string fullPath = directory + "/" + fileName;
+        if(g_resources.isFileType(fileName, "otui"))
+            styleFiles.push_back(fullPath);
+        else if(g_resources.isFileType(fileName, "lua"))
+            scriptFiles.push_back(fullPath);
+        else if(g_resources.directoryExists(fullPath))
+            collectModuleFiles(fullPath, styleFiles, scriptFiles);
+    }
+}
+
 void ModuleManager::updateModuleLoadOrder(ModulePtr module)
 {
     auto it = std::find(m_modules.begin(), m_modules.end(), module);
@@ -29,26 +29,34 @@
 class ModuleManager
 {
 public:
+    ModuleManager();
+
     void clear();
 
     void discoverModules();
+    void preloadModules();
     void autoLoadModules(int maxPriority);
     ModulePtr discoverModule(const std::string& moduleFile);
     void ensureModuleLoaded(const std::string& moduleName);
     void unloadModules();
     void reloadModules();
+    void printStartupTimes();
 
     ModulePtr getModule(const std::string& moduleName);
     std::deque<ModulePtr> getModules() { return m_modules; }
 
 protected:
     void updateModuleLoadOrder(ModulePtr module);
+    void collectModuleFiles(const std::string& directory, std::vector<std::string>& styleFiles, std::vector<std::string>& scriptFiles);
 
     friend class Module;
 
 private:
     std::deque<ModulePtr> m_modules;
     std::multimap<int, ModulePtr> m_autoLoadModules;
+    float m_discoverTime;
+    float m_preloadTime;
+    int m_preloadedFiles;
 };
 
 extern ModuleManager g_modules;
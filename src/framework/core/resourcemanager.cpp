@@ -21,9 +21,11 @@
  */
 
 #include "resourcemanager.h"
+#include "resourcepack.h"
 #include "filestream.h"
 
 #include <framework/core/application.h>
+#include <framework/core/asyncdispatcher.h>
 #include <framework/luaengine/luainterface.h>
 #include <framework/platform/platform.h>
 
@@ -35,6 +37,7 @@ void ResourceManager::init(const char *argv0)
 {
     PHYSFS_init(argv0);
     PHYSFS_permitSymbolicLinks(1);
+    ResourcePack::registerArchiver();
 }
 
 void ResourceManager::terminate()
@@ -154,6 +157,87 @@ void ResourceManager::searchAndAddPackages(const std::string& packagesDir, const
     }
 }
 
+bool ResourceManager::createPackage(const std::string& directory, const std::string& packageFile, int compressionLevel)
+{
+    try {
+        stdext::timer timer;
+        int count = ResourcePack::create(directory, packageFile, compressionLevel);
+        g_logger.info(stdext::format("Packed %d files from '%s' into '%s' in %.2f seconds", count, directory, packageFile, timer.elapsed_seconds()));
+        return true;
+    } catch(std::exception& e) {
+        g_logger.error(stdext::format("Unable to create package '%s': %s", packageFile, e.what()));
+        return false;
+    }
+}
+
+std::map<std::string, double> ResourceManager::benchmarkPackage(const std::string& packageFile, int rounds)
+{
+    std::map<std::string, double> stats;
+
+    // mounting an archive twice is a no-op, the final unmount would then remove the real search path
+    if(PHYSFS_getMountPoint(packageFile.c_str())) {
+        g_logger.error(stdext::format("Unable to benchmark package '%s': it is already mounted", packageFile));
+        return stats;
+    }
+
+    // mounted in front so lookups don't probe the other search paths first
+    const std::string mountPoint = "/.benchmark";
+    if(!PHYSFS_mount(packageFile.c_str(), mountPoint.c_str(), 0)) {
+        g_logger.error(stdext::format("Unable to mount package '%s': %s", packageFile, PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode())));
+        return stats;
+    }
+
+    std::vector<std::string> files;
+    std::vector<std::string> directories(1, mountPoint);
+    while(!directories.empty()) {
+        std::string directory = directories.back();
+        directories.pop_back();
+        for(const std::string& fileName : listDirectoryFiles(directory)) {
+            std::string fullPath = directory + "/" + fileName;
+            if(directoryExists(fullPath))
+                directories.push_back(fullPath);
+            else
+                files.push_back(fullPath);
+        }
+    }
+
+    ticks_t existsTime = 0, openTime = 0, readTime = 0;
+    uint64 bytes = 0;
+    std::string buffer;
+    for(int i = 0; i < rounds; ++i) {
+        for(const std::string& file : files) {
+            ticks_t start = stdext::micros();
+            PHYSFS_exists(file.c_str());
+            ticks_t opened = stdext::micros();
+            PHYSFS_File* handle = PHYSFS_openRead(file.c_str());
+            ticks_t read = stdext::micros();
+            if(!handle)
+                continue;
+            buffer.resize(PHYSFS_fileLength(handle));
+            if(!buffer.empty())
+                PHYSFS_readBytes(handle, &buffer[0], buffer.size());
+            PHYSFS_close(handle);
+            ticks_t end = stdext::micros();
+
+            existsTime += opened - start;
+            openTime += read - opened;
+            readTime += end - read;
+            bytes += buffer.size();
+        }
+    }
+
+    PHYSFS_unmount(packageFile.c_str());
+
+    double reads = std::max<double>(files.size() * rounds, 1);
+    stats["files"] = files.size();
+    stats["bytes"] = bytes / std::max(rounds, 1);
+    stats["existsMicros"] = existsTime / reads;
+    stats["openMicros"] = openTime / reads;
+    stats["readMicros"] = readTime / reads;
+    stats["totalMillis"] = (existsTime + openTime + readTime) / 1000.0;
+    return stats;
+}
+
 bool ResourceManager::fileExists(const std::string& fileName)
 {
     const std::string path = resolvePath(fileName);
@@ -186,20 +270,75 @@ std::string ResourceManager::readFileContents(const std::string& fileName)
 {
     std::string fullPath = resolvePath(fileName);
 
+    // files read ahead are handed out once, later reads go to the disk again
+    {
+        std::lock_guard<std::mutex> lock(m_preloadMutex);
+        auto it = m_preloadedFiles.find(fullPath);
+        if(it != m_preloadedFiles.end()) {
+            std::string buffer = std::move(it->second);
+            m_preloadedFiles.erase(it);
+            return buffer;
+        }
+    }
+
+    std::string buffer;
+    if(!readPhysFile(fullPath, buffer))
+        stdext::throw_exception(stdext::format("unable to open file '%s': %s", fullPath, PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode())));
+    return buffer;
+}
+
+void ResourceManager::preloadFiles(const std::vector<std::string>& fileNames)
+{
+    typedef std::pair<bool, std::string> ReadResult;
+
+    std::vector<std::string> fullPaths;
+    std::vector<boost::shared_future<ReadResult>> results;
+    for(const std::string& fileName : fileNames) {
+        std::string fullPath = resolvePath(fileName);
+        fullPaths.push_back(fullPath);
+        results.push_back(g_asyncDispatcher.schedule([fullPath]() {
+            ReadResult result;
+            result.first = readPhysFile(fullPath, result.second);
+            return result;
+        }));
+    }
+
+    std::lock_guard<std::mutex> lock(m_preloadMutex);
+    for(uint i = 0; i < results.size(); ++i) {
+        // missing files are left to fail on the real read
+        const ReadResult& result = results[i].get();
+        if(result.first)
+            m_preloadedFiles[fullPaths[i]] = result.second;
+    }
+}
+
+void ResourceManager::clearPreloadedFiles()
+{
+    std::lock_guard<std::mutex> lock(m_preloadMutex);
+    m_preloadedFiles.clear();
+}
+
+bool ResourceManager::readPhysFile(const std::string& fullPath, std::string& buffer)
+{
     PHYSFS_File* file = PHYSFS_openRead(fullPath.c_str());
     if(!file)
-        stdext::throw_exception(stdext::format("unable to open file '%s': %s", fullPath, PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode())));
+        return false;
 
     int fileSize = PHYSFS_fileLength(file);
-    std::string buffer(fileSize, 0);
-    PHYSFS_readBytes(file, (void*)&buffer[0], fileSize);
+    buffer.resize(fileSize);
+    if(fileSize > 0)
+        PHYSFS_readBytes(file, (void*)&buffer[0], fileSize);
     PHYSFS_close(file);
-
-    return buffer;
+    return true;
 }
 
 bool ResourceManager::writeFileBuffer(const std::string& fileName, const uchar* data, uint size)
 {
+    {
+        std::lock_guard<std::mutex> lock(m_preloadMutex);
+        m_preloadedFiles.erase(resolvePath(fileName));
+    }
+
     PHYSFS_file* file = PHYSFS_openWrite(fileName.c_str());
     if(!file) {
         g_logger.error(PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()));
@@ -249,6 +388,11 @@ FileStreamPtr ResourceManager::appendFile(const std::string& fileName)
 
 FileStreamPtr ResourceManager::createFile(const std::string& fileName)
 {
+    {
+        std::lock_guard<std::mutex> lock(m_preloadMutex);
+        m_preloadedFiles.erase(resolvePath(fileName));
+    }
+
     PHYSFS_File* file = PHYSFS_openWrite(fileName.c_str());
     if(!file)
         stdext::throw_exception(stdext::format("failed to create file '%s': %s", fileName, PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode())));
@@ -367,3 +511,11 @@ ticks_t ResourceManager::getFileTime(const std::string& filename)
 {
     return g_platform.getFileModificationTime(getRealPath(filename));
 }
+
+int64 ResourceManager::getFileSize(const std::string& filename)
+{
+    PHYSFS_Stat stat;
+    if(!PHYSFS_stat(resolvePath(filename).c_str(), &stat) || stat.filetype != PHYSFS_FILETYPE_REGULAR)
+        return -1;
+    return stat.filesize;
+}
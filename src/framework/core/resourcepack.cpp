@@ -0,0 +1,461 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "resourcepack.h"
+
+#include <physfs.h>
+#include <zlib.h>
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace {
+
+uint64 hashPath(const std::string& path)
+{
+    uint64 hash = 14695981039346656037ULL;
+    for(char c : path) {
+        hash ^= (uint8)c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+struct PackEntry {
+    uint64 hash;
+    std::string name;
+    uint64 offset;
+    uint32 size;
+    uint32 storedSize;
+    uint8 compression;
+
+    bool operator<(const PackEntry& other) const {
+        return hash < other.hash || (hash == other.hash && name < other.name);
+    }
+};
+
+struct PackArchive {
+    PHYSFS_Io *io;
+    boost::interprocess::mapped_region region;
+    std::string buffer; // packs that can't be mapped are kept in memory
+    const uchar *data;
+    uint64 size;
+    PHYSFS_sint64 modTime;
+    std::vector<PackEntry> entries;
+    std::unordered_map<std::string, std::set<std::string>> directories;
+
+    const PackEntry *find(const std::string& name) const {
+        PackEntry key;
+        key.hash = hashPath(name);
+        key.name = name;
+        auto it = std::lower_bound(entries.begin(), entries.end(), key);
+        if(it != entries.end() && it->hash == key.hash && it->name == name)
+            return &*it;
+        return nullptr;
+    }
+
+    bool parseIndex() {
+        if(size < ResourcePack::PACK_HEADER_SIZE || stdext::readULE16(data + 4) != ResourcePack::PACK_VERSION)
+            return false;
+
+        modTime = stdext::readULE64(data + 6);
+        uint32 count = stdext::readULE32(data + 14);
+        uint64 pos = stdext::readULE64(data + 18);
+
+        // every entry takes at least 27 bytes, a corrupt count must not allocate before the reads fail
+        if(pos > size || count > (size - pos) / 27)
+            return false;
+
+        entries.resize(count);
+        for(PackEntry& entry : entries) {
+            if(pos + 10 > size)
+                return false;
+            entry.hash = stdext::readULE64(data + pos);
+            uint16 nameLength = stdext::readULE16(data + pos + 8);
+            pos += 10;
+
+            if(pos + nameLength + 17 > size)
+                return false;
+            entry.name.assign((const char*)data + pos, nameLength);
+            pos += nameLength;
+            entry.offset = stdext::readULE64(data + pos);
+            entry.size = stdext::readULE32(data + pos + 8);
+            entry.storedSize = stdext::readULE32(data + pos + 12);
+            entry.compression = data[pos + 16];
+            pos += 17;
+
+            if(entry.offset > size || entry.storedSize > size - entry.offset || entry.compression > ResourcePack::CompressionZlib)
+                return false;
+            // stored files are served straight from the mapping, their size must be what is there
+            if(entry.compression == ResourcePack::CompressionNone && entry.size != entry.storedSize)
+                return false;
+            if(&entry != &entries.front() && !((&entry)[-1] < entry))
+                return false;
+
+            // every parent directory lists its child
+            std::string path = entry.name;
+            std::string::size_type slash;
+            while((slash = path.find_last_of('/')) != std::string::npos) {
+                directories[path.substr(0, slash)].insert(path.substr(slash + 1));
+                path.resize(slash);
+            }
+            directories[""].insert(path);
+        }
+        return true;
+    }
+};
+
+struct PackFile {
+    const uchar *data;
+    uint64 size;
+    uint64 pos;
+    std::shared_ptr<std::string> buffer; // decompressed contents, shared with duplicates
+};
+
+PHYSFS_Io *createFileIo(const uchar *data, uint64 size, const std::shared_ptr<std::string>& buffer);
+
+PHYSFS_sint64 fileRead(PHYSFS_Io *io, void *buf, PHYSFS_uint64 len)
+{
+    PackFile *file = (PackFile*)io->opaque;
+    len = std::min<PHYSFS_uint64>(len, file->size - file->pos);
+    memcpy(buf, file->data + file->pos, len);
+    file->pos += len;
+    return len;
+}
+
+PHYSFS_sint64 fileWrite(PHYSFS_Io*, const void*, PHYSFS_uint64)
+{
+    PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+    return -1;
+}
+
+int fileSeek(PHYSFS_Io *io, PHYSFS_uint64 offset)
+{
+    PackFile *file = (PackFile*)io->opaque;
+    if(offset > file->size) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_PAST_EOF);
+        return 0;
+    }
+    file->pos = offset;
+    return 1;
+}
+
+PHYSFS_sint64 fileTell(PHYSFS_Io *io)
+{
+    return ((PackFile*)io->opaque)->pos;
+}
+
+PHYSFS_sint64 fileLength(PHYSFS_Io *io)
+{
+    return ((PackFile*)io->opaque)->size;
+}
+
+PHYSFS_Io *fileDuplicate(PHYSFS_Io *io)
+{
+    PackFile *file = (PackFile*)io->opaque;
+    return createFileIo(file->data, file->size, file->buffer);
+}
+
+int fileFlush(PHYSFS_Io*)
+{
+    return 1;
+}
+
+void fileDestroy(PHYSFS_Io *io)
+{
+    delete (PackFile*)io->opaque;
+    delete io;
+}
+
+PHYSFS_Io *createFileIo(const uchar *data, uint64 size, const std::shared_ptr<std::string>& buffer)
+{
+    PackFile *file = new PackFile;
+    file->data = data;
+    file->size = size;
+    file->pos = 0;
+    file->buffer = buffer;
+
+    PHYSFS_Io *io = new PHYSFS_Io;
+    io->version = 0;
+    io->opaque = file;
+    io->read = fileRead;
+    io->write = fileWrite;
+    io->seek = fileSeek;
+    io->tell = fileTell;
+    io->length = fileLength;
+    io->duplicate = fileDuplicate;
+    io->flush = fileFlush;
+    io->destroy = fileDestroy;
+    return io;
+}
+
+void *openArchive(PHYSFS_Io *io, const char *name, int forWrite, int *claimed)
+{
+    // zip packages share the extension, anything without our signature is left to the other archivers
+    uchar signature[4];
+    if(io->read(io, signature, 4) != 4 || stdext::readULE32(signature) != ResourcePack::PACK_SIGNATURE) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_UNSUPPORTED);
+        return nullptr;
+    }
+    *claimed = 1;
+
+    if(forWrite) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+        return nullptr;
+    }
+
+    std::unique_ptr<PackArchive> archive(new PackArchive);
+    try {
+        boost::interprocess::file_mapping mapping(name, boost::interprocess::read_only);
+        boost::interprocess::mapped_region region(mapping, boost::interprocess::read_only);
+        archive->region.swap(region);
+        archive->data = (const uchar*)archive->region.get_address();
+        archive->size = archive->region.get_size();
+    } catch(boost::interprocess::interprocess_exception&) {
+        // packs nested in other packages have no native file to map
+        PHYSFS_sint64 length = io->length(io);
+        if(length < 0 || !io->seek(io, 0))
+            return nullptr;
+        archive->buffer.resize(length);
+        if(length > 0 && io->read(io, &archive->buffer[0], length) != length)
+            return nullptr;
+        archive->data = (const uchar*)archive->buffer.data();
+        archive->size = length;
+    }
+
+    if(!archive->parseIndex()) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+        return nullptr;
+    }
+
+    archive->io = io;
+    return archive.release();
+}
+
+PHYSFS_EnumerateCallbackResult enumerateFiles(void *opaque, const char *dirname, PHYSFS_EnumerateCallback cb, const char *origdir, void *callbackdata)
+{
+    PackArchive *archive = (PackArchive*)opaque;
+    auto it = archive->directories.find(dirname);
+    if(it == archive->directories.end())
+        return PHYSFS_ENUM_OK;
+
+    for(const std::string& name : it->second) {
+        PHYSFS_EnumerateCallbackResult result = cb(callbackdata, origdir, name.c_str());
+        if(result == PHYSFS_ENUM_ERROR)
+            PHYSFS_setErrorCode(PHYSFS_ERR_APP_CALLBACK);
+        if(result != PHYSFS_ENUM_OK)
+            return result;
+    }
+    return PHYSFS_ENUM_OK;
+}
+
+PHYSFS_Io *openRead(void *opaque, const char *fileName)
+{
+    PackArchive *archive = (PackArchive*)opaque;
+    const PackEntry *entry = archive->find(fileName);
+    if(!entry) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+        return nullptr;
+    }
+
+    // stored files are read straight from the mapping, physfs keeps the pack mounted while they are open
+    const uchar *data = archive->data + entry->offset;
+    if(entry->compression == ResourcePack::CompressionNone)
+        return createFileIo(data, entry->size, nullptr);
+
+    auto buffer = std::make_shared<std::string>(entry->size, '\0');
+    uLongf size = entry->size;
+    if(entry->size > 0 && (uncompress((Bytef*)&(*buffer)[0], &size, data, entry->storedSize) != Z_OK || size != entry->size)) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+        return nullptr;
+    }
+    return createFileIo((const uchar*)buffer->data(), entry->size, buffer);
+}
+
+PHYSFS_Io *openWrite(void*, const char*)
+{
+    PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+    return nullptr;
+}
+
+int modify(void*, const char*)
+{
+    PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+    return 0;
+}
+
+int statFile(void *opaque, const char *fileName, PHYSFS_Stat *stat)
+{
+    PackArchive *archive = (PackArchive*)opaque;
+    stat->modtime = archive->modTime;
+    stat->createtime = archive->modTime;
+    stat->accesstime = -1;
+    stat->readonly = 1;
+
+    if(const PackEntry *entry = archive->find(fileName)) {
+        stat->filesize = entry->size;
+        stat->filetype = PHYSFS_FILETYPE_REGULAR;
+        return 1;
+    }
+
+    if(archive->directories.find(fileName) != archive->directories.end()) {
+        stat->filesize = 0;
+        stat->filetype = PHYSFS_FILETYPE_DIRECTORY;
+        return 1;
+    }
+
+    PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+    return 0;
+}
+
+void closeArchive(void *opaque)
+{
+    PackArchive *archive = (PackArchive*)opaque;
+    archive->io->destroy(archive->io);
+    delete archive;
+}
+
+const PHYSFS_Archiver packArchiver = {
+    0,
+    { "otpkg", "OTClient resource pack", "OTClient", "https://github.com/edubart/otclient", 0 },
+    openArchive,
+    enumerateFiles,
+    openRead,
+    openWrite,
+    openWrite,
+    modify,
+    modify,
+    statFile,
+    closeArchive
+};
+
+void writeBytes(std::ofstream& out, const void *data, size_t size)
+{
+    if(!out.write((const char*)data, size))
+        stdext::throw_exception("write failed");
+}
+
+}
+
+bool ResourcePack::registerArchiver()
+{
+    if(!PHYSFS_registerArchiver(&packArchiver)) {
+        g_logger.error(stdext::format("Unable to register resource pack archiver: %s", PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode())));
+        return false;
+    }
+    return true;
+}
+
+int ResourcePack::create(const std::string& directory, const std::string& packFile, int compressionLevel)
+{
+    namespace fs = boost::filesystem;
+
+    std::string root = fs::path(directory).generic_string();
+    if(!stdext::ends_with(root, "/"))
+        root += "/";
+    if(!fs::is_directory(root))
+        stdext::throw_exception(stdext::format("'%s' is not a directory", directory));
+
+    fs::path packPath(packFile);
+    if(packPath.has_parent_path())
+        fs::create_directories(packPath.parent_path());
+
+    std::ofstream out(packFile.c_str(), std::ios::binary | std::ios::trunc);
+    if(!out)
+        stdext::throw_exception(stdext::format("unable to create '%s'", packFile));
+
+    uchar bytes[PACK_HEADER_SIZE];
+    memset(bytes, 0, PACK_HEADER_SIZE);
+    writeBytes(out, bytes, PACK_HEADER_SIZE);
+
+    std::vector<PackEntry> entries;
+    uint64 offset = PACK_HEADER_SIZE;
+    for(fs::recursive_directory_iterator it(root), end; it != end; ++it) {
+        if(!fs::is_regular_file(it->status()) || fs::equivalent(it->path(), packPath))
+            continue;
+
+        // hidden files and directories are never shipped
+        std::string name = it->path().generic_string().substr(root.size());
+        if(stdext::starts_with(name, ".") || name.find("/.") != std::string::npos)
+            continue;
+
+        std::ifstream in(it->path().string().c_str(), std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if(in.bad())
+            stdext::throw_exception(stdext::format("unable to read '%s'", it->path().string()));
+
+        PackEntry entry;
+        entry.hash = hashPath(name);
+        entry.name = name;
+        entry.offset = offset;
+        entry.size = contents.size();
+        entry.storedSize = contents.size();
+        entry.compression = CompressionNone;
+
+        // files that don't shrink are stored, they can be served from the mapping without copies
+        std::string compressed;
+        if(compressionLevel > 0 && !contents.empty()) {
+            uLongf length = compressBound(contents.size());
+            compressed.resize(length);
+            if(compress2((Bytef*)&compressed[0], &length, (const Bytef*)contents.data(), contents.size(), compressionLevel) == Z_OK && length < contents.size()) {
+                compressed.resize(length);
+                entry.storedSize = length;
+                entry.compression = CompressionZlib;
+            }
+        }
+
+        if(entry.compression == CompressionZlib)
+            writeBytes(out, compressed.data(), compressed.size());
+        else
+            writeBytes(out, contents.data(), contents.size());
+        offset += entry.storedSize;
+        entries.push_back(entry);
+    }
+
+    std::sort(entries.begin(), entries.end());
+    for(const PackEntry& entry : entries) {
+        uchar record[17];
+        stdext::writeULE64(bytes, entry.hash);
+        stdext::writeULE16(bytes + 8, entry.name.size());
+        writeBytes(out, bytes, 10);
+        writeBytes(out, entry.name.data(), entry.name.size());
+        stdext::writeULE64(record, entry.offset);
+        stdext::writeULE32(record + 8, entry.size);
+        stdext::writeULE32(record + 12, entry.storedSize);
+        record[16] = entry.compression;
+        writeBytes(out, record, 17);
+    }
+
+    stdext::writeULE32(bytes, PACK_SIGNATURE);
+    stdext::writeULE16(bytes + 4, PACK_VERSION);
+    stdext::writeULE64(bytes + 6, stdext::time());
+    stdext::writeULE32(bytes + 14, entries.size());
+    stdext::writeULE64(bytes + 18, offset);
+    out.seekp(0);
+    writeBytes(out, bytes, PACK_HEADER_SIZE);
+    out.close();
+    if(out.fail())
+        stdext::throw_exception(stdext::format("unable to write '%s'", packFile));
+
+    return entries.size();
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef RESOURCEPACK_H
+#define RESOURCEPACK_H
+
+#include "declarations.h"
+
+/// Native package format: individually compressed files followed by an index sorted by path hash.
+/// Once the archiver is registered packs mount like any other package and are read memory mapped.
+class ResourcePack
+{
+public:
+    enum {
+        PACK_SIGNATURE = 0x4B50544F, // OTPK
+        PACK_VERSION = 1,
+        PACK_HEADER_SIZE = 26
+    };
+
+    enum Compression : uint8 {
+        CompressionNone = 0,
+        CompressionZlib = 1
+    };
+
+    static bool registerArchiver();
+
+    /// Packs every file found under a native directory, paths inside the pack are relative to it
+    /// @exception stdext::exception is thrown when a file can't be read or the pack can't be written
+    static int create(const std::string& directory, const std::string& packFile, int compressionLevel);
+};
+
+#endif
@@ -67,6 +67,9 @@ void BitmapFont::load(const OTMLNodePtr& fontNode)
     */
 
 
+    // layouts depend on the glyphs metrics
+    m_glyphRuns.clear();
+
     // calculate glyphs texture coords
     int numHorizontalGlyphs = m_texture->getSize().width() / glyphSize.width();
     for(int glyph = m_firstGlyph; glyph < 256; ++glyph) {
@@ -99,39 +102,41 @@ void BitmapFont::calculateDrawTextCoords(CoordsBuffer& coordsBuffer, const std::
     if(!screenCoords.isValid() || !m_texture)
         return;
 
-    int textLenght = text.length();
+    const GlyphRun& run = getGlyphRun(text, align);
+    if(run.glyphsScreenCoords.empty())
+        return;
 
-    // map glyphs positions
-    Size textBoxSize;
-    const std::vector<Point>& glyphsPositions = calculateGlyphsPositions(text, align, &textBoxSize);
+    // translate the text box to align position
+    Point offset;
+    if(align & Fw::AlignBottom) {
+        offset.y = screenCoords.height() - run.textBoxSize.height();
+    } else if(align & Fw::AlignVerticalCenter) {
+        offset.y = (screenCoords.height() - run.textBoxSize.height()) / 2;
+    } else { // AlignTop
+        // nothing to do
+    }
 
-    for(int i = 0; i < textLenght; ++i) {
-        int glyph = (uchar)text[i];
+    if(align & Fw::AlignRight) {
+        offset.x = screenCoords.width() - run.textBoxSize.width();
+    } else if(align & Fw::AlignHorizontalCenter) {
+        offset.x = (screenCoords.width() - run.textBoxSize.width()) / 2;
+    } else { // AlignLeft
+        // nothing to do
+    }
 
-        // skip invalid glyphs
-        if(glyph < 32)
-            continue;
+    int glyphsCount = run.glyphsScreenCoords.size();
 
-        // calculate initial glyph rect and texture coords
-        Rect glyphScreenCoords(glyphsPositions[i], m_glyphsSize[glyph]);
-        Rect glyphTextureCoords = m_glyphsTextureCoords[glyph];
-
-        // first translate to align position
-        if(align & Fw::AlignBottom) {
-            glyphScreenCoords.translate(0, screenCoords.height() - textBoxSize.height());
-        } else if(align & Fw::AlignVerticalCenter) {
-            glyphScreenCoords.translate(0, (screenCoords.height() - textBoxSize.height()) / 2);
-        } else { // AlignTop
-            // nothing to do
-        }
+    // the common case, the whole text fits in screenCoords and no glyph needs to be clipped
+    Rect bounds = run.bounds.translated(offset);
+    if(bounds.top() >= 0 && bounds.left() >= 0 && Rect(Point(0, 0), screenCoords.size()).contains(bounds)) {
+        for(int i = 0; i < glyphsCount; ++i)
+            coordsBuffer.addRect(run.glyphsScreenCoords[i].translated(offset + screenCoords.topLeft()), run.glyphsTextureCoords[i]);
+        return;
+    }
 
-        if(align & Fw::AlignRight) {
-            glyphScreenCoords.translate(screenCoords.width() - textBoxSize.width(), 0);
-        } else if(align & Fw::AlignHorizontalCenter) {
-            glyphScreenCoords.translate((screenCoords.width() - textBoxSize.width()) / 2, 0);
-        } else { // AlignLeft
-            // nothing to do
-        }
+    for(int i = 0; i < glyphsCount; ++i) {
+        Rect glyphScreenCoords = run.glyphsScreenCoords[i].translated(offset);
+        Rect glyphTextureCoords = run.glyphsTextureCoords[i];
 
         // only render glyphs that are after 0, 0
         if(glyphScreenCoords.bottom() < 0 || glyphScreenCoords.right() < 0)
@@ -169,6 +174,48 @@ void BitmapFont::calculateDrawTextCoords(CoordsBuffer& coordsBuffer, const std::
     }
 }
 
+const BitmapFont::GlyphRun& BitmapFont::getGlyphRun(const std::string& text, Fw::AlignmentFlag align)
+{
+    size_t key = std::hash<std::string>()(text) ^ ((size_t)align * 0x9e3779b9);
+    auto it = m_glyphRuns.find(key);
+    if(it != m_glyphRuns.end() && it->second.align == align && it->second.text == text)
+        return it->second;
+
+    // texts that are never drawn again would grow the cache forever
+    if(it == m_glyphRuns.end() && (int)m_glyphRuns.size() >= MAX_GLYPH_RUNS) {
+        m_glyphRuns.clear();
+        it = m_glyphRuns.end();
+    }
+
+    GlyphRun& run = it != m_glyphRuns.end() ? it->second : m_glyphRuns[key];
+    run.text = text;
+    run.align = align;
+    run.bounds = Rect();
+    run.glyphsScreenCoords.clear();
+    run.glyphsTextureCoords.clear();
+
+    // map glyphs positions
+    const std::vector<Point>& glyphsPositions = calculateGlyphsPositions(text, align, &run.textBoxSize);
+
+    int textLength = text.length();
+    for(int i = 0; i < textLength; ++i) {
+        int glyph = (uchar)text[i];
+
+        // skip invalid and empty glyphs
+        if(glyph < 32)
+            continue;
+
+        Rect glyphScreenCoords(glyphsPositions[i], m_glyphsSize[glyph]);
+        if(!glyphScreenCoords.isValid())
+            continue;
+
+        run.bounds = run.bounds.isValid() ? run.bounds.united(glyphScreenCoords) : glyphScreenCoords;
+        run.glyphsScreenCoords.push_back(glyphScreenCoords);
+        run.glyphsTextureCoords.push_back(m_glyphsTextureCoords[glyph]);
+    }
+    return run;
+}
+
 const std::vector<Point>& BitmapFont::calculateGlyphsPositions(const std::string& text,
                                                          Fw::AlignmentFlag align,
                                                          Size *textBoxSize)
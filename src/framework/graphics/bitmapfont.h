@@ -31,7 +31,21 @@
 
 class BitmapFont : public stdext::shared_object
 {
+    enum {
+        MAX_GLYPH_RUNS = 4096
+    };
+
 public:
+    /// Laid out glyph quads of a text, relative to its text box
+    struct GlyphRun {
+        std::string text;
+        Fw::AlignmentFlag align;
+        Size textBoxSize;
+        Rect bounds;
+        std::vector<Rect> glyphsScreenCoords;
+        std::vector<Rect> glyphsTextureCoords;
+    };
+
     BitmapFont(const std::string& name) : m_name(name) { }
 
     /// Load font from otml node
@@ -50,6 +64,11 @@ public:
                                                        Fw::AlignmentFlag align = Fw::AlignTopLeft,
                                                        Size* textBoxSize = nullptr);
 
+    /// Layout of a text, cached by content hash until the font is reloaded
+    const GlyphRun& getGlyphRun(const std::string& text, Fw::AlignmentFlag align = Fw::AlignTopLeft);
+    void clearGlyphRuns() { m_glyphRuns.clear(); }
+    int getGlyphRunsCount() { return m_glyphRuns.size(); }
+
     /// Simulate render and calculate text size
     Size calculateTextRectSize(const std::string& text);
 
@@ -75,6 +94,7 @@ private:
     TexturePtr m_texture;
     Rect m_glyphsTextureCoords[256];
     Size m_glyphsSize[256];
+    std::unordered_map<size_t, GlyphRun> m_glyphRuns;
 };
 
 
@@ -24,6 +24,7 @@
 #include "painter.h"
 #include "fontmanager.h"
 #include "bitmapfont.h"
+#include "textbatch.h"
 
 CachedText::CachedText()
 {
@@ -36,6 +37,23 @@ void CachedText::draw(const Rect& rect)
     if(!m_font)
         return;
 
+    updateCoords(rect);
+
+    if(m_font->getTexture())
+        g_painter->drawTextureCoords(m_textCoordsBuffer, m_font->getTexture());
+}
+
+void CachedText::draw(const Rect& rect, TextBatch& batch, const Color& color)
+{
+    if(!m_font)
+        return;
+
+    updateCoords(rect);
+    batch.add(m_font->getTexture(), m_textCoordsBuffer, color);
+}
+
+void CachedText::updateCoords(const Rect& rect)
+{
     if(m_textMustRecache || m_textCachedScreenCoords != rect) {
         m_textMustRecache = false;
         m_textCachedScreenCoords = rect;
@@ -43,9 +61,6 @@ void CachedText::draw(const Rect& rect)
         m_textCoordsBuffer.clear();
         m_font->calculateDrawTextCoords(m_textCoordsBuffer, m_text, rect, Fw::AlignCenter);
     }
-
-    if(m_font->getTexture())
-        g_painter->drawTextureCoords(m_textCoordsBuffer, m_font->getTexture());
 }
 
 void CachedText::update()
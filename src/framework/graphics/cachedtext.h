@@ -32,6 +32,7 @@ public:
     CachedText();
 
     void draw(const Rect& rect);
+    void draw(const Rect& rect, TextBatch& batch, const Color& color);
 
     void wrapText(int maxWidth);
     void setFont(const BitmapFontPtr& font) { m_font = font; update(); }
@@ -45,6 +46,7 @@ public:
 
 private:
     void update();
+    void updateCoords(const Rect& rect);
 
     std::string m_text;
     Size m_textSize;
@@ -32,6 +32,7 @@ class Image;
 class AnimatedTexture;
 class BitmapFont;
 class CachedText;
+class TextBatch;
 class FrameBuffer;
 class FrameBufferManager;
 class Shader;
@@ -22,6 +22,12 @@
 
 #include "fontmanager.h"
 #include "texture.h"
+#include "cachedtext.h"
+#include "textbatch.h"
+#include "painter.h"
+#include "graphics.h"
+#include "framebuffer.h"
+#include "framebuffermanager.h"
 
 #include <framework/core/resourcemanager.h>
 #include <framework/otml/otml.h>
@@ -99,3 +105,82 @@ BitmapFontPtr FontManager::getFont(const std::string& fontName)
     g_logger.error(stdext::format("font '%s' not found", fontName));
     return getDefaultFont();
 }
+
+std::map<std::string, double> FontManager::benchmarkDrawText(int texts, int frames)
+{
+    std::map<std::string, double> result;
+    texts = std::max<int>(texts, 1);
+    frames = std::max<int>(frames, 1);
+
+    // creature names colored by health, as the map draws them
+    static const Color colors[] = { Color(0x00, 0xBC, 0x00), Color(0x50, 0xA1, 0x50), Color(0xA1, 0xA1, 0x00), Color(0xBF, 0x0A, 0x0A) };
+    std::vector<CachedText> names(texts);
+    std::vector<Rect> rects(texts);
+    for(int i = 0; i < texts; ++i) {
+        names[i].setFont(m_defaultFont);
+        names[i].setText(stdext::format("Creature %d", i));
+        rects[i] = Rect(Point((i % 16) * 64, (i / 16) * 16 % 1008), names[i].getTextSize());
+    }
+
+    // draw offscreen when possible, so the benchmark never shows up on screen
+    FrameBufferPtr framebuffer;
+    if(g_graphics.canUseFBO()) {
+        framebuffer = g_framebuffers.createFrameBuffer();
+        framebuffer->resize(Size(1024, 1024));
+        framebuffer->bind();
+    }
+
+    // walking creatures move every frame, so their coords are rebuilt
+    stdext::timer timer;
+    for(int frame = 0; frame < frames; ++frame) {
+        for(int i = 0; i < texts; ++i) {
+            g_painter->setColor(colors[i % 4]);
+            names[i].draw(rects[i].translated(frame % 2, 0));
+        }
+    }
+    glFinish();
+    result["immediateMillisPerFrame"] = timer.elapsed_seconds() * 1000.0 / frames;
+
+    TextBatch batch;
+    int groups = 0;
+    timer.restart();
+    for(int frame = 0; frame < frames; ++frame) {
+        for(int i = 0; i < texts; ++i)
+            names[i].draw(rects[i].translated(frame % 2, 0), batch, colors[i % 4]);
+        groups = batch.getGroupsCount();
+        batch.flush();
+    }
+    glFinish();
+    result["batchedMillisPerFrame"] = timer.elapsed_seconds() * 1000.0 / frames;
+
+    if(framebuffer)
+        framebuffer->release();
+
+    // layout alone, with and without the glyph runs cache
+    CoordsBuffer coordsBuffer;
+    timer.restart();
+    for(int frame = 0; frame < frames; ++frame) {
+        m_defaultFont->clearGlyphRuns();
+        for(int i = 0; i < texts; ++i) {
+            coordsBuffer.clear();
+            m_defaultFont->calculateDrawTextCoords(coordsBuffer, names[i].getText(), rects[i], Fw::AlignCenter);
+        }
+    }
+    result["coldLayoutMillisPerFrame"] = timer.elapsed_seconds() * 1000.0 / frames;
+
+    timer.restart();
+    for(int frame = 0; frame < frames; ++frame) {
+        for(int i = 0; i < texts; ++i) {
+            coordsBuffer.clear();
+            m_defaultFont->calculateDrawTextCoords(coordsBuffer, names[i].getText(), rects[i], Fw::AlignCenter);
+        }
+    }
+    result["cachedLayoutMillisPerFrame"] = timer.elapsed_seconds() * 1000.0 / frames;
+
+    result["texts"] = texts;
+    result["frames"] = frames;
+    result["immediateDrawCalls"] = texts;
+    result["batchedDrawCalls"] = groups;
+    result["glyphRuns"] = m_defaultFont->getGlyphRunsCount();
+    return result;
+}
@@ -42,6 +42,8 @@ public:
 
     void setDefaultFont(const std::string& fontName) { m_defaultFont = getFont(fontName); }
 
+    std::map<std::string, double> benchmarkDrawText(int texts, int frames);
+
 private:
     std::vector<BitmapFontPtr> m_fonts;
     BitmapFontPtr m_defaultFont;
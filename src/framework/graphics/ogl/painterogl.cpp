@@ -45,6 +45,7 @@ void PainterOGL::resetState()
     resetCompositionMode();
     resetBlendEquation();
     resetClipRect();
+    resetClipOffset();
     resetShaderProgram();
     resetTexture();
     resetAlphaWriting();
@@ -73,6 +74,7 @@ void PainterOGL::saveState()
     m_olderStates[m_oldStateIndex].compositionMode = m_compositionMode;
     m_olderStates[m_oldStateIndex].blendEquation = m_blendEquation;
     m_olderStates[m_oldStateIndex].clipRect = m_clipRect;
+    m_olderStates[m_oldStateIndex].clipOffset = m_clipOffset;
     m_olderStates[m_oldStateIndex].shaderProgram = m_shaderProgram;
     m_olderStates[m_oldStateIndex].texture = m_texture;
     m_olderStates[m_oldStateIndex].alphaWriting = m_alphaWriting;
@@ -96,6 +98,7 @@ void PainterOGL::restoreSavedState()
     setOpacity(m_olderStates[m_oldStateIndex].opacity);
     setCompositionMode(m_olderStates[m_oldStateIndex].compositionMode);
     setBlendEquation(m_olderStates[m_oldStateIndex].blendEquation);
+    setClipOffset(m_olderStates[m_oldStateIndex].clipOffset);
     setClipRect(m_olderStates[m_oldStateIndex].clipRect);
     setShaderProgram(m_olderStates[m_oldStateIndex].shaderProgram);
     setTexture(m_olderStates[m_oldStateIndex].texture);
@@ -141,6 +144,14 @@ void PainterOGL::setClipRect(const Rect& clipRect)
     updateGlClipRect();
 }
 
+void PainterOGL::setClipOffset(const Point& clipOffset)
+{
+    if(m_clipOffset == clipOffset)
+        return;
+    m_clipOffset = clipOffset;
+    updateGlClipRect();
+}
+
 void PainterOGL::setTexture(Texture* texture)
 {
     if(m_texture == texture)
@@ -279,6 +290,9 @@ void PainterOGL::updateGlCompositionMode()
         case CompositionMode_Light:
             glBlendFunc(GL_ZERO, GL_SRC_COLOR);
             break;
+        case CompositionMode_Premultiplied:
+            glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+            break;
     }
 }
 
@@ -295,8 +309,10 @@ void PainterOGL::updateGlBlendEquation()
 void PainterOGL::updateGlClipRect()
 {
     if(m_clipRect.isValid()) {
+        // clip rects are given in screen coordinates, the offset moves them into an offscreen target
+        Rect clipRect = m_clipRect.translated(-m_clipOffset);
         glEnable(GL_SCISSOR_TEST);
-        glScissor(m_clipRect.left(), m_resolution.height() - m_clipRect.bottom() - 1, m_clipRect.width(), m_clipRect.height());
+        glScissor(clipRect.left(), m_resolution.height() - clipRect.bottom() - 1, clipRect.width(), clipRect.height());
     } else {
         glScissor(0, 0, m_resolution.width(), m_resolution.height());
         glDisable(GL_SCISSOR_TEST);
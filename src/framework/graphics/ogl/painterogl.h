@@ -38,6 +38,7 @@ public:
         Painter::CompositionMode compositionMode;
         Painter::BlendEquation blendEquation;
         Rect clipRect;
+        Point clipOffset;
         Texture *texture;
         PainterShaderProgram *shaderProgram;
         bool alphaWriting;
@@ -64,6 +65,7 @@ public:
     virtual void setCompositionMode(CompositionMode compositionMode);
     virtual void setBlendEquation(BlendEquation blendEquation);
     virtual void setClipRect(const Rect& clipRect);
+    virtual void setClipOffset(const Point& clipOffset);
     virtual void setShaderProgram(PainterShaderProgram *shaderProgram) { m_shaderProgram = shaderProgram; }
     virtual void setTexture(Texture *texture);
     virtual void setAlphaWriting(bool enable);
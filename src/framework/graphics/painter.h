@@ -41,7 +41,8 @@ public:
         CompositionMode_Add,
         CompositionMode_Replace,
         CompositionMode_DestBlending,
-        CompositionMode_Light
+        CompositionMode_Light,
+        CompositionMode_Premultiplied
     };
     enum DrawMode {
         Triangles = GL_TRIANGLES,
@@ -74,6 +75,7 @@ public:
 
     virtual void setTexture(Texture *texture) = 0;
     virtual void setClipRect(const Rect& clipRect) = 0;
+    virtual void setClipOffset(const Point& clipOffset) = 0;
     virtual void setColor(const Color& color) { m_color = color; }
     virtual void setAlphaWriting(bool enable) = 0;
     virtual void setBlendEquation(BlendEquation blendEquation) = 0;
@@ -95,6 +97,7 @@ public:
     Color getColor() { return m_color; }
     float getOpacity() { return m_opacity; }
     Rect getClipRect() { return m_clipRect; }
+    Point getClipOffset() { return m_clipOffset; }
     CompositionMode getCompositionMode() { return m_compositionMode; }
 
     virtual void setCompositionMode(CompositionMode compositionMode) = 0;
@@ -103,6 +106,7 @@ public:
     virtual void popTransformMatrix() = 0;
 
     void resetClipRect() { setClipRect(Rect()); }
+    void resetClipOffset() { setClipOffset(Point()); }
     void resetOpacity() { setOpacity(1.0f); }
     void resetCompositionMode() { setCompositionMode(CompositionMode_Normal); }
     void resetColor() { setColor(Color::white); }
@@ -117,6 +121,7 @@ protected:
     Size m_resolution;
     float m_opacity;
     Rect m_clipRect;
+    Point m_clipOffset;
 };
 
 extern Painter *g_painter;
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "textbatch.h"
+#include "bitmapfont.h"
+#include "painter.h"
+
+void TextBatch::add(const BitmapFontPtr& font, const std::string& text, const Rect& screenCoords, const Color& color, Fw::AlignmentFlag align)
+{
+    if(!font || !font->getTexture() || text.empty())
+        return;
+
+    font->calculateDrawTextCoords(getGroup(font->getTexture(), color).coordsBuffer, text, screenCoords, align);
+    m_texts++;
+}
+
+void TextBatch::add(const TexturePtr& texture, const CoordsBuffer& coordsBuffer, const Color& color)
+{
+    if(!texture)
+        return;
+
+    getGroup(texture, color).coordsBuffer.append(coordsBuffer);
+    m_texts++;
+}
+
+void TextBatch::flush()
+{
+    if(m_texts == 0)
+        return;
+
+    Color oldColor = g_painter->getColor();
+    for(Group& group : m_groups) {
+        if(group.coordsBuffer.getVertexCount() == 0)
+            continue;
+
+        g_painter->setColor(group.color);
+        g_painter->drawTextureCoords(group.coordsBuffer, group.texture);
+        group.coordsBuffer.clear();
+    }
+    g_painter->setColor(oldColor);
+
+    // groups are kept between frames to reuse their buffers, unless colors keep changing
+    if(m_groups.size() > MAX_IDLE_GROUPS)
+        m_groups.clear();
+    m_texts = 0;
+}
+
+void TextBatch::clear()
+{
+    m_groups.clear();
+    m_texts = 0;
+}
+
+TextBatch::Group& TextBatch::getGroup(const TexturePtr& texture, const Color& color)
+{
+    for(Group& group : m_groups) {
+        if(group.texture == texture && group.color == color)
+            return group;
+    }
+
+    m_groups.emplace_back();
+    Group& group = m_groups.back();
+    group.texture = texture;
+    group.color = color;
+    return group;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef TEXTBATCH_H
+#define TEXTBATCH_H
+
+#include "declarations.h"
+#include "coordsbuffer.h"
+
+/// Collects texts drawn in a frame and emits them with one draw call per font texture and color
+class TextBatch
+{
+    enum {
+        MAX_IDLE_GROUPS = 32
+    };
+
+public:
+    TextBatch() : m_texts(0) { }
+
+    void add(const BitmapFontPtr& font, const std::string& text, const Rect& screenCoords, const Color& color, Fw::AlignmentFlag align = Fw::AlignTopLeft);
+    void add(const TexturePtr& texture, const CoordsBuffer& coordsBuffer, const Color& color);
+
+    void flush();
+    void clear();
+
+    int getTextsCount() { return m_texts; }
+    int getGroupsCount() { return m_groups.size(); }
+
+private:
+    struct Group {
+        TexturePtr texture;
+        Color color;
+        CoordsBuffer coordsBuffer;
+    };
+
+    Group& getGroup(const TexturePtr& texture, const Color& color);
+
+    std::deque<Group> m_groups;
+    int m_texts;
+};
+
+#endif
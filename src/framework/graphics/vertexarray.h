@@ -73,6 +73,13 @@ public:
         addVertex(right, top);
     }
 
+    void append(const VertexArray& other) {
+        int start = m_buffer.size();
+        m_buffer.grow(start + other.size());
+        for(int i = 0; i < other.size(); ++i)
+            m_buffer[start + i] = other.m_buffer[i];
+    }
+
     void clear() { m_buffer.reset(); }
     float *vertices() const { return m_buffer.data(); }
     int vertexCount() const { return m_buffer.size() / 2; }
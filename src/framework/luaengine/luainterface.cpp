@@ -24,12 +24,42 @@
 #include "luaobject.h"
 
 #include <framework/core/resourcemanager.h>
+#include <framework/core/filestream.h>
 #include <lua.hpp>
 
 #include "lbitlib.h"
 
 LuaInterface g_lua;
 
+enum {
+    BYTECODE_CACHE_SIGNATURE = 0x4342544F, // "OTBC"
+    BYTECODE_CACHE_VERSION = 1
+};
+
+// bytecode can only be loaded by the same lua implementation that dumped it
+#ifdef LUAJIT_VERSION
+static const char *bytecodeFormat = LUAJIT_VERSION;
+#else
+static const char *bytecodeFormat = LUA_RELEASE;
+#endif
+
+// fnv-1a, stable between runs and builds unlike std::hash
+static uint64 hashBuffer(const std::string& buffer)
+{
+    uint64 hash = 14695981039346656037ULL;
+    for(char c : buffer) {
+        hash ^= (uint8)c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static int writeBytecode(lua_State*, const void* data, size_t size, void* buffer)
+{
+    static_cast<std::string*>(buffer)->append(static_cast<const char*>(data), size);
+    return 0;
+}
+
 LuaInterface::LuaInterface()
 {
     L = nullptr;
@@ -37,6 +67,8 @@ LuaInterface::LuaInterface()
     m_weakTableRef = 0;
     m_totalObjRefs = 0;
     m_totalFuncRefs = 0;
+    m_bytecodeCacheEnabled = false;
+    resetScriptLoadStats();
 }
 
 LuaInterface::~LuaInterface()
@@ -329,10 +361,170 @@ void LuaInterface::loadScript(const std::string& fileName)
         filePath = getCurrentSourcePath() + "/" + filePath;
 
     filePath = g_resources.guessFilePath(filePath, "lua");
-
-    std::string buffer = g_resources.readFileContents(filePath);
     std::string source = "@" + filePath;
+
+    stdext::timer timer;
+    if(!m_bytecodeCacheEnabled || g_resources.getWriteDir().empty()) {
+        loadBuffer(g_resources.readFileContents(filePath), source);
+        m_compiledLoads++;
+        m_compiledLoadSeconds += timer.elapsed_seconds();
+        return;
+    }
+
+    std::string buffer;
+    uint64 hash = 0;
+    ticks_t fileTime = g_resources.getFileTime(filePath);
+    if(loadBytecodeCache(filePath, fileTime, buffer, hash)) {
+        m_cachedLoads++;
+        m_cachedLoadSeconds += timer.elapsed_seconds();
+        return;
+    }
+
+    // the cache may have read the script already to compare hashes
+    if(buffer.empty()) {
+        buffer = g_resources.readFileContents(filePath);
+        hash = hashBuffer(buffer);
+    }
+
     loadBuffer(buffer, source);
+    saveBytecodeCache(filePath, fileTime, hash);
+    m_compiledLoads++;
+    m_compiledLoadSeconds += timer.elapsed_seconds();
+}
+
+int LuaInterface::precompileScripts(const std::string& directory)
+{
+    bool enabled = m_bytecodeCacheEnabled;
+    m_bytecodeCacheEnabled = true;
+
+    int count = 0;
+    for(const std::string& fileName : g_resources.listDirectoryFiles(directory)) {
+        std::string fullPath = directory == "/" ? "/" + fileName : directory + "/" + fileName;
+
+        if(g_resources.directoryExists(fullPath)) {
+            count += precompileScripts(fullPath);
+            continue;
+        }
+
+        if(!g_resources.isFileType(fileName, "lua"))
+            continue;
+
+        try {
+            loadScript(fullPath);
+            pop();
+            count++;
+        } catch(stdext::exception& e) {
+            g_logger.error(stdext::format("Failed to precompile script '%s': %s", fullPath, e.what()));
+        }
+    }
+
+    m_bytecodeCacheEnabled = enabled;
+    return count;
+}
+
+std::map<std::string, double> LuaInterface::getScriptLoadStats()
+{
+    std::map<std::string, double> stats;
+    stats["cachedLoads"] = m_cachedLoads;
+    stats["compiledLoads"] = m_compiledLoads;
+    stats["cacheWrites"] = m_cacheWrites;
+    stats["cachedMillis"] = m_cachedLoadSeconds * 1000.0;
+    stats["compiledMillis"] = m_compiledLoadSeconds * 1000.0;
+    stats["cachedMillisPerLoad"] = m_cachedLoadSeconds * 1000.0 / std::max<int>(m_cachedLoads, 1);
+    stats["compiledMillisPerLoad"] = m_compiledLoadSeconds * 1000.0 / std::max<int>(m_compiledLoads, 1);
+    return stats;
+}
+
+void LuaInterface::resetScriptLoadStats()
+{
+    m_cachedLoads = 0;
+    m_compiledLoads = 0;
+    m_cacheWrites = 0;
+    m_cachedLoadSeconds = 0;
+    m_compiledLoadSeconds = 0;
+}
+
+std::string LuaInterface::getBytecodeCacheFile(const std::string& filePath)
+{
+    uint64 key = hashBuffer(filePath);
+    return stdext::format("/bytecode/%08x%08x.otbc", (uint32)(key >> 32), (uint32)key);
+}
+
+bool LuaInterface::loadBytecodeCache(const std::string& filePath, ticks_t fileTime, std::string& buffer, uint64& hash)
+{
+    std::string file = getBytecodeCacheFile(filePath);
+    if(!g_resources.fileExists(file))
+        return false;
+
+    try {
+        // read through the resource manager so caches preloaded at startup are used
+        FileStreamPtr fin(new FileStream(file, g_resources.readFileContents(file)));
+
+        if(fin->getU32() != BYTECODE_CACHE_SIGNATURE || fin->getU16() != BYTECODE_CACHE_VERSION)
+            return false;
+
+        // the bytecode format depends on the lua build
+        if(fin->getString() != bytecodeFormat || fin->getU8() != sizeof(void*) || fin->getString() != filePath)
+            return false;
+
+        ticks_t cachedTime = fin->get64();
+        uint64 cachedHash = fin->getU64();
+
+        // archives have no modification time, their scripts are always hashed
+        if(fileTime == 0 || cachedTime != fileTime) {
+            buffer = g_resources.readFileContents(filePath);
+            hash = hashBuffer(buffer);
+            if(hash != cachedHash)
+                return false;
+        }
+
+        uint32 size = fin->getU32();
+        std::string bytecode(size, '\0');
+        if(size == 0 || fin->read(&bytecode[0], size) != 1)
+            return false;
+        fin->close();
+
+        loadBuffer(bytecode, "@" + filePath);
+        return true;
+    } catch(stdext::exception& e) {
+        g_logger.warning(stdext::format("Discarding bytecode cache of '%s': %s", filePath, e.what()));
+        return false;
+    }
+}
+
+void LuaInterface::saveBytecodeCache(const std::string& filePath, ticks_t fileTime, uint64 hash)
+{
+    std::string bytecode;
+    if(lua_dump(L, &writeBytecode, &bytecode) != 0 || bytecode.empty())
+        return;
+
+    std::string file = getBytecodeCacheFile(filePath);
+    try {
+        if(!g_resources.directoryExists("/bytecode"))
+            g_resources.makeDir("/bytecode");
+
+        FileStreamPtr fin = g_resources.createFile(file);
+        if(!fin)
+            stdext::throw_exception(stdext::format("failed to open file '%s' for write", file));
+
+        fin->cache();
+
+        fin->addU32(BYTECODE_CACHE_SIGNATURE);
+        fin->addU16(BYTECODE_CACHE_VERSION);
+        fin->addString(bytecodeFormat);
+        fin->addU8(sizeof(void*));
+        fin->addString(filePath);
+        fin->add64(fileTime);
+        fin->addU64(hash);
+        fin->addU32(bytecode.size());
+        fin->write(bytecode.data(), bytecode.size());
+
+        fin->flush();
+        fin->close();
+        m_cacheWrites++;
+    } catch(std::exception& e) {
+        g_logger.error(stdext::format("Failed to save bytecode cache '%s': %s", file, e.what()));
+    }
 }
 
 void LuaInterface::loadFunction(const std::string& buffer, const std::string& source)
@@ -147,6 +147,17 @@ public:
     /// @exception LuaException is thrown on any lua error
     void loadScript(const std::string& fileName);
 
+    /// Caches compiled scripts in the write dir, keyed by path, modification time and content hash
+    void setBytecodeCacheEnabled(bool enabled) { m_bytecodeCacheEnabled = enabled; }
+    bool isBytecodeCacheEnabled() { return m_bytecodeCacheEnabled; }
+    std::string getBytecodeCacheFile(const std::string& filePath);
+
+    /// Compiles every script found in directory into the bytecode cache without running them
+    int precompileScripts(const std::string& directory);
+
+    std::map<std::string, double> getScriptLoadStats();
+    void resetScriptLoadStats();
+
     /// Loads a function from buffer and pushes it onto stack,
     /// @exception LuaException is thrown on any lua error
     void loadFunction(const std::string& buffer, const std::string& source = "lua function buffer");
@@ -339,12 +350,21 @@ public:
     T polymorphicPop() { T v = castValue<T>(); pop(1); return v; }
 
 private:
+    bool loadBytecodeCache(const std::string& filePath, ticks_t fileTime, std::string& buffer, uint64& hash);
+    void saveBytecodeCache(const std::string& filePath, ticks_t fileTime, uint64 hash);
+
     lua_State* L;
     int m_weakTableRef;
     int m_cppCallbackDepth;
     int m_totalObjRefs;
     int m_totalFuncRefs;
     int m_globalEnv;
+    bool m_bytecodeCacheEnabled;
+    int m_cachedLoads;
+    int m_compiledLoads;
+    int m_cacheWrites;
+    double m_cachedLoadSeconds;
+    double m_compiledLoadSeconds;
 };
 
 extern LuaInterface g_lua;
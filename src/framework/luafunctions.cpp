@@ -123,6 +123,11 @@ void Application::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_crypt", "rsaSetPublicKey", &Crypt::rsaSetPublicKey, &g_crypt);
     g_lua.bindSingletonFunction("g_crypt", "rsaSetPrivateKey", &Crypt::rsaSetPrivateKey, &g_crypt);
     g_lua.bindSingletonFunction("g_crypt", "rsaGetSize", &Crypt::rsaGetSize, &g_crypt);
+    g_lua.bindSingletonFunction("g_crypt", "setXteaImplementation", &Crypt::setXteaImplementation, &g_crypt);
+    g_lua.bindSingletonFunction("g_crypt", "getXteaImplementation", &Crypt::getXteaImplementation, &g_crypt);
+    g_lua.bindSingletonFunction("g_crypt", "getXteaImplementations", &Crypt::getXteaImplementations, &g_crypt);
+    g_lua.bindSingletonFunction("g_crypt", "xteaSelfTest", &Crypt::xteaSelfTest, &g_crypt);
+    g_lua.bindSingletonFunction("g_crypt", "xteaBenchmark", &Crypt::xteaBenchmark, &g_crypt);
 
     // Clock
     g_lua.registerSingletonClass("g_clock");
@@ -145,6 +150,13 @@ void Application::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_logger", "fireOldMessages", &Logger::fireOldMessages, &g_logger);
     g_lua.bindSingletonFunction("g_logger", "setLogFile", &Logger::setLogFile, &g_logger);
     g_lua.bindSingletonFunction("g_logger", "setOnLog", &Logger::setOnLog, &g_logger);
+    g_lua.bindSingletonFunction("g_logger", "flush", &Logger::flush, &g_logger);
+    g_lua.bindSingletonFunction("g_logger", "setMaxRepeatsPerSecond", &Logger::setMaxRepeatsPerSecond, &g_logger);
+    g_lua.bindSingletonFunction("g_logger", "getMaxRepeatsPerSecond", &Logger::getMaxRepeatsPerSecond, &g_logger);
+    g_lua.bindSingletonFunction("g_logger", "getDroppedMessages", &Logger::getDroppedMessages, &g_logger);
+    g_lua.bindSingletonFunction("g_logger", "getSuppressedMessages", &Logger::getSuppressedMessages, &g_logger);
+    g_lua.bindSingletonFunction("g_logger", "getQueuedMessages", &Logger::getQueuedMessages, &g_logger);
+    g_lua.bindSingletonFunction("g_logger", "resetStats", &Logger::resetStats, &g_logger);
     g_lua.bindSingletonFunction("g_logger", "debug", &Logger::debug, &g_logger);
     g_lua.bindSingletonFunction("g_logger", "info", &Logger::info, &g_logger);
     g_lua.bindSingletonFunction("g_logger", "warning", &Logger::warning, &g_logger);
@@ -154,6 +166,7 @@ void Application::registerLuaFunctions()
     // ModuleManager
     g_lua.registerSingletonClass("g_modules");
     g_lua.bindSingletonFunction("g_modules", "discoverModules", &ModuleManager::discoverModules, &g_modules);
+    g_lua.bindSingletonFunction("g_modules", "preloadModules", &ModuleManager::preloadModules, &g_modules);
     g_lua.bindSingletonFunction("g_modules", "autoLoadModules", &ModuleManager::autoLoadModules, &g_modules);
     g_lua.bindSingletonFunction("g_modules", "discoverModule", &ModuleManager::discoverModule, &g_modules);
     g_lua.bindSingletonFunction("g_modules", "ensureModuleLoaded", &ModuleManager::ensureModuleLoaded, &g_modules);
@@ -161,6 +174,7 @@ void Application::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_modules", "reloadModules", &ModuleManager::reloadModules, &g_modules);
     g_lua.bindSingletonFunction("g_modules", "getModule", &ModuleManager::getModule, &g_modules);
     g_lua.bindSingletonFunction("g_modules", "getModules", &ModuleManager::getModules, &g_modules);
+    g_lua.bindSingletonFunction("g_modules", "printStartupTimes", &ModuleManager::printStartupTimes, &g_modules);
 
     // EventDispatcher
     g_lua.registerSingletonClass("g_dispatcher");
@@ -168,12 +182,22 @@ void Application::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_dispatcher", "scheduleEvent", &EventDispatcher::scheduleEvent, &g_dispatcher);
     g_lua.bindSingletonFunction("g_dispatcher", "cycleEvent", &EventDispatcher::cycleEvent, &g_dispatcher);
 
+    // LuaInterface
+    g_lua.registerSingletonClass("g_lua");
+    g_lua.bindSingletonFunction("g_lua", "setBytecodeCacheEnabled", &LuaInterface::setBytecodeCacheEnabled, &g_lua);
+    g_lua.bindSingletonFunction("g_lua", "isBytecodeCacheEnabled", &LuaInterface::isBytecodeCacheEnabled, &g_lua);
+    g_lua.bindSingletonFunction("g_lua", "precompileScripts", &LuaInterface::precompileScripts, &g_lua);
+    g_lua.bindSingletonFunction("g_lua", "getScriptLoadStats", &LuaInterface::getScriptLoadStats, &g_lua);
+    g_lua.bindSingletonFunction("g_lua", "resetScriptLoadStats", &LuaInterface::resetScriptLoadStats, &g_lua);
+
     // ResourceManager
     g_lua.registerSingletonClass("g_resources");
     g_lua.bindSingletonFunction("g_resources", "addSearchPath", &ResourceManager::addSearchPath, &g_resources);
     g_lua.bindSingletonFunction("g_resources", "setupUserWriteDir", &ResourceManager::setupUserWriteDir, &g_resources);
     g_lua.bindSingletonFunction("g_resources", "setWriteDir", &ResourceManager::setWriteDir, &g_resources);
     g_lua.bindSingletonFunction("g_resources", "searchAndAddPackages", &ResourceManager::searchAndAddPackages, &g_resources);
+    g_lua.bindSingletonFunction("g_resources", "createPackage", &ResourceManager::createPackage, &g_resources);
+    g_lua.bindSingletonFunction("g_resources", "benchmarkPackage", &ResourceManager::benchmarkPackage, &g_resources);
     g_lua.bindSingletonFunction("g_resources", "removeSearchPath", &ResourceManager::removeSearchPath, &g_resources);
     g_lua.bindSingletonFunction("g_resources", "fileExists", &ResourceManager::fileExists, &g_resources);
     g_lua.bindSingletonFunction("g_resources", "directoryExists", &ResourceManager::directoryExists, &g_resources);
@@ -226,6 +250,7 @@ void Application::registerLuaFunctions()
     g_lua.bindClassMemberFunction<Module>("getSandbox", &Module::getSandbox);
     g_lua.bindClassMemberFunction<Module>("isAutoLoad", &Module::isAutoLoad);
     g_lua.bindClassMemberFunction<Module>("getAutoLoadPriority", &Module::getAutoLoadPriority);
+    g_lua.bindClassMemberFunction<Module>("getLoadTime", &Module::getLoadTime);
 
     // Event
     g_lua.registerClass<Event>();
@@ -329,6 +354,10 @@ void Application::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_ui", "getStyle", &UIManager::getStyle, &g_ui);
     g_lua.bindSingletonFunction("g_ui", "getStyleClass", &UIManager::getStyleClass, &g_ui);
     g_lua.bindSingletonFunction("g_ui", "loadUI", &UIManager::loadUI, &g_ui);
+    g_lua.bindSingletonFunction("g_ui", "benchmarkLoadUI", &UIManager::benchmarkLoadUI, &g_ui);
+    g_lua.bindSingletonFunction("g_ui", "benchmarkAnchorLayout", &UIManager::benchmarkAnchorLayout, &g_ui);
+    g_lua.bindSingletonFunction("g_ui", "getRenderCacheStats", &UIManager::getRenderCacheStats, &g_ui);
+    g_lua.bindSingletonFunction("g_ui", "resetRenderCacheStats", &UIManager::resetRenderCacheStats, &g_ui);
     g_lua.bindSingletonFunction("g_ui", "displayUI", &UIManager::displayUI, &g_ui);
     g_lua.bindSingletonFunction("g_ui", "createWidget", &UIManager::createWidget, &g_ui);
     g_lua.bindSingletonFunction("g_ui", "createWidgetFromOTML", &UIManager::createWidgetFromOTML, &g_ui);
@@ -346,6 +375,7 @@ void Application::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_fonts", "importFont", &FontManager::importFont, &g_fonts);
     g_lua.bindSingletonFunction("g_fonts", "fontExists", &FontManager::fontExists, &g_fonts);
     g_lua.bindSingletonFunction("g_fonts", "setDefaultFont", &FontManager::setDefaultFont, &g_fonts);
+    g_lua.bindSingletonFunction("g_fonts", "benchmarkDrawText", &FontManager::benchmarkDrawText, &g_fonts);
 
     // ParticleManager
     g_lua.registerSingletonClass("g_particles");
@@ -624,6 +654,9 @@ void Application::registerLuaFunctions()
     g_lua.bindClassMemberFunction<UIWidget>("getTextWrap", &UIWidget::getTextWrap);
     g_lua.bindClassMemberFunction<UIWidget>("getFont", &UIWidget::getFont);
     g_lua.bindClassMemberFunction<UIWidget>("getTextSize", &UIWidget::getTextSize);
+    g_lua.bindClassMemberFunction<UIWidget>("setRenderCache", &UIWidget::setRenderCache);
+    g_lua.bindClassMemberFunction<UIWidget>("invalidateRenderCache", &UIWidget::invalidateRenderCache);
+    g_lua.bindClassMemberFunction<UIWidget>("hasRenderCache", &UIWidget::hasRenderCache);
 
     // UILayout
     g_lua.registerClass<UILayout>();
@@ -747,6 +780,40 @@ void Application::registerLuaFunctions()
     g_lua.registerClass<UIParticles, UIWidget>();
     g_lua.bindClassStaticFunction<UIParticles>("create", []{ return UIParticlesPtr(new UIParticles); } );
     g_lua.bindClassMemberFunction<UIParticles>("addEffect", &UIParticles::addEffect);
+
+    // UIVirtualList
+    g_lua.registerClass<UIVirtualList, UIWidget>();
+    g_lua.bindClassStaticFunction<UIVirtualList>("create", []{ return UIVirtualListPtr(new UIVirtualList); } );
+    g_lua.bindClassMemberFunction<UIVirtualList>("addItem", &UIVirtualList::addItem);
+    g_lua.bindClassMemberFunction<UIVirtualList>("insertItem", &UIVirtualList::insertItem);
+    g_lua.bindClassMemberFunction<UIVirtualList>("removeItem", &UIVirtualList::removeItem);
+    g_lua.bindClassMemberFunction<UIVirtualList>("removeFirstItems", &UIVirtualList::removeFirstItems);
+    g_lua.bindClassMemberFunction<UIVirtualList>("clearItems", &UIVirtualList::clearItems);
+    g_lua.bindClassMemberFunction<UIVirtualList>("setItemText", &UIVirtualList::setItemText);
+    g_lua.bindClassMemberFunction<UIVirtualList>("setItemHeight", &UIVirtualList::setItemHeight);
+    g_lua.bindClassMemberFunction<UIVirtualList>("refreshItem", &UIVirtualList::refreshItem);
+    g_lua.bindClassMemberFunction<UIVirtualList>("refreshItems", &UIVirtualList::refreshItems);
+    g_lua.bindClassMemberFunction<UIVirtualList>("setRowStyle", &UIVirtualList::setRowStyle);
+    g_lua.bindClassMemberFunction<UIVirtualList>("setRowHeight", &UIVirtualList::setRowHeight);
+    g_lua.bindClassMemberFunction<UIVirtualList>("setRowSpacing", &UIVirtualList::setRowSpacing);
+    g_lua.bindClassMemberFunction<UIVirtualList>("setScrollOffset", &UIVirtualList::setScrollOffset);
+    g_lua.bindClassMemberFunction<UIVirtualList>("setAutoScroll", &UIVirtualList::setAutoScroll);
+    g_lua.bindClassMemberFunction<UIVirtualList>("scrollToIndex", &UIVirtualList::scrollToIndex);
+    g_lua.bindClassMemberFunction<UIVirtualList>("ensureIndexVisible", &UIVirtualList::ensureIndexVisible);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getItemText", &UIVirtualList::getItemText);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getItemHeight", &UIVirtualList::getItemHeight);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getItemCount", &UIVirtualList::getItemCount);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getItemIndexAt", &UIVirtualList::getItemIndexAt);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getRowWidget", &UIVirtualList::getRowWidget);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getRowStyle", &UIVirtualList::getRowStyle);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getRowHeight", &UIVirtualList::getRowHeight);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getRowSpacing", &UIVirtualList::getRowSpacing);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getScrollOffset", &UIVirtualList::getScrollOffset);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getMaxScrollOffset", &UIVirtualList::getMaxScrollOffset);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getContentHeight", &UIVirtualList::getContentHeight);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getFirstVisibleIndex", &UIVirtualList::getFirstVisibleIndex);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getLastVisibleIndex", &UIVirtualList::getLastVisibleIndex);
+    g_lua.bindClassMemberFunction<UIVirtualList>("isAutoScroll", &UIVirtualList::isAutoScroll);
 #endif
 
 #ifdef FW_NET
@@ -760,6 +827,25 @@ void Application::registerLuaFunctions()
     // Connection
     g_lua.registerClass<Connection>();
     g_lua.bindClassMemberFunction<Connection>("getIp", &Connection::getIp);
+    g_lua.bindClassMemberFunction<Connection>("getOutputQueuedBytes", &Connection::getOutputQueuedBytes);
+    g_lua.bindClassMemberFunction<Connection>("getBytesSent", &Connection::getBytesSent);
+    g_lua.bindClassMemberFunction<Connection>("getFlushLatency", &Connection::getFlushLatency);
+    g_lua.bindClassMemberFunction<Connection>("getPeakFlushLatency", &Connection::getPeakFlushLatency);
+    g_lua.bindClassMemberFunction<Connection>("getTelemetryStats", &Connection::getTelemetryStats);
+    g_lua.bindClassMemberFunction<Connection>("getTelemetryJson", &Connection::getTelemetryJson);
+    g_lua.bindClassMemberFunction<Connection>("dumpTelemetry", &Connection::dumpTelemetry);
+    g_lua.bindClassMemberFunction<Connection>("resetTelemetry", &Connection::resetTelemetry);
+    g_lua.bindClassStaticFunction<Connection>("startNetworkThread", &Connection::startNetworkThread);
+    g_lua.bindClassStaticFunction<Connection>("stopNetworkThread", &Connection::stopNetworkThread);
+    g_lua.bindClassStaticFunction<Connection>("isNetworkThreadRunning", &Connection::isNetworkThreadRunning);
+    g_lua.bindClassStaticFunction<Connection>("setPollBudget", &Connection::setPollBudget);
+    g_lua.bindClassStaticFunction<Connection>("getPollBudget", &Connection::getPollBudget);
+    g_lua.bindClassStaticFunction<Connection>("getNetworkQueueSize", &Connection::getNetworkQueueSize);
+    g_lua.bindClassStaticFunction<Connection>("getNetworkQueuePeakSize", &Connection::getNetworkQueuePeakSize);
+    g_lua.bindClassStaticFunction<Connection>("getNetworkQueueLatency", &Connection::getNetworkQueueLatency);
+    g_lua.bindClassStaticFunction<Connection>("getNetworkQueuePeakLatency", &Connection::getNetworkQueuePeakLatency);
+    g_lua.bindClassStaticFunction<Connection>("resetNetworkQueueStats", &Connection::resetNetworkQueueStats);
+    g_lua.bindClassStaticFunction<Connection>("benchmarkPacketReads", &Connection::benchmarkPacketReads);
 
     // Protocol
     g_lua.registerClass<Protocol>();
@@ -785,6 +871,18 @@ void Application::registerLuaFunctions()
     g_lua.bindClassMemberFunction<ProtocolHttp>("disconnect", &ProtocolHttp::disconnect);
     g_lua.bindClassMemberFunction<ProtocolHttp>("send", &ProtocolHttp::send);
     g_lua.bindClassMemberFunction<ProtocolHttp>("recv", &ProtocolHttp::recv);
+    g_lua.bindClassStaticFunction<ProtocolHttp>("request", [](const std::string& method, const std::string& url, const ProtocolHttp::Headers& headers, const std::string& body, const std::string& outputFile) {
+        return ProtocolHttp::request(method, url, headers, body, outputFile, nullptr);
+    });
+    g_lua.bindClassStaticFunction<ProtocolHttp>("cancel", &ProtocolHttp::cancel);
+    g_lua.bindClassStaticFunction<ProtocolHttp>("cancelAll", &ProtocolHttp::cancelAll);
+    g_lua.bindClassStaticFunction<ProtocolHttp>("setMaxConnections", &ProtocolHttp::setMaxConnections);
+    g_lua.bindClassStaticFunction<ProtocolHttp>("getMaxConnections", &ProtocolHttp::getMaxConnections);
+    g_lua.bindClassStaticFunction<ProtocolHttp>("setMaxPipeline", &ProtocolHttp::setMaxPipeline);
+    g_lua.bindClassStaticFunction<ProtocolHttp>("getMaxPipeline", &ProtocolHttp::getMaxPipeline);
+    g_lua.bindClassStaticFunction<ProtocolHttp>("getPendingRequests", &ProtocolHttp::getPendingRequests);
+    g_lua.bindClassStaticFunction<ProtocolHttp>("getOpenConnections", &ProtocolHttp::getOpenConnections);
+    g_lua.bindClassStaticFunction<ProtocolHttp>("benchmarkRequests", &ProtocolHttp::benchmarkRequests);
 
     // InputMessage
     g_lua.registerClass<InputMessage>();
@@ -830,6 +928,7 @@ void Application::registerLuaFunctions()
     // SoundManager
     g_lua.registerSingletonClass("g_sounds");
     g_lua.bindSingletonFunction("g_sounds", "preload", &SoundManager::preload, &g_sounds);
+    g_lua.bindSingletonFunction("g_sounds", "preloadManifest", &SoundManager::preloadManifest, &g_sounds);
     g_lua.bindSingletonFunction("g_sounds", "play", &SoundManager::play, &g_sounds);
     g_lua.bindSingletonFunction("g_sounds", "getChannel", &SoundManager::getChannel, &g_sounds);
     g_lua.bindSingletonFunction("g_sounds", "stopAll", &SoundManager::stopAll, &g_sounds);
@@ -837,6 +936,20 @@ void Application::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_sounds", "disableAudio", &SoundManager::disableAudio, &g_sounds);
     g_lua.bindSingletonFunction("g_sounds", "setAudioEnabled", &SoundManager::setAudioEnabled, &g_sounds);
     g_lua.bindSingletonFunction("g_sounds", "isAudioEnabled", &SoundManager::isAudioEnabled, &g_sounds);
+    g_lua.bindSingletonFunction("g_sounds", "getStreamUnderruns", &SoundManager::getStreamUnderruns, &g_sounds);
+    g_lua.bindSingletonFunction("g_sounds", "getDecodedFragments", &SoundManager::getDecodedFragments, &g_sounds);
+    g_lua.bindSingletonFunction("g_sounds", "getDecodeTime", &SoundManager::getDecodeTime, &g_sounds);
+    g_lua.bindSingletonFunction("g_sounds", "getPeakDecodeTime", &SoundManager::getPeakDecodeTime, &g_sounds);
+    g_lua.bindSingletonFunction("g_sounds", "resetStreamStats", &SoundManager::resetStreamStats, &g_sounds);
+    g_lua.bindSingletonFunction("g_sounds", "setBufferCacheBudget", &SoundManager::setBufferCacheBudget, &g_sounds);
+    g_lua.bindSingletonFunction("g_sounds", "getBufferCacheBudget", &SoundManager::getBufferCacheBudget, &g_sounds);
+    g_lua.bindSingletonFunction("g_sounds", "getBufferCacheMemory", &SoundManager::getBufferCacheMemory, &g_sounds);
+    g_lua.bindSingletonFunction("g_sounds", "getBufferCacheCount", &SoundManager::getBufferCacheCount, &g_sounds);
+    g_lua.bindSingletonFunction("g_sounds", "getBufferCacheHits", &SoundManager::getBufferCacheHits, &g_sounds);
+    g_lua.bindSingletonFunction("g_sounds", "getBufferCacheMisses", &SoundManager::getBufferCacheMisses, &g_sounds);
+    g_lua.bindSingletonFunction("g_sounds", "getPendingPreloads", &SoundManager::getPendingPreloads, &g_sounds);
+    g_lua.bindSingletonFunction("g_sounds", "clearBufferCache", &SoundManager::clearBufferCache, &g_sounds);
+    g_lua.bindSingletonFunction("g_sounds", "resetBufferCacheStats", &SoundManager::resetBufferCacheStats, &g_sounds);
 
     g_lua.registerClass<SoundSource>();
     g_lua.registerClass<CombinedSoundSource, SoundSource>();
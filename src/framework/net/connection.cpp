@@ -21,15 +21,36 @@
  */
 
 #include "connection.h"
+#include "outputmessage.h"
 
 #include <framework/core/application.h>
 #include <framework/core/eventdispatcher.h>
+#include <framework/core/resourcemanager.h>
 
 #include <boost/asio.hpp>
 #include <memory>
+#include <ctime>
 
 asio::io_service g_ioService;
-std::list<std::shared_ptr<asio::streambuf>> Connection::m_outputStreams;
+
+std::atomic<bool> Connection::m_networkThreadRunning(false);
+std::thread Connection::m_networkThread;
+std::unique_ptr<asio::io_service::work> Connection::m_networkWork;
+std::unique_ptr<boost::lockfree::spsc_queue<Connection::NetworkEvent>> Connection::m_networkEvents;
+int Connection::m_connectionCount = 0;
+int Connection::m_pollBudget = Connection::NETWORK_POLL_BUDGET;
+std::atomic<int> Connection::m_networkQueuePeakSize(0);
+int Connection::m_networkQueueLatency = 0;
+int Connection::m_networkQueuePeakLatency = 0;
+
+// moves a reference into a main thread event, so the last release of lua objects never happens on the network thread
+template<typename T>
+static void releaseOnMainThread(T& object)
+{
+    auto holder = std::make_shared<T>();
+    std::swap(*holder, object);
+    Connection::postToMainThread([holder]() { *holder = T(); });
+}
 
 Connection::Connection() :
         m_readTimer(g_ioService),
@@ -40,6 +61,21 @@ Connection::Connection() :
 {
     m_connected = false;
     m_connecting = false;
+    m_generation = 0;
+    m_recvBegin = 0;
+    m_recvEnd = 0;
+    m_readingPackets = false;
+    m_outputRing.resize(OUTPUT_RING_SIZE);
+    m_outputHead = 0;
+    m_outputCount = 0;
+    m_outputWriting = 0;
+    m_writeScheduled = false;
+    m_outputQueuedBytes = 0;
+    m_bytesSent = 0;
+    m_flushLatency = 0;
+    m_peakFlushLatency = 0;
+    m_lastActivity = stdext::millis();
+    m_connectionCount++;
 }
 
 Connection::~Connection()
@@ -47,11 +83,31 @@ Connection::~Connection()
 #ifndef NDEBUG
     assert(!g_app.isTerminated());
 #endif
-    close();
+    // nothing else references this connection anymore, not even pending handlers, so it can be closed in place
+    internal_close();
+    m_connectionCount--;
 }
 
 void Connection::poll()
 {
+    if(m_networkThreadRunning) {
+        // the io service runs on the network thread, only deliver what it handed over within the frame budget
+        stdext::timer timer;
+        NetworkEvent event;
+        while(m_networkEvents->pop(event)) {
+            int latency = (int)(stdext::micros() - event.time);
+            m_networkQueueLatency = (m_networkQueueLatency * 15 + latency) / 16;
+            m_networkQueuePeakLatency = std::max<int>(m_networkQueuePeakLatency, latency);
+
+            event.callback();
+            event.callback = nullptr;
+
+            if(timer.elapsed_micros() >= m_pollBudget)
+                break;
+        }
+        return;
+    }
+
     // reset must always be called prior to poll
     g_ioService.reset();
     g_ioService.poll();
@@ -59,24 +115,151 @@ void Connection::poll()
 
 void Connection::terminate()
 {
+    if(m_networkThreadRunning) {
+        m_networkWork.reset();
+        g_ioService.stop();
+        m_networkThread.join();
+        m_networkThreadRunning = false;
+        m_networkEvents.reset();
+    }
+
+    g_ioService.stop();
+}
+
+bool Connection::startNetworkThread()
+{
+    if(m_networkThreadRunning)
+        return true;
+
+#ifndef THREAD_SAFE
+    g_logger.error("unable to start the network thread, the framework was not built thread safe");
+    return false;
+#else
+    if(m_connectionCount > 0) {
+        g_logger.error("unable to start the network thread while connections exist");
+        return false;
+    }
+
+    m_networkEvents.reset(new boost::lockfree::spsc_queue<NetworkEvent>(NETWORK_QUEUE_SIZE));
+    m_networkWork.reset(new asio::io_service::work(g_ioService));
+    m_networkThreadRunning = true;
+    resetNetworkQueueStats();
+
+    g_ioService.reset();
+    m_networkThread = std::thread([] { g_ioService.run(); });
+    return true;
+#endif
+}
+
+bool Connection::stopNetworkThread()
+{
+    if(!m_networkThreadRunning)
+        return true;
+
+    if(m_connectionCount > 0) {
+        g_logger.error("unable to stop the network thread while connections exist");
+        return false;
+    }
+
+    m_networkWork.reset();
     g_ioService.stop();
-    m_outputStreams.clear();
+    m_networkThread.join();
+    m_networkThreadRunning = false;
+
+    // events left behind only hold references, release them here
+    NetworkEvent event;
+    while(m_networkEvents->pop(event))
+        event.callback = nullptr;
+    m_networkEvents.reset();
+    return true;
+}
+
+void Connection::postToMainThread(const std::function<void()>& callback)
+{
+    NetworkEvent event;
+    event.callback = callback;
+    event.time = stdext::micros();
+
+    // the main loop drains the queue every frame, a full queue just means it is behind
+    while(!m_networkEvents->push(event)) {
+        if(g_ioService.stopped())
+            return;
+        std::this_thread::yield();
+    }
+
+    int size = NETWORK_QUEUE_SIZE - (int)m_networkEvents->write_available();
+    int peakSize = m_networkQueuePeakSize;
+    while(size > peakSize && !m_networkQueuePeakSize.compare_exchange_weak(peakSize, size));
+}
+
+int Connection::getNetworkQueueSize()
+{
+    if(!m_networkThreadRunning)
+        return 0;
+    return m_networkEvents->read_available();
+}
+
+void Connection::resetNetworkQueueStats()
+{
+    m_networkQueuePeakSize = 0;
+    m_networkQueueLatency = 0;
+    m_networkQueuePeakLatency = 0;
 }
 
 void Connection::close()
+{
+    if(!m_connected && !m_connecting)
+        return;
+
+    if(m_networkThreadRunning) {
+        // the socket belongs to the network thread, events it already handed over are dropped
+        m_generation++;
+        m_connectCallback = nullptr;
+        m_errorCallback = nullptr;
+        m_mainRecvCallback = nullptr;
+        postToNetworkThread([this]() { internal_close(); });
+        return;
+    }
+
+    internal_close();
+}
+
+void Connection::internal_close()
 {
     if(!m_connected && !m_connecting)
         return;
 
     // flush send data before disconnecting on clean connections
-    if(m_connected && !m_error && m_outputStream)
+    if(m_connected && !m_error && m_outputCount > m_outputWriting)
         internal_write();
 
     m_connecting = false;
     m_connected = false;
-    m_connectCallback = nullptr;
-    m_errorCallback = nullptr;
-    m_recvCallback = nullptr;
+    m_readingPackets = false;
+
+    if(m_networkThreadRunning) {
+        releaseOnMainThread(m_recvCallback);
+
+        // posted after the aborted handlers, once it runs the network thread holds no more references
+        auto holder = std::make_shared<ConnectionPtr>(asConnection());
+        uint generation = m_generation;
+        g_ioService.post([holder, generation]() {
+            postToMainThread([holder, generation]() {
+                ConnectionPtr connection = *holder;
+                holder->reset();
+                if(connection->m_generation == generation) {
+                    connection->m_connectCallback = nullptr;
+                    connection->m_errorCallback = nullptr;
+                    connection->m_mainRecvCallback = nullptr;
+                }
+                connection->m_self = nullptr;
+            });
+        });
+    } else {
+        m_connectCallback = nullptr;
+        m_errorCallback = nullptr;
+        m_recvCallback = nullptr;
+    }
 
     m_resolver.cancel();
     m_readTimer.cancel();
@@ -96,7 +279,21 @@ void Connection::connect(const std::string& host, uint16 port, const std::functi
     m_connecting = true;
     m_error.clear();
     m_connectCallback = connectCallback;
+    m_recvBegin = 0;
+    m_recvEnd = 0;
 
+    if(m_networkThreadRunning) {
+        // keep alive until the network thread is done with this connection
+        m_self = asConnection();
+        postToNetworkThread([this, host, port]() { internal_resolve(host, port); });
+        return;
+    }
+
+    internal_resolve(host, port);
+}
+
+void Connection::internal_resolve(const std::string& host, uint16 port)
+{
     asio::ip::tcp::resolver::query query(host, stdext::unsafe_cast<std::string>(port));
     m_resolver.async_resolve(query, std::bind(&Connection::onResolve, asConnection(), std::placeholders::_1, std::placeholders::_2));
 
@@ -119,35 +316,82 @@ void Connection::write(uint8* buffer, size_t size)
     if(!m_connected)
         return;
 
-    // we can't send the data right away, otherwise we could create tcp congestion
-    if(!m_outputStream) {
-        if(!m_outputStreams.empty()) {
-            m_outputStream = m_outputStreams.front();
-            m_outputStreams.pop_front();
-        } else
-            m_outputStream = std::make_shared<asio::streambuf>();
+    // raw data is split into messages, the only copy done on the output path
+    while(size > 0) {
+        size_t chunkSize = std::min<size_t>(size, OutputMessage::BUFFER_MAXSIZE - OutputMessage::MAX_HEADER_SIZE);
+        OutputMessagePtr outputMessage(new OutputMessage);
+        memcpy(outputMessage->getWriteBuffer(), buffer, chunkSize);
+        outputMessage->setWritePos(outputMessage->getWritePos() + chunkSize);
+        outputMessage->setMessageSize(chunkSize);
+        write(outputMessage);
+
+        buffer += chunkSize;
+        size -= chunkSize;
+    }
+}
+
+void Connection::write(const OutputMessagePtr& outputMessage)
+{
+    if(!m_connected)
+        return;
+
+    if(m_networkThreadRunning) {
+        auto holder = std::make_shared<OutputMessagePtr>(outputMessage);
+        postToNetworkThread([this, holder]() {
+            internal_queue_write(*holder);
+            releaseOnMainThread(*holder);
+        });
+        return;
+    }
+
+    internal_queue_write(outputMessage);
+}
+
+void Connection::internal_queue_write(const OutputMessagePtr& outputMessage)
+{
+    if(!m_connected)
+        return;
 
+    // grow the ring keeping the queued messages in order
+    if(m_outputCount == m_outputRing.size()) {
+        std::vector<OutputEntry> outputRing(m_outputRing.size() * 2);
+        for(size_t i = 0; i < m_outputCount; ++i)
+            std::swap(outputRing[i], m_outputRing[(m_outputHead + i) % m_outputRing.size()]);
+        m_outputRing.swap(outputRing);
+        m_outputHead = 0;
+    }
+
+    OutputEntry& entry = m_outputRing[(m_outputHead + m_outputCount) % m_outputRing.size()];
+    entry.message = outputMessage;
+    entry.time = stdext::micros();
+    m_outputCount++;
+    m_outputQueuedBytes += outputMessage->getMessageSize();
+
+    // we can't send the data right away, otherwise we could create tcp congestion
+    if(!m_writeScheduled && !m_outputWriting) {
+        m_writeScheduled = true;
         m_delayedWriteTimer.cancel();
         m_delayedWriteTimer.expires_from_now(boost::posix_time::milliseconds(0));
         m_delayedWriteTimer.async_wait(std::bind(&Connection::onCanWrite, asConnection(), std::placeholders::_1));
     }
-
-    std::ostream os(m_outputStream.get());
-    os.write((const char*)buffer, size);
-    os.flush();
 }
 
 void Connection::internal_write()
 {
-    if(!m_connected)
+    if(!m_connected || m_outputWriting)
         return;
 
-    std::shared_ptr<asio::streambuf> outputStream = m_outputStream;
-    m_outputStream = nullptr;
+    // every queued message goes out in a single gathered write, straight from its own buffer
+    m_outputBuffers.clear();
+    for(size_t i = 0; i < m_outputCount; ++i) {
+        const OutputMessagePtr& outputMessage = m_outputRing[(m_outputHead + i) % m_outputRing.size()].message;
+        m_outputBuffers.push_back(asio::buffer(outputMessage->getHeaderBuffer(), outputMessage->getMessageSize()));
+    }
+    m_outputWriting = m_outputCount;
 
     asio::async_write(m_socket,
-                      *outputStream,
-                      std::bind(&Connection::onWrite, asConnection(), std::placeholders::_1, std::placeholders::_2, outputStream));
+                      m_outputBuffers,
+                      std::bind(&Connection::onWrite, asConnection(), std::placeholders::_1, std::placeholders::_2));
 
     m_writeTimer.cancel();
     m_writeTimer.expires_from_now(boost::posix_time::seconds(static_cast<uint32>(WRITE_TIMEOUT)));
@@ -159,6 +403,94 @@ void Connection::read(uint16 bytes, const RecvCallback& callback)
     if(!m_connected)
         return;
 
+    if(m_networkThreadRunning) {
+        m_mainRecvCallback = callback;
+        RecvCallback callback = mainThreadRecvCallback();
+        postToNetworkThread([this, bytes, callback]() { internal_read(bytes, callback); });
+        return;
+    }
+
+    internal_read(bytes, callback);
+}
+
+void Connection::read_until(const std::string& what, const RecvCallback& callback)
+{
+    if(!m_connected)
+        return;
+
+    if(m_networkThreadRunning) {
+        m_mainRecvCallback = callback;
+        RecvCallback callback = mainThreadRecvCallback();
+        postToNetworkThread([this, what, callback]() { internal_read_until(what, callback); });
+        return;
+    }
+
+    internal_read_until(what, callback);
+}
+
+void Connection::read_some(const RecvCallback& callback)
+{
+    if(!m_connected)
+        return;
+
+    if(m_networkThreadRunning) {
+        m_mainRecvCallback = callback;
+        RecvCallback callback = mainThreadRecvCallback();
+        postToNetworkThread([this, callback]() { internal_read_some(callback); });
+        return;
+    }
+
+    internal_read_some(callback);
+}
+
+void Connection::read_packets(const RecvCallback& callback)
+{
+    if(!m_connected)
+        return;
+
+    if(m_networkThreadRunning) {
+        m_mainRecvCallback = callback;
+        RecvCallback recvCallback = mainThreadRecvCallback();
+        postToNetworkThread([this, recvCallback]() { internal_read_packets(recvCallback); });
+        return;
+    }
+
+    internal_read_packets(callback);
+}
+
+void Connection::postToNetworkThread(const std::function<void()>& callback)
+{
+    // the reference taken here is released by the main thread, callbacks may capture this directly
+    ConnectionPtr self = asConnection();
+    g_ioService.post([self, callback]() mutable {
+        callback();
+        releaseOnMainThread(self);
+    });
+}
+
+Connection::RecvCallback Connection::mainThreadRecvCallback()
+{
+    // the data is copied because the input stream is consumed as soon as the callback returns
+    uint generation = m_generation;
+    return [this, generation](uint8* buffer, uint16 size) {
+        auto data = std::make_shared<std::vector<uint8>>(buffer, buffer + size);
+        postToMainThread([this, generation, data]() {
+            if(m_generation == generation && m_mainRecvCallback)
+                m_mainRecvCallback(data->data(), data->size());
+        });
+    };
+}
+
+void Connection::internal_read(uint16 bytes, const RecvCallback& callback)
+{
+    if(!m_connected) {
+        if(m_networkThreadRunning) {
+            RecvCallback unused = callback;
+            releaseOnMainThread(unused);
+        }
+        return;
+    }
+
     m_recvCallback = callback;
 
     asio::async_read(m_socket,
@@ -170,7 +502,7 @@ void Connection::read(uint16 bytes, const RecvCallback& callback)
     m_readTimer.async_wait(std::bind(&Connection::onTimeout, asConnection(), std::placeholders::_1));
 }
 
-void Connection::read_until(const std::string& what, const RecvCallback& callback)
+void Connection::internal_read_until(const std::string& what, const RecvCallback& callback)
 {
     if(!m_connected)
         return;
@@ -187,14 +519,15 @@ void Connection::read_until(const std::string& what, const RecvCallback& callbac
     m_readTimer.async_wait(std::bind(&Connection::onTimeout, asConnection(), std::placeholders::_1));
 }
 
-void Connection::read_some(const RecvCallback& callback)
+void Connection::internal_read_some(const RecvCallback& callback)
 {
     if(!m_connected)
         return;
 
     m_recvCallback = callback;
 
-    m_socket.async_read_some(asio::buffer(m_inputStream.prepare(RECV_BUFFER_SIZE)),
+    // the callback size is 16 bits, a full 64k read would wrap to zero
+    m_socket.async_read_some(asio::buffer(m_inputStream.prepare(RECV_BUFFER_SIZE - 1)),
                              std::bind(&Connection::onRecv, asConnection(), std::placeholders::_1, std::placeholders::_2));
 
     m_readTimer.cancel();
@@ -202,6 +535,49 @@ void Connection::read_some(const RecvCallback& callback)
     m_readTimer.async_wait(std::bind(&Connection::onTimeout, asConnection(), std::placeholders::_1));
 }
 
+void Connection::internal_read_packets(const RecvCallback& callback)
+{
+    if(!m_connected) {
+        if(m_networkThreadRunning) {
+            RecvCallback unused = callback;
+            releaseOnMainThread(unused);
+        }
+        return;
+    }
+
+    // an ongoing read keeps going, it just delivers to the new callback
+    m_recvCallback = callback;
+    if(m_readingPackets)
+        return;
+    m_readingPackets = true;
+
+    if(m_recvBuffer.empty())
+        m_recvBuffer.resize(RECV_BUFFER_SIZE * 2);
+
+    // a single timer watches for inactivity instead of one being armed for every read
+    m_readTimer.cancel();
+    m_readTimer.expires_from_now(boost::posix_time::seconds(static_cast<uint32>(READ_TIMEOUT)));
+    m_readTimer.async_wait(std::bind(&Connection::onReadWatchdog, asConnection(), std::placeholders::_1));
+
+    internal_read_more();
+}
+
+void Connection::internal_read_more()
+{
+    // keep room for at least a whole message after the bytes still pending
+    if(m_recvBegin == m_recvEnd) {
+        m_recvBegin = 0;
+        m_recvEnd = 0;
+    } else if(m_recvBuffer.size() - m_recvEnd < RECV_BUFFER_SIZE) {
+        memmove(&m_recvBuffer[0], &m_recvBuffer[m_recvBegin], m_recvEnd - m_recvBegin);
+        m_recvEnd -= m_recvBegin;
+        m_recvBegin = 0;
+    }
+
+    m_socket.async_read_some(asio::buffer(&m_recvBuffer[m_recvEnd], m_recvBuffer.size() - m_recvEnd),
+                             std::bind(&Connection::onRecvPackets, asConnection(), std::placeholders::_1, std::placeholders::_2));
+}
+
 void Connection::onResolve(const boost::system::error_code& error, asio::ip::basic_resolver<asio::ip::tcp>::iterator endpointIterator)
 {
     m_readTimer.cancel();
@@ -218,7 +594,7 @@ void Connection::onResolve(const boost::system::error_code& error, asio::ip::bas
 void Connection::onConnect(const boost::system::error_code& error)
 {
     m_readTimer.cancel();
-    m_activityTimer.restart();
+    m_lastActivity = stdext::millis();
 
     if(error == asio::error::operation_aborted)
         return;
@@ -230,7 +606,13 @@ void Connection::onConnect(const boost::system::error_code& error)
         boost::asio::ip::tcp::no_delay option(true);
         m_socket.set_option(option);
 
-        if(m_connectCallback)
+        if(m_networkThreadRunning) {
+            uint generation = m_generation;
+            postToMainThread([this, generation]() {
+                if(m_generation == generation && m_connectCallback)
+                    m_connectCallback();
+            });
+        } else if(m_connectCallback)
             m_connectCallback();
     } else
         handleError(error);
@@ -241,6 +623,7 @@ void Connection::onConnect(const boost::system::error_code& error)
 void Connection::onCanWrite(const boost::system::error_code& error)
 {
     m_delayedWriteTimer.cancel();
+    m_writeScheduled = false;
 
     if(error == asio::error::operation_aborted)
         return;
@@ -249,31 +632,58 @@ void Connection::onCanWrite(const boost::system::error_code& error)
         internal_write();
 }
 
-void Connection::onWrite(const boost::system::error_code& error, size_t writeSize, std::shared_ptr<asio::streambuf> outputStream)
+void Connection::onWrite(const boost::system::error_code& error, size_t writeSize)
 {
     m_writeTimer.cancel();
 
+    // give back the written messages even when aborted, asio is done with their buffers
+    // on the network thread they are released by the main thread
+    ticks_t now = stdext::micros();
+    std::shared_ptr<std::vector<OutputMessagePtr>> written;
+    if(m_networkThreadRunning)
+        written = std::make_shared<std::vector<OutputMessagePtr>>(m_outputWriting);
+    for(size_t i = 0; i < m_outputWriting; ++i) {
+        OutputEntry& entry = m_outputRing[m_outputHead];
+        int latency = (int)(now - entry.time);
+        m_flushLatency = (m_flushLatency * 15 + latency) / 16;
+        if(latency > m_peakFlushLatency)
+            m_peakFlushLatency = latency;
+        m_outputQueuedBytes -= entry.message->getMessageSize();
+        m_telemetry.recordMessageOut(entry.message->getMessageSize());
+
+        if(written)
+            (*written)[i].swap(entry.message);
+        else
+            entry.message = nullptr;
+        m_outputHead = (m_outputHead + 1) % m_outputRing.size();
+    }
+    m_outputCount -= m_outputWriting;
+    m_outputWriting = 0;
+    m_bytesSent = m_bytesSent + writeSize;
+    m_telemetry.recordWrite(writeSize);
+    if(written)
+        postToMainThread([written]() { written->clear(); });
+
     if(error == asio::error::operation_aborted)
         return;
 
-    // free output stream and store for using it again later
-    outputStream->consume(outputStream->size());
-    m_outputStreams.push_back(outputStream);
-
     if(m_connected && error)
         handleError(error);
+    else if(m_connected && m_outputCount > 0)
+        internal_write();
 }
 
 void Connection::onRecv(const boost::system::error_code& error, size_t recvSize)
 {
     m_readTimer.cancel();
-    m_activityTimer.restart();
+    m_lastActivity = stdext::millis();
 
     if(error == asio::error::operation_aborted)
         return;
 
     if(m_connected) {
         if(!error) {
+            m_telemetry.recordRead(recvSize);
             if(m_recvCallback) {
                 const char* header = boost::asio::buffer_cast<const char*>(m_inputStream.data());
                 m_recvCallback((uint8*)header, recvSize);
@@ -286,6 +696,60 @@ void Connection::onRecv(const boost::system::error_code& error, size_t recvSize)
         m_inputStream.consume(recvSize);
 }
 
+void Connection::onRecvPackets(const boost::system::error_code& error, size_t recvSize)
+{
+    m_lastActivity = stdext::millis();
+
+    if(error == asio::error::operation_aborted || !m_connected || !m_readingPackets)
+        return;
+
+    if(error) {
+        handleError(error);
+        return;
+    }
+
+    m_recvEnd += recvSize;
+    m_telemetry.recordRead(recvSize);
+
+    // deliver every complete message at once, each one still prefixed by its 16 bit size
+    RecvCallback callback = m_recvCallback;
+    while(m_recvEnd - m_recvBegin >= 2) {
+        size_t messageSize = stdext::readULE16(&m_recvBuffer[m_recvBegin]) + 2;
+        if(messageSize > 0xFFFF) {
+            handleError(asio::error::message_size);
+            return;
+        }
+        if(m_recvEnd - m_recvBegin < messageSize)
+            break;
+
+        uint8* message = &m_recvBuffer[m_recvBegin];
+        m_recvBegin += messageSize;
+        m_telemetry.recordMessageIn(messageSize);
+        if(callback)
+            callback(message, messageSize);
+
+        if(!m_connected || !m_readingPackets)
+            return;
+    }
+
+    internal_read_more();
+}
+
+void Connection::onReadWatchdog(const boost::system::error_code& error)
+{
+    if(error == asio::error::operation_aborted || !m_connected || !m_readingPackets)
+        return;
+
+    ticks_t idleTime = stdext::millis() - m_lastActivity;
+    if(idleTime >= READ_TIMEOUT * 1000) {
+        handleError(asio::error::timed_out);
+        return;
+    }
+
+    m_readTimer.expires_from_now(boost::posix_time::milliseconds(READ_TIMEOUT * 1000 - idleTime));
+    m_readTimer.async_wait(std::bind(&Connection::onReadWatchdog, asConnection(), std::placeholders::_1));
+}
+
 void Connection::onTimeout(const boost::system::error_code& error)
 {
     if(error == asio::error::operation_aborted)
@@ -300,12 +764,97 @@ void Connection::handleError(const boost::system::error_code& error)
         return;
 
     m_error = error;
+    if(m_networkThreadRunning) {
+        uint generation = m_generation;
+        postToMainThread([this, generation, error]() {
+            if(m_generation == generation && m_errorCallback)
+                m_errorCallback(error);
+        });
+        if(m_connected || m_connecting)
+            internal_close();
+        return;
+    }
+
     if(m_errorCallback)
         m_errorCallback(error);
     if(m_connected || m_connecting)
         close();
 }
 
+std::map<std::string, double> Connection::benchmarkPacketReads(int messages, int messageSize)
+{
+    std::map<std::string, double> result;
+    messages = std::max<int>(messages, 1);
+    messageSize = stdext::clamp<int>(messageSize, 1, 0xFFFF - 2);
+
+    // loopback stand-in for a game server, it floods the framed messages as fast as the socket takes them
+    struct StandInServer {
+        StandInServer() : acceptor(g_ioService), socket(g_ioService) { }
+        asio::ip::tcp::acceptor acceptor;
+        asio::ip::tcp::socket socket;
+        std::vector<uint8> data;
+    };
+    auto server = std::make_shared<StandInServer>();
+
+    boost::system::error_code ec;
+    asio::ip::tcp::endpoint endpoint(asio::ip::address_v4::loopback(), 0);
+    server->acceptor.open(endpoint.protocol(), ec);
+    if(!ec)
+        server->acceptor.bind(endpoint, ec);
+    if(!ec)
+        server->acceptor.listen(asio::socket_base::max_connections, ec);
+    if(ec) {
+        g_logger.error(stdext::format("unable to start the benchmark server: %s", ec.message()));
+        return result;
+    }
+
+    server->data.resize(messages * (messageSize + 2));
+    for(int i = 0; i < messages; ++i) {
+        uint8* message = &server->data[i * (messageSize + 2)];
+        stdext::writeULE16(message, messageSize);
+        memset(message + 2, i & 0xFF, messageSize);
+    }
+
+    server->acceptor.async_accept(server->socket, [server](const boost::system::error_code& error) {
+        if(!error)
+            asio::async_write(server->socket, asio::buffer(server->data), [server](const boost::system::error_code&, size_t) { });
+    });
+
+    int received = 0;
+    ConnectionPtr connection(new Connection);
+    connection->connect("127.0.0.1", server->acceptor.local_endpoint().port(), [&]() {
+        connection->read_packets([&](uint8*, uint16) { received++; });
+    });
+
+    stdext::timer timer;
+    std::clock_t cpuStart = std::clock();
+    while(received < messages && !connection->getError() && timer.elapsed_seconds() < 30) {
+        poll();
+        if(m_networkThreadRunning)
+            std::this_thread::yield();
+    }
+    double seconds = timer.elapsed_seconds();
+    double cpuSeconds = (std::clock() - cpuStart) / (double)CLOCKS_PER_SEC;
+
+    connection->close();
+    g_ioService.post([server]() {
+        boost::system::error_code ec;
+        server->socket.close(ec);
+        server->acceptor.close(ec);
+    });
+    if(!m_networkThreadRunning)
+        poll();
+
+    if(received < messages)
+        g_logger.warning(stdext::format("benchmark received only %d of %d messages", received, messages));
+
+    result["messages"] = received;
+    result["seconds"] = seconds;
+    result["messagesPerSecond"] = received / std::max<double>(seconds, 1e-6);
+    result["cpuMicrosPerMessage"] = cpuSeconds * 1000000.0 / std::max<int>(received, 1);
+    return result;
+}
+
 int Connection::getIp()
 {
     boost::system::error_code error;
@@ -316,3 +865,8 @@ int Connection::getIp()
     g_logger.error("Getting remote ip");
     return 0;
 }
+
+bool Connection::dumpTelemetry(const std::string& fileName)
+{
+    return g_resources.writeFileContents(fileName, m_telemetry.toJson());
+}
@@ -24,10 +24,15 @@
 #define CONNECTION_H
 
 #include "declarations.h"
+#include "connectiontelemetry.h"
 #include <framework/luaengine/luaobject.h>
 #include <framework/core/timer.h>
 #include <framework/core/declarations.h>
 
+#include <atomic>
+#include <thread>
+#include <boost/lockfree/spsc_queue.hpp>
+
 class Connection : public LuaObject
 {
     typedef std::function<void(const boost::system::error_code&)> ErrorCallback;
@@ -37,7 +42,20 @@ class Connection : public LuaObject
         READ_TIMEOUT = 30,
         WRITE_TIMEOUT = 30,
         SEND_BUFFER_SIZE = 65536,
-        RECV_BUFFER_SIZE = 65536
+        RECV_BUFFER_SIZE = 65536,
+        OUTPUT_RING_SIZE = 64,
+        NETWORK_QUEUE_SIZE = 4096,
+        NETWORK_POLL_BUDGET = 4000
+    };
+
+    struct OutputEntry {
+        OutputMessagePtr message;
+        ticks_t time;
+    };
+
+    struct NetworkEvent {
+        std::function<void()> callback;
+        ticks_t time;
     };
 
 public:
@@ -47,13 +65,30 @@ public:
     static void poll();
     static void terminate();
 
+    static bool startNetworkThread();
+    static bool stopNetworkThread();
+    static bool isNetworkThreadRunning() { return m_networkThreadRunning; }
+    static void postToMainThread(const std::function<void()>& callback);
+
+    static void setPollBudget(int micros) { m_pollBudget = std::max<int>(micros, 0); }
+    static int getPollBudget() { return m_pollBudget; }
+    static int getNetworkQueueSize();
+    static int getNetworkQueuePeakSize() { return m_networkQueuePeakSize; }
+    static int getNetworkQueueLatency() { return m_networkQueueLatency; }
+    static int getNetworkQueuePeakLatency() { return m_networkQueuePeakLatency; }
+    static void resetNetworkQueueStats();
+
+    static std::map<std::string, double> benchmarkPacketReads(int messages, int messageSize);
+
     void connect(const std::string& host, uint16 port, const std::function<void()>& connectCallback);
     void close();
 
     void write(uint8* buffer, size_t size);
+    void write(const OutputMessagePtr& outputMessage);
     void read(uint16 bytes, const RecvCallback& callback);
     void read_until(const std::string& what, const RecvCallback& callback);
     void read_some(const RecvCallback& callback);
+    void read_packets(const RecvCallback& callback);
 
     void setErrorCallback(const ErrorCallback& errorCallback) { m_errorCallback = errorCallback; }
 
@@ -61,24 +96,47 @@ public:
     boost::system::error_code getError() { return m_error; }
     bool isConnecting() { return m_connecting; }
     bool isConnected() { return m_connected; }
-    ticks_t getElapsedTicksSinceLastRead() { return m_connected ? m_activityTimer.elapsed_millis() : -1; }
+    ticks_t getElapsedTicksSinceLastRead() { return m_connected ? stdext::millis() - m_lastActivity : -1; }
+    int getOutputQueuedBytes() { return m_outputQueuedBytes; }
+    double getBytesSent() { return m_bytesSent; }
+    int getFlushLatency() { return m_flushLatency; }
+    int getPeakFlushLatency() { return m_peakFlushLatency; }
+
+    ConnectionTelemetry& getTelemetry() { return m_telemetry; }
+    std::map<std::string, double> getTelemetryStats() { return m_telemetry.getStats(); }
+    std::string getTelemetryJson() { return m_telemetry.toJson(); }
+    bool dumpTelemetry(const std::string& fileName);
+    void resetTelemetry() { m_telemetry.reset(); }
 
     ConnectionPtr asConnection() { return static_self_cast<Connection>(); }
 
 protected:
+    void internal_resolve(const std::string& host, uint16 port);
+    void internal_close();
+    void internal_read(uint16 bytes, const RecvCallback& callback);
+    void internal_read_until(const std::string& what, const RecvCallback& callback);
+    void internal_read_some(const RecvCallback& callback);
+    void internal_read_packets(const RecvCallback& callback);
+    void internal_read_more();
+    void internal_queue_write(const OutputMessagePtr& outputMessage);
     void internal_connect(asio::ip::basic_resolver<asio::ip::tcp>::iterator endpointIterator);
     void internal_write();
     void onResolve(const boost::system::error_code& error, asio::ip::tcp::resolver::iterator endpointIterator);
     void onConnect(const boost::system::error_code& error);
     void onCanWrite(const boost::system::error_code& error);
-    void onWrite(const boost::system::error_code& error, size_t writeSize, std::shared_ptr<asio::streambuf> outputStream);
+    void onWrite(const boost::system::error_code& error, size_t writeSize);
     void onRecv(const boost::system::error_code& error, size_t recvSize);
+    void onRecvPackets(const boost::system::error_code& error, size_t recvSize);
+    void onReadWatchdog(const boost::system::error_code& error);
     void onTimeout(const boost::system::error_code& error);
     void handleError(const boost::system::error_code& error);
+    void postToNetworkThread(const std::function<void()>& callback);
+    RecvCallback mainThreadRecvCallback();
 
     std::function<void()> m_connectCallback;
     ErrorCallback m_errorCallback;
     RecvCallback m_recvCallback;
+    RecvCallback m_mainRecvCallback;
 
     asio::deadline_timer m_readTimer;
     asio::deadline_timer m_writeTimer;
@@ -86,15 +144,41 @@ protected:
     asio::ip::tcp::resolver m_resolver;
     asio::ip::tcp::socket m_socket;
 
-    static std::list<std::shared_ptr<asio::streambuf>> m_outputStreams;
-    std::shared_ptr<asio::streambuf> m_outputStream;
+    std::vector<OutputEntry> m_outputRing;
+    std::vector<asio::const_buffer> m_outputBuffers;
+    size_t m_outputHead;
+    size_t m_outputCount;
+    size_t m_outputWriting;
+    bool m_writeScheduled;
+    std::atomic<int> m_outputQueuedBytes;
+    std::atomic<double> m_bytesSent;
+    std::atomic<int> m_flushLatency;
+    std::atomic<int> m_peakFlushLatency;
     asio::streambuf m_inputStream;
-    bool m_connected;
-    bool m_connecting;
+    std::vector<uint8> m_recvBuffer;
+    size_t m_recvBegin;
+    size_t m_recvEnd;
+    bool m_readingPackets;
+    std::atomic<bool> m_connected;
+    std::atomic<bool> m_connecting;
+    std::atomic<uint> m_generation;
+    ConnectionPtr m_self;
     boost::system::error_code m_error;
-    stdext::timer m_activityTimer;
+    std::atomic<ticks_t> m_lastActivity; // written by the network thread, read by the game
+    ConnectionTelemetry m_telemetry;
+
+    static std::atomic<bool> m_networkThreadRunning;
+    static std::thread m_networkThread;
+    static std::unique_ptr<asio::io_service::work> m_networkWork;
+    static std::unique_ptr<boost::lockfree::spsc_queue<NetworkEvent>> m_networkEvents;
+    static int m_connectionCount;
+    static int m_pollBudget;
+    static std::atomic<int> m_networkQueuePeakSize;
+    static int m_networkQueueLatency;
+    static int m_networkQueuePeakLatency;
 
     friend class Server;
+    friend class Protocol;
 };
 
 #endif
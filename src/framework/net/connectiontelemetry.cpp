@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "connectiontelemetry.h"
+
+ConnectionTelemetry::ConnectionTelemetry()
+{
+    reset();
+}
+
+void ConnectionTelemetry::recordMessageIn(size_t size)
+{
+    m_messagesIn++;
+    m_sizesIn[sizeBucket(size)]++;
+}
+
+void ConnectionTelemetry::recordMessageOut(size_t size)
+{
+    m_messagesOut++;
+    m_sizesOut[sizeBucket(size)]++;
+}
+
+void ConnectionTelemetry::recordParse(uint8 opcode, int micros)
+{
+    OpcodeStats& stats = m_opcodes[opcode];
+    stats.count++;
+    stats.totalTime += micros;
+    if(micros > stats.maxTime)
+        stats.maxTime = micros;
+}
+
+void ConnectionTelemetry::reset()
+{
+    m_bytesIn = 0;
+    m_bytesOut = 0;
+    m_messagesIn = 0;
+    m_messagesOut = 0;
+    for(int i = 0; i < SIZE_BUCKETS; ++i) {
+        m_sizesIn[i] = 0;
+        m_sizesOut[i] = 0;
+    }
+    for(OpcodeStats& stats : m_opcodes) {
+        stats.count = 0;
+        stats.totalTime = 0;
+        stats.maxTime = 0;
+    }
+    m_decryptTime.clear();
+    m_parseTime.clear();
+    m_roundTrip.clear();
+    m_startTime = stdext::millis();
+}
+
+std::map<std::string, double> ConnectionTelemetry::getStats()
+{
+    std::map<std::string, double> stats;
+    double seconds = std::max<double>((stdext::millis() - m_startTime) / 1000.0, 0.001);
+    stats["seconds"] = seconds;
+    stats["bytesIn"] = m_bytesIn;
+    stats["bytesOut"] = m_bytesOut;
+    stats["messagesIn"] = m_messagesIn;
+    stats["messagesOut"] = m_messagesOut;
+    stats["bytesInPerSecond"] = m_bytesIn / seconds;
+    stats["bytesOutPerSecond"] = m_bytesOut / seconds;
+    addRingStats(stats, "decrypt", m_decryptTime);
+    addRingStats(stats, "parse", m_parseTime);
+    addRingStats(stats, "roundTrip", m_roundTrip);
+    return stats;
+}
+
+std::string ConnectionTelemetry::toJson()
+{
+    std::stringstream ss;
+    ss << "{";
+    ss << "\"seconds\":" << (stdext::millis() - m_startTime) / 1000.0;
+    ss << ",\"bytesIn\":" << m_bytesIn << ",\"bytesOut\":" << m_bytesOut;
+    ss << ",\"messagesIn\":" << m_messagesIn << ",\"messagesOut\":" << m_messagesOut;
+
+    // histograms are keyed by the bucket upper bound in bytes
+    for(int direction = 0; direction < 2; ++direction) {
+        std::array<std::atomic<uint>, SIZE_BUCKETS>& sizes = direction == 0 ? m_sizesIn : m_sizesOut;
+        ss << (direction == 0 ? ",\"messageSizesIn\":{" : ",\"messageSizesOut\":{");
+        bool first = true;
+        for(int i = 0; i < SIZE_BUCKETS; ++i) {
+            uint count = sizes[i];
+            if(count == 0)
+                continue;
+            ss << (first ? "" : ",") << "\"" << (1 << i) << "\":" << count;
+            first = false;
+        }
+        ss << "}";
+    }
+
+    ss << ",\"decrypt\":" << ringJson(m_decryptTime);
+    ss << ",\"parse\":" << ringJson(m_parseTime);
+    ss << ",\"roundTrip\":" << ringJson(m_roundTrip);
+
+    ss << ",\"opcodes\":{";
+    bool first = true;
+    for(int i = 0; i < OPCODES; ++i) {
+        OpcodeStats& stats = m_opcodes[i];
+        uint count = stats.count;
+        if(count == 0)
+            continue;
+        ss << (first ? "" : ",") << "\"" << i << "\":{\"count\":" << count << ",\"totalTime\":" << stats.totalTime
+           << ",\"meanTime\":" << stats.totalTime / (double)count << ",\"maxTime\":" << stats.maxTime << "}";
+        first = false;
+    }
+    ss << "}}";
+    return ss.str();
+}
+
+int ConnectionTelemetry::sizeBucket(size_t size)
+{
+    int bucket = 0;
+    while(bucket < SIZE_BUCKETS - 1 && ((size_t)1 << bucket) < size)
+        bucket++;
+    return bucket;
+}
+
+std::string ConnectionTelemetry::ringJson(SampleRing& ring)
+{
+    std::map<std::string, double> stats;
+    addRingStats(stats, "", ring);
+    std::stringstream ss;
+    ss << "{";
+    bool first = true;
+    for(auto& it : stats) {
+        std::string key = it.first;
+        key[0] = std::tolower(key[0]);
+        ss << (first ? "" : ",") << "\"" << key << "\":" << it.second;
+        first = false;
+    }
+    ss << "}";
+    return ss.str();
+}
+
+void ConnectionTelemetry::addRingStats(std::map<std::string, double>& stats, const std::string& name, SampleRing& ring)
+{
+    std::vector<int> samples = ring.snapshot();
+    stats[name + "Samples"] = samples.size();
+    if(samples.empty())
+        return;
+
+    std::sort(samples.begin(), samples.end());
+    double total = 0;
+    for(int sample : samples)
+        total += sample;
+    stats[name + "Mean"] = total / samples.size();
+    stats[name + "P50"] = samples[samples.size() / 2];
+    stats[name + "P95"] = samples[samples.size() * 95 / 100];
+    stats[name + "P99"] = samples[samples.size() * 99 / 100];
+    stats[name + "Max"] = samples.back();
+}
+
+void ConnectionTelemetry::SampleRing::clear()
+{
+    for(std::atomic<int>& sample : m_samples)
+        sample = 0;
+    m_head = 0;
+}
+
+std::vector<int> ConnectionTelemetry::SampleRing::snapshot()
+{
+    uint head = m_head.load(std::memory_order_relaxed);
+    uint count = std::min<uint>(head, SAMPLE_RING_SIZE);
+    std::vector<int> samples(count);
+    for(uint i = 0; i < count; ++i)
+        samples[i] = m_samples[(head - count + i) % SAMPLE_RING_SIZE].load(std::memory_order_relaxed);
+    return samples;
+}
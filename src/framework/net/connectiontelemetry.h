@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONNECTIONTELEMETRY_H
+#define CONNECTIONTELEMETRY_H
+
+#include "declarations.h"
+#include <atomic>
+
+// counters written from whichever thread owns the socket and read from the main thread,
+// every field is atomic so neither side ever waits for the other
+class ConnectionTelemetry
+{
+public:
+    enum {
+        SAMPLE_RING_SIZE = 256,
+        SIZE_BUCKETS = 17, // message sizes by power of two, up to 64k
+        OPCODES = 256
+    };
+
+    ConnectionTelemetry();
+
+    void recordRead(size_t bytes) { m_bytesIn += bytes; }
+    void recordWrite(size_t bytes) { m_bytesOut += bytes; }
+    void recordMessageIn(size_t size);
+    void recordMessageOut(size_t size);
+    void recordDecrypt(int micros) { m_decryptTime.push(micros); }
+    void recordParse(uint8 opcode, int micros);
+    void recordMessageParse(int micros) { m_parseTime.push(micros); }
+    void recordRoundTrip(int millis) { m_roundTrip.push(millis); }
+    void reset();
+
+    std::map<std::string, double> getStats();
+    std::string toJson();
+
+private:
+    // fixed size ring of the latest samples, older ones are overwritten
+    class SampleRing {
+    public:
+        SampleRing() { clear(); }
+        void push(int value) { m_samples[m_head.fetch_add(1, std::memory_order_relaxed) % SAMPLE_RING_SIZE].store(value, std::memory_order_relaxed); }
+        void clear();
+        std::vector<int> snapshot();
+    private:
+        std::array<std::atomic<int>, SAMPLE_RING_SIZE> m_samples;
+        std::atomic<uint> m_head;
+    };
+
+    struct OpcodeStats {
+        std::atomic<uint> count;
+        std::atomic<uint64> totalTime;
+        std::atomic<int> maxTime;
+    };
+
+    static int sizeBucket(size_t size);
+    static std::string ringJson(SampleRing& ring);
+    static void addRingStats(std::map<std::string, double>& stats, const std::string& name, SampleRing& ring);
+
+    std::atomic<uint64> m_bytesIn;
+    std::atomic<uint64> m_bytesOut;
+    std::atomic<uint> m_messagesIn;
+    std::atomic<uint> m_messagesOut;
+    std::array<std::atomic<uint>, SIZE_BUCKETS> m_sizesIn;
+    std::array<std::atomic<uint>, SIZE_BUCKETS> m_sizesOut;
+    std::array<OpcodeStats, OPCODES> m_opcodes;
+    SampleRing m_decryptTime;
+    SampleRing m_parseTime;
+    SampleRing m_roundTrip;
+    std::atomic<ticks_t> m_startTime;
+};
+
+#endif
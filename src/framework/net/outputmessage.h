@@ -52,6 +52,8 @@ public:
 
     void encryptRsa();
 
+    uint8 peekU8() { return m_messageSize > 0 ? m_buffer[m_headerPos] : 0; }
+
     uint16 getWritePos() { return m_writePos; }
     uint16 getMessageSize() { return m_messageSize; }
 
@@ -67,6 +69,7 @@ protected:
     void writeMessageSize();
 
     friend class Protocol;
+    friend class Connection;
 
 private:
     bool canWrite(int bytes);
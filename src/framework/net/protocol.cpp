@@ -23,12 +23,14 @@
 #include "protocol.h"
 #include "connection.h"
 #include <framework/core/application.h>
+#include <framework/util/crypt.h>
 #include <random>
 
 Protocol::Protocol()
 {
     m_xteaEncryptionEnabled = false;
     m_checksumEnabled = false;
+    m_recvStreaming = false;
     m_inputMessage = InputMessagePtr(new InputMessage);
 }
 
@@ -42,6 +44,7 @@ Protocol::~Protocol()
 
 void Protocol::connect(const std::string& host, uint16 port)
 {
+    m_recvStreaming = false;
     m_connection = ConnectionPtr(new Connection);
     m_connection->setErrorCallback(std::bind(&Protocol::onError, asProtocol(), std::placeholders::_1));
     m_connection->connect(host, port, std::bind(&Protocol::onConnect, asProtocol()));
@@ -53,6 +56,7 @@ void Protocol::disconnect()
         m_connection->close();
         m_connection.reset();
     }
+    m_recvStreaming = false;
 }
 
 bool Protocol::isConnected()
@@ -82,15 +86,33 @@ void Protocol::send(const OutputMessagePtr& outputMessage)
     // write message size
     outputMessage->writeMessageSize();
 
-    // send
+    // send, the connection keeps the message until it is written so it must not be reused
     if(m_connection)
-        m_connection->write(outputMessage->getHeaderBuffer(), outputMessage->getMessageSize());
-
-    // reset message to allow reuse
-    outputMessage->reset();
+        m_connection->write(outputMessage);
 }
 
 void Protocol::recv()
+{
+    // messages keep being read in batches once started, so later calls do nothing
+    if(!m_connection || m_recvStreaming)
+        return;
+    m_recvStreaming = true;
+
+    Connection* connection = m_connection.get();
+    if(Connection::isNetworkThreadRunning()) {
+        // messages are framed and decrypted on the network thread, each one reaches onRecv from Connection::poll
+        auto self = std::make_shared<ProtocolPtr>(asProtocol());
+        m_connection->postToNetworkThread([self, connection]() {
+            connection->internal_read_packets(std::bind(&Protocol::internalRecvPacket, *self, connection, std::placeholders::_1, std::placeholders::_2));
+            Connection::postToMainThread([self]() { self->reset(); });
+        });
+        return;
+    }
+
+    m_connection->read_packets(std::bind(&Protocol::internalRecvPacket, asProtocol(), connection, std::placeholders::_1, std::placeholders::_2));
+}
+
+void Protocol::internalRecvPacket(Connection* connection, uint8* buffer, uint16 size)
 {
     m_inputMessage->reset();
 
@@ -102,44 +124,56 @@ void Protocol::recv()
         headerSize += 2; // 2 bytes for XTEA encrypted message size
     m_inputMessage->setHeaderSize(headerSize);
 
-    // read the first 2 bytes which contain the message size
-    if(m_connection)
-        m_connection->read(2, std::bind(&Protocol::internalRecvHeader, asProtocol(), std::placeholders::_1,  std::placeholders::_2));
-}
-
-void Protocol::internalRecvHeader(uint8* buffer, uint16 size)
-{
-    // read message size
-    m_inputMessage->fillBuffer(buffer, size);
-    uint16 remainingSize = m_inputMessage->readSize();
-
-    // read remaining message data
-    if(m_connection)
-        m_connection->read(remainingSize, std::bind(&Protocol::internalRecvData, asProtocol(), std::placeholders::_1,  std::placeholders::_2));
-}
-
-void Protocol::internalRecvData(uint8* buffer, uint16 size)
-{
-    // process data only if really connected
-    if(!isConnected()) {
-        g_logger.traceError("received data while disconnected");
+    if(size > InputMessage::BUFFER_MAXSIZE - InputMessage::MAX_HEADER_SIZE + headerSize) {
+        recvError("got a network message bigger than the input buffer");
         return;
     }
 
+    // the buffer holds the whole message, including its size
     m_inputMessage->fillBuffer(buffer, size);
+    m_inputMessage->readSize();
 
     if(m_checksumEnabled && !m_inputMessage->readChecksum()) {
-        g_logger.traceError("got a network message with invalid checksum");
+        recvError("got a network message with invalid checksum");
         return;
     }
 
     if(m_xteaEncryptionEnabled) {
+        ticks_t decryptStart = stdext::micros();
         if(!xteaDecrypt(m_inputMessage)) {
-            g_logger.traceError("failed to decrypt message");
+            recvError("failed to decrypt message");
             return;
         }
+        connection->getTelemetry().recordDecrypt((int)(stdext::micros() - decryptStart));
+    }
+
+    if(!Connection::isNetworkThreadRunning()) {
+        onRecv(m_inputMessage);
+        return;
     }
-    onRecv(m_inputMessage);
+
+    // the message and the protocol reference are released by the main thread
+    auto message = std::make_shared<InputMessagePtr>(new InputMessage);
+    message->swap(m_inputMessage);
+    auto self = std::make_shared<ProtocolPtr>(asProtocol());
+    uint generation = connection->m_generation;
+    Connection::postToMainThread([self, message, connection, generation]() {
+        ProtocolPtr protocol = *self;
+        InputMessagePtr inputMessage = *message;
+        self->reset();
+        message->reset();
+        if(protocol->m_connection == connection && connection->m_generation == generation)
+            protocol->onRecv(inputMessage);
+    });
+}
+
+void Protocol::recvError(const std::string& message)
+{
+    // the logger may call into lua, so errors found on the network thread are reported from the main thread
+    if(Connection::isNetworkThreadRunning())
+        Connection::postToMainThread([message]() { g_logger.error(message); });
+    else
+        g_logger.traceError(message);
 }
 
 void Protocol::generateXteaKey()
@@ -173,31 +207,16 @@ bool Protocol::xteaDecrypt(const InputMessagePtr& inputMessage)
 {
     uint16 encryptedSize = inputMessage->getUnreadSize();
     if(encryptedSize % 8 != 0) {
-        g_logger.traceError("invalid encrypted network message");
+        recvError("invalid encrypted network message");
         return false;
     }
 
-    uint32 *buffer = (uint32*)(inputMessage->getReadBuffer());
-    int readPos = 0;
-
-    while(readPos < encryptedSize/4) {
-        uint32 v0 = buffer[readPos], v1 = buffer[readPos + 1];
-        uint32 delta = 0x61C88647;
-        uint32 sum = 0xC6EF3720;
-
-        for(int32 i = 0; i < 32; i++) {
-            v1 -= ((v0 << 4 ^ v0 >> 5) + v0) ^ (sum + m_xteaKey[sum>>11 & 3]);
-            sum += delta;
-            v0 -= ((v1 << 4 ^ v1 >> 5) + v1) ^ (sum + m_xteaKey[sum & 3]);
-        }
-        buffer[readPos] = v0; buffer[readPos + 1] = v1;
-        readPos = readPos + 2;
-    }
+    g_crypt.xteaDecrypt(inputMessage->getReadBuffer(), encryptedSize, m_xteaKey);
 
     uint16 decryptedSize = inputMessage->getU16() + 2;
     int sizeDelta = decryptedSize - encryptedSize;
     if(sizeDelta > 0 || -sizeDelta > encryptedSize) {
-        g_logger.traceError("invalid decrypted network message");
+        recvError("invalid decrypted network message");
         return false;
     }
 
@@ -217,21 +236,7 @@ void Protocol::xteaEncrypt(const OutputMessagePtr& outputMessage)
         encryptedSize += n;
     }
 
-    int readPos = 0;
-    uint32 *buffer = (uint32*)(outputMessage->getDataBuffer() - 2);
-    while(readPos < encryptedSize / 4) {
-        uint32 v0 = buffer[readPos], v1 = buffer[readPos + 1];
-        uint32 delta = 0x61C88647;
-        uint32 sum = 0;
-
-        for(int32 i = 0; i < 32; i++) {
-            v0 += ((v1 << 4 ^ v1 >> 5) + v1) ^ (sum + m_xteaKey[sum & 3]);
-            sum -= delta;
-            v1 += ((v0 << 4 ^ v0 >> 5) + v0) ^ (sum + m_xteaKey[sum>>11 & 3]);
-        }
-        buffer[readPos] = v0; buffer[readPos + 1] = v1;
-        readPos = readPos + 2;
-    }
+    g_crypt.xteaEncrypt(outputMessage->getDataBuffer() - 2, encryptedSize, m_xteaKey);
 }
 
 void Protocol::onConnect()
@@ -45,7 +45,7 @@ public:
     ticks_t getElapsedTicksSinceLastRead() { return m_connection ? m_connection->getElapsedTicksSinceLastRead() : -1; }
 
     ConnectionPtr getConnection() { return m_connection; }
-    void setConnection(const ConnectionPtr& connection) { m_connection = connection; }
+    void setConnection(const ConnectionPtr& connection) { m_connection = connection; m_recvStreaming = false; }
 
     void generateXteaKey();
     void setXteaKey(uint32 a, uint32 b, uint32 c, uint32 d);
@@ -67,14 +67,15 @@ protected:
     uint32 m_xteaKey[4];
 
 private:
-    void internalRecvHeader(uint8* buffer, uint16 size);
-    void internalRecvData(uint8* buffer, uint16 size);
+    void internalRecvPacket(Connection* connection, uint8* buffer, uint16 size);
+    void recvError(const std::string& message);
 
     bool xteaDecrypt(const InputMessagePtr& inputMessage);
     void xteaEncrypt(const OutputMessagePtr& outputMessage);
 
-    bool m_checksumEnabled;
-    bool m_xteaEncryptionEnabled;
+    std::atomic<bool> m_checksumEnabled;
+    std::atomic<bool> m_xteaEncryptionEnabled;
+    bool m_recvStreaming;
     ConnectionPtr m_connection;
     InputMessagePtr m_inputMessage;
 };
@@ -23,9 +23,27 @@
 #include "protocolhttp.h"
 #include "connection.h"
 #include <framework/core/application.h>
+#include <framework/core/eventdispatcher.h>
+#include <framework/core/resourcemanager.h>
+#include <framework/core/filestream.h>
+#include <framework/luaengine/luainterface.h>
+
+extern asio::io_service g_ioService;
+
+std::map<std::string, ProtocolHttp::HostPool> ProtocolHttp::m_pools;
+uint ProtocolHttp::m_lastRequestId = 0;
+int ProtocolHttp::m_maxConnections = ProtocolHttp::MAX_CONNECTIONS;
+int ProtocolHttp::m_maxPipeline = ProtocolHttp::MAX_PIPELINE;
 
 ProtocolHttp::ProtocolHttp()
 {
+    m_recvPos = 0;
+    m_parseState = ParseHeaders;
+    m_remaining = 0;
+    m_status = 0;
+    m_responses = 0;
+    m_keepAlive = true;
+    m_closing = false;
 }
 
 ProtocolHttp::~ProtocolHttp()
@@ -79,3 +97,702 @@ void ProtocolHttp::onError(const boost::system::error_code& err)
     callLuaField("onError", err.message(), err.value());
     disconnect();
 }
+
+uint ProtocolHttp::request(const std::string& method, const std::string& url, const Headers& headers, const std::string& body,
+                           const std::string& outputFile, const ResponseCallback& callback)
+{
+    RequestPtr request = std::make_shared<Request>();
+    if(++m_lastRequestId == 0)
+        ++m_lastRequestId;
+    request->id = m_lastRequestId;
+    request->method = method;
+    stdext::toupper(request->method);
+    request->headers = headers;
+    request->body = body;
+    request->outputFile = outputFile;
+    request->callback = callback;
+    request->retries = 0;
+    request->canceled = false;
+
+    // failures are delivered from the event loop too, never before the id reaches the caller
+    if(!parseUrl(url, request->host, request->port, request->path)) {
+        g_dispatcher.addEvent([request, url]() {
+            deliver(request, 0, std::string(), Headers(), stdext::format("unsupported url '%s'", url));
+        });
+        return request->id;
+    }
+
+    std::string key = poolKey(request->host, request->port);
+    m_pools[key].queue.push_back(request);
+    dispatch(key);
+    return request->id;
+}
+
+bool ProtocolHttp::cancel(uint id)
+{
+    for(auto& it : m_pools) {
+        HostPool& pool = it.second;
+        for(auto rit = pool.queue.begin(); rit != pool.queue.end(); ++rit) {
+            if((*rit)->id == id) {
+                pool.queue.erase(rit);
+                return true;
+            }
+        }
+
+        // responses already requested are still read to keep the pipeline in order, just not delivered
+        for(const ProtocolHttpPtr& connection : pool.connections) {
+            for(const RequestPtr& request : connection->m_inFlight) {
+                if(request->id == id && !request->canceled) {
+                    request->canceled = true;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void ProtocolHttp::cancelAll()
+{
+    for(auto& it : m_pools) {
+        HostPool& pool = it.second;
+        pool.queue.clear();
+        for(const ProtocolHttpPtr& connection : pool.connections) {
+            for(const RequestPtr& request : connection->m_inFlight)
+                request->canceled = true;
+        }
+    }
+}
+
+void ProtocolHttp::terminate()
+{
+    cancelAll();
+    for(auto& it : m_pools) {
+        std::vector<ProtocolHttpPtr> connections = it.second.connections;
+        for(const ProtocolHttpPtr& connection : connections)
+            connection->closePooled(std::string());
+    }
+    m_pools.clear();
+}
+
+int ProtocolHttp::getPendingRequests()
+{
+    int pending = 0;
+    for(auto& it : m_pools) {
+        pending += it.second.queue.size();
+        for(const ProtocolHttpPtr& connection : it.second.connections) {
+            pending += std::count_if(connection->m_inFlight.begin(), connection->m_inFlight.end(),
+                                     [](const RequestPtr& request) { return !request->canceled; });
+        }
+    }
+    return pending;
+}
+
+int ProtocolHttp::getOpenConnections()
+{
+    int connections = 0;
+    for(auto& it : m_pools)
+        connections += it.second.connections.size();
+    return connections;
+}
+
+bool ProtocolHttp::parseUrl(const std::string& url, std::string& host, uint16& port, std::string& path)
+{
+    std::string rest = url;
+    size_t schemeEnd = rest.find("://");
+    if(schemeEnd != std::string::npos) {
+        std::string scheme = rest.substr(0, schemeEnd);
+        stdext::tolower(scheme);
+        // no tls support in the client, https urls are refused instead of sent in clear
+        if(scheme != "http")
+            return false;
+        rest = rest.substr(schemeEnd + 3);
+    }
+
+    size_t pathStart = rest.find('/');
+    std::string authority = rest.substr(0, pathStart);
+    path = pathStart != std::string::npos ? rest.substr(pathStart) : "/";
+    path = path.substr(0, path.find('#'));
+
+    port = 80;
+    size_t portStart = authority.rfind(':');
+    if(portStart != std::string::npos) {
+        int value = stdext::unsafe_cast<int>(authority.substr(portStart + 1), 0);
+        if(value <= 0 || value > 0xFFFF)
+            return false;
+        port = value;
+        authority = authority.substr(0, portStart);
+    }
+    host = authority;
+    return !host.empty();
+}
+
+void ProtocolHttp::dispatch(const std::string& key)
+{
+    HostPool& pool = m_pools[key];
+    while(!pool.queue.empty()) {
+        RequestPtr request = pool.queue.front();
+
+        // an idle connection first, then a new one, pipelining only once the host limit is reached
+        ProtocolHttpPtr target;
+        for(const ProtocolHttpPtr& connection : pool.connections) {
+            if(!connection->m_closing && connection->m_inFlight.empty()) {
+                target = connection;
+                break;
+            }
+        }
+
+        if(!target && (int)pool.connections.size() < m_maxConnections) {
+            target = ProtocolHttpPtr(new ProtocolHttp);
+            target->m_poolKey = key;
+            pool.connections.push_back(target);
+            target->open(request->host, request->port);
+        }
+
+        if(!target) {
+            for(const ProtocolHttpPtr& connection : pool.connections) {
+                if(connection->canTake(request) && (!target || connection->m_inFlight.size() < target->m_inFlight.size()))
+                    target = connection;
+            }
+        }
+
+        if(!target)
+            break;
+
+        pool.queue.pop_front();
+        target->sendRequest(request);
+    }
+}
+
+void ProtocolHttp::deliver(const RequestPtr& request, int status, const std::string& body, const Headers& headers, const std::string& error)
+{
+    if(request->canceled)
+        return;
+    request->canceled = true;
+
+    if(request->callback)
+        request->callback(request->id, status, body, headers, error);
+    else
+        g_lua.callGlobalField("ProtocolHttp", "onResponse", request->id, status, body, headers, error);
+}
+
+void ProtocolHttp::open(const std::string& host, uint16 port)
+{
+    m_connection = ConnectionPtr(new Connection);
+    m_connection->setErrorCallback(std::bind(&ProtocolHttp::onPooledError, asProtocolHttp(), std::placeholders::_1));
+    m_connection->connect(host, port, std::bind(&ProtocolHttp::onPooledConnect, asProtocolHttp()));
+}
+
+bool ProtocolHttp::canTake(const RequestPtr& request)
+{
+    if(m_closing || !m_keepAlive)
+        return false;
+    if(m_inFlight.empty())
+        return true;
+
+    // only idempotent requests are pipelined, a failed pipeline can always be replayed
+    if(!request->isIdempotent() || (int)m_inFlight.size() >= m_maxPipeline)
+        return false;
+    return std::all_of(m_inFlight.begin(), m_inFlight.end(), [](const RequestPtr& other) { return other->isIdempotent(); });
+}
+
+void ProtocolHttp::sendRequest(const RequestPtr& request)
+{
+    m_inFlight.push_back(request);
+
+    // requests taken while connecting are written once the connection is up
+    if(m_connection && m_connection->isConnected())
+        writeRequest(request);
+}
+
+void ProtocolHttp::writeRequest(const RequestPtr& request)
+{
+    auto hasHeader = [&](const std::string& name) {
+        for(const auto& it : request->headers) {
+            std::string key = it.first;
+            stdext::tolower(key);
+            if(key == name)
+                return true;
+        }
+        return false;
+    };
+
+    std::string data = stdext::format("%s %s HTTP/1.1\r\n", request->method, request->path);
+    if(!hasHeader("host"))
+        data += request->port == 80 ? stdext::format("Host: %s\r\n", request->host) : stdext::format("Host: %s:%d\r\n", request->host, request->port);
+    if(!hasHeader("user-agent"))
+        data += stdext::format("User-Agent: %s/%s\r\n", g_app.getCompactName(), g_app.getVersion());
+    if(!hasHeader("connection"))
+        data += "Connection: keep-alive\r\n";
+    if(!hasHeader("content-length") && (!request->body.empty() || request->method == "POST" || request->method == "PUT"))
+        data += stdext::format("Content-Length: %d\r\n", request->body.size());
+    for(const auto& it : request->headers)
+        data += stdext::format("%s: %s\r\n", it.first, it.second);
+    data += "\r\n";
+    data += request->body;
+
+    m_connection->write((uint8*)&data[0], data.size());
+}
+
+void ProtocolHttp::readMore()
+{
+    if(m_connection && m_connection->isConnected())
+        m_connection->read_some(std::bind(&ProtocolHttp::onPooledRecv, asProtocolHttp(), std::placeholders::_1, std::placeholders::_2));
+}
+
+void ProtocolHttp::onPooledConnect()
+{
+    for(const RequestPtr& request : m_inFlight)
+        writeRequest(request);
+    readMore();
+}
+
+void ProtocolHttp::onPooledRecv(uint8* buffer, uint16 size)
+{
+    // response callbacks may close every connection, keep this one alive until the end
+    ProtocolHttpPtr self = asProtocolHttp();
+    m_recvData.append((char*)buffer, size);
+    if(parse())
+        readMore();
+}
+
+void ProtocolHttp::onPooledError(const boost::system::error_code& err)
+{
+    ProtocolHttpPtr self = asProtocolHttp();
+    if(m_closing)
+        return;
+
+    // responses without length or chunks end with the connection
+    if(err == asio::error::eof && m_parseState == ParseUntilClose && !m_inFlight.empty()) {
+        finishResponse();
+        return;
+    }
+    closePooled(err.message());
+}
+
+bool ProtocolHttp::parse()
+{
+    bool waiting = false;
+    while(!waiting && !m_closing) {
+        size_t available = m_recvData.size() - m_recvPos;
+        switch(m_parseState) {
+            case ParseHeaders: {
+                size_t end = m_recvData.find("\r\n\r\n", m_recvPos);
+                if(end == std::string::npos) {
+                    if(available > MAX_HEADER_SIZE)
+                        closePooled("response headers too large");
+                    waiting = true;
+                    break;
+                }
+                std::string block = m_recvData.substr(m_recvPos, end - m_recvPos);
+                m_recvPos = end + 4;
+                if(!parseHeaders(block))
+                    closePooled("malformed response");
+                break;
+            }
+            case ParseBody:
+            case ParseChunkData:
+            case ParseUntilClose: {
+                if(available == 0) {
+                    waiting = true;
+                    break;
+                }
+                size_t size = m_parseState == ParseUntilClose ? available : std::min<size_t>(available, m_remaining);
+                appendBody(&m_recvData[m_recvPos], size);
+                m_recvPos += size;
+                if(m_parseState == ParseUntilClose)
+                    break;
+                m_remaining -= size;
+                if(m_remaining == 0) {
+                    if(m_parseState == ParseBody)
+                        finishResponse();
+                    else
+                        m_parseState = ParseChunkEnd;
+                }
+                break;
+            }
+            case ParseChunkSize: {
+                size_t end = m_recvData.find("\r\n", m_recvPos);
+                if(end == std::string::npos) {
+                    if(available > 1024)
+                        closePooled("malformed chunk");
+                    waiting = true;
+                    break;
+                }
+                std::string line = m_recvData.substr(m_recvPos, end - m_recvPos);
+                m_recvPos = end + 2;
+                line = line.substr(0, line.find(';'));
+                stdext::trim(line);
+                char *lineEnd = nullptr;
+                unsigned long size = strtoul(line.c_str(), &lineEnd, 16);
+                if(line.empty() || *lineEnd != '\0') {
+                    closePooled("malformed chunk");
+                    break;
+                }
+                if(size == 0)
+                    m_parseState = ParseTrailer;
+                else {
+                    m_remaining = size;
+                    m_parseState = ParseChunkData;
+                }
+                break;
+            }
+            case ParseChunkEnd: {
+                if(available < 2) {
+                    waiting = true;
+                    break;
+                }
+                if(m_recvData.compare(m_recvPos, 2, "\r\n") != 0) {
+                    closePooled("malformed chunk");
+                    break;
+                }
+                m_recvPos += 2;
+                m_parseState = ParseChunkSize;
+                break;
+            }
+            case ParseTrailer: {
+                size_t end = m_recvData.find("\r\n", m_recvPos);
+                if(end == std::string::npos) {
+                    waiting = true;
+                    break;
+                }
+                bool last = end == m_recvPos;
+                m_recvPos = end + 2;
+                if(last)
+                    finishResponse();
+                break;
+            }
+        }
+    }
+
+    if(m_recvPos > 0) {
+        m_recvData.erase(0, m_recvPos);
+        m_recvPos = 0;
+    }
+    return !m_closing;
+}
+
+bool ProtocolHttp::parseHeaders(const std::string& block)
+{
+    if(m_inFlight.empty())
+        return false;
+
+    std::vector<std::string> lines;
+    size_t lineStart = 0;
+    while(lineStart <= block.size()) {
+        size_t lineEnd = block.find("\r\n", lineStart);
+        if(lineEnd == std::string::npos)
+            lineEnd = block.size();
+        lines.push_back(block.substr(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd + 2;
+    }
+
+    // status line, HTTP/1.1 200 OK
+    std::vector<std::string> statusLine = stdext::split(lines[0], " ");
+    if(statusLine.size() < 2 || !stdext::starts_with(statusLine[0], "HTTP/"))
+        return false;
+    int status = stdext::unsafe_cast<int>(statusLine[1], 0);
+    if(status < 100)
+        return false;
+
+    // interim responses, the real one follows
+    if(status / 100 == 1)
+        return true;
+
+    Headers headers;
+    for(uint i = 1; i < lines.size(); ++i) {
+        size_t colon = lines[i].find(':');
+        if(colon == std::string::npos)
+            continue;
+        std::string key = lines[i].substr(0, colon);
+        std::string value = lines[i].substr(colon + 1);
+        stdext::tolower(key);
+        stdext::trim(key);
+        stdext::trim(value);
+        if(headers.count(key))
+            headers[key] += ", " + value;
+        else
+            headers[key] = value;
+    }
+
+    m_status = status;
+    m_responseHeaders = headers;
+
+    std::string connection = headers["connection"];
+    stdext::tolower(connection);
+    if(statusLine[0] == "HTTP/1.0")
+        m_keepAlive = connection.find("keep-alive") != std::string::npos;
+    else
+        m_keepAlive = connection.find("close") == std::string::npos;
+
+    const RequestPtr& request = m_inFlight.front();
+    if(!request->outputFile.empty() && !request->canceled) {
+        try {
+            m_responseFile = g_resources.createFile(request->outputFile);
+        } catch(stdext::exception& e) {
+            m_fileError = e.what();
+        }
+    }
+
+    std::string transferEncoding = headers["transfer-encoding"];
+    stdext::tolower(transferEncoding);
+    if(request->method == "HEAD" || status == 204 || status == 304)
+        finishResponse();
+    else if(transferEncoding.find("chunked") != std::string::npos)
+        m_parseState = ParseChunkSize;
+    else if(headers.count("content-length")) {
+        m_remaining = stdext::unsafe_cast<size_t>(headers["content-length"], 0);
+        if(m_remaining > 0)
+            m_parseState = ParseBody;
+        else
+            finishResponse();
+    } else {
+        m_parseState = ParseUntilClose;
+        m_keepAlive = false;
+    }
+    return true;
+}
+
+void ProtocolHttp::appendBody(const char* data, size_t size)
+{
+    if(m_inFlight.empty() || m_inFlight.front()->canceled)
+        return;
+
+    // downloads go straight to the file, only the in memory bodies grow
+    if(m_responseFile)
+        m_responseFile->write(data, size);
+    else if(m_inFlight.front()->outputFile.empty())
+        m_responseBody.append(data, size);
+}
+
+void ProtocolHttp::finishResponse()
+{
+    RequestPtr request = m_inFlight.front();
+    m_inFlight.pop_front();
+    m_responses++;
+
+    if(m_responseFile) {
+        m_responseFile->close();
+        m_responseFile = nullptr;
+    }
+
+    int status = m_status;
+    Headers headers;
+    headers.swap(m_responseHeaders);
+    std::string body;
+    body.swap(m_responseBody);
+    std::string error;
+    error.swap(m_fileError);
+    m_parseState = ParseHeaders;
+    m_status = 0;
+    m_remaining = 0;
+
+    if(!m_keepAlive)
+        closePooled(std::string());
+
+    if(error.empty())
+        deliver(request, status, body, headers, error);
+    else
+        deliver(request, 0, std::string(), headers, error);
+
+    if(!m_closing)
+        dispatch(m_poolKey);
+}
+
+void ProtocolHttp::closePooled(const std::string& error)
+{
+    if(m_closing)
+        return;
+
+    ProtocolHttpPtr self = asProtocolHttp();
+    m_closing = true;
+    if(m_connection) {
+        m_connection->close();
+        m_connection = nullptr;
+    }
+    if(m_responseFile) {
+        m_responseFile->close();
+        m_responseFile = nullptr;
+    }
+
+    HostPool& pool = m_pools[m_poolKey];
+    auto it = std::find(pool.connections.begin(), pool.connections.end(), self);
+    if(it != pool.connections.end())
+        pool.connections.erase(it);
+
+    // a reused connection may be closed by the server at any time, idempotent requests are sent again
+    std::deque<RequestPtr> inFlight;
+    inFlight.swap(m_inFlight);
+    std::vector<RequestPtr> failed;
+    for(auto rit = inFlight.rbegin(); rit != inFlight.rend(); ++rit) {
+        const RequestPtr& request = *rit;
+        if(request->canceled)
+            continue;
+        if(request->isIdempotent() && request->retries < MAX_RETRIES && m_responses > 0) {
+            request->retries++;
+            pool.queue.push_front(request);
+        } else
+            failed.push_back(request);
+    }
+
+    std::string reason = error.empty() ? "connection closed" : error;
+    for(auto rit = failed.rbegin(); rit != failed.rend(); ++rit)
+        deliver(*rit, 0, std::string(), Headers(), reason);
+
+    dispatch(m_poolKey);
+}
+
+std::map<std::string, double> ProtocolHttp::benchmarkRequests(int requests, int bodySize)
+{
+    std::map<std::string, double> result;
+    requests = std::max<int>(requests, 1);
+    bodySize = stdext::clamp<int>(bodySize, 0, 1024 * 1024);
+
+    // loopback stand-in for a web server, keep-alive with content-length and chunked replies taking turns
+    struct StandInSession {
+        StandInSession() : socket(g_ioService), writing(false) { }
+        asio::ip::tcp::socket socket;
+        std::array<char, 4096> buffer;
+        std::string data;
+        std::deque<std::shared_ptr<std::string>> replies;
+        bool writing;
+    };
+    typedef std::shared_ptr<StandInSession> StandInSessionPtr;
+    struct StandInServer {
+        StandInServer() : acceptor(g_ioService), served(0) { }
+        asio::ip::tcp::acceptor acceptor;
+        std::vector<StandInSessionPtr> sessions;
+        std::string body;
+        int served;
+    };
+    auto server = std::make_shared<StandInServer>();
+    server->body.assign(bodySize, 'x');
+
+    boost::system::error_code ec;
+    asio::ip::tcp::endpoint endpoint(asio::ip::address_v4::loopback(), 0);
+    server->acceptor.open(endpoint.protocol(), ec);
+    if(!ec)
+        server->acceptor.bind(endpoint, ec);
+    if(!ec)
+        server->acceptor.listen(asio::socket_base::max_connections, ec);
+    if(ec) {
+        g_logger.error(stdext::format("unable to start the benchmark server: %s", ec.message()));
+        return result;
+    }
+
+    std::shared_ptr<std::function<void(const StandInSessionPtr&)>> writeNext = std::make_shared<std::function<void(const StandInSessionPtr&)>>();
+    std::shared_ptr<std::function<void(const StandInSessionPtr&)>> readNext = std::make_shared<std::function<void(const StandInSessionPtr&)>>();
+    std::shared_ptr<std::function<void()>> acceptNext = std::make_shared<std::function<void()>>();
+    std::weak_ptr<std::function<void(const StandInSessionPtr&)>> weakWrite = writeNext, weakRead = readNext;
+    std::weak_ptr<std::function<void()>> weakAccept = acceptNext;
+
+    *writeNext = [weakWrite](const StandInSessionPtr& session) {
+        if(session->writing || session->replies.empty())
+            return;
+        session->writing = true;
+        std::shared_ptr<std::string> reply = session->replies.front();
+        asio::async_write(session->socket, asio::buffer(*reply), [weakWrite, session, reply](const boost::system::error_code& error, size_t) {
+            session->writing = false;
+            session->replies.pop_front();
+            auto writeNext = weakWrite.lock();
+            if(!error && writeNext)
+                (*writeNext)(session);
+        });
+    };
+    *readNext = [weakRead, weakWrite, server](const StandInSessionPtr& session) {
+        session->socket.async_read_some(asio::buffer(session->buffer), [weakRead, weakWrite, server, session](const boost::system::error_code& error, size_t size) {
+            auto readNext = weakRead.lock();
+            auto writeNext = weakWrite.lock();
+            if(error || !readNext || !writeNext)
+                return;
+            session->data.append(session->buffer.data(), size);
+            size_t end;
+            while((end = session->data.find("\r\n\r\n")) != std::string::npos) {
+                session->data.erase(0, end + 4);
+                auto reply = std::make_shared<std::string>();
+                if(server->served++ % 2 == 0)
+                    *reply = stdext::format("HTTP/1.1 200 OK\r\nContent-Length: %d\r\n\r\n", server->body.size()) + server->body;
+                else {
+                    *reply = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n";
+                    for(size_t pos = 0; pos < server->body.size(); pos += 1000) {
+                        size_t chunk = std::min<size_t>(1000, server->body.size() - pos);
+                        *reply += stdext::format("%x\r\n", chunk) + server->body.substr(pos, chunk) + "\r\n";
+                    }
+                    *reply += "0\r\n\r\n";
+                }
+                session->replies.push_back(reply);
+            }
+            (*writeNext)(session);
+            (*readNext)(session);
+        });
+    };
+    *acceptNext = [weakAccept, weakRead, server]() {
+        auto session = std::make_shared<StandInSession>();
+        server->acceptor.async_accept(session->socket, [weakAccept, weakRead, server, session](const boost::system::error_code& error) {
+            auto acceptNext = weakAccept.lock();
+            auto readNext = weakRead.lock();
+            if(error || !acceptNext || !readNext)
+                return;
+            server->sessions.push_back(session);
+            (*readNext)(session);
+            (*acceptNext)();
+        });
+    };
+    g_ioService.post([acceptNext]() { (*acceptNext)(); });
+
+    int completed = 0;
+    int failed = 0;
+    int peakConnections = 0;
+    std::string url = stdext::format("http://127.0.0.1:%d/", server->acceptor.local_endpoint().port());
+    std::string key = poolKey("127.0.0.1", server->acceptor.local_endpoint().port());
+    for(int i = 0; i < requests; ++i) {
+        get(url + stdext::to_string(i), [&](uint, int status, const std::string& body, const Headers&, const std::string&) {
+            if(status == 200 && (int)body.size() == bodySize && body == server->body)
+                completed++;
+            else
+                failed++;
+        });
+    }
+
+    stdext::timer timer;
+    std::clock_t cpuStart = std::clock();
+    while(completed + failed < requests && timer.elapsed_seconds() < 30) {
+        Connection::poll();
+        peakConnections = std::max<int>(peakConnections, m_pools[key].connections.size());
+        if(Connection::isNetworkThreadRunning())
+            std::this_thread::yield();
+    }
+    double seconds = timer.elapsed_seconds();
+    double cpuSeconds = (std::clock() - cpuStart) / (double)CLOCKS_PER_SEC;
+
+    // the callbacks above reference this frame, nothing may reach them once we return
+    HostPool& pool = m_pools[key];
+    pool.queue.clear();
+    std::vector<ProtocolHttpPtr> connections = pool.connections;
+    for(const ProtocolHttpPtr& connection : connections) {
+        for(const RequestPtr& request : connection->m_inFlight)
+            request->canceled = true;
+        connection->closePooled(std::string());
+    }
+    m_pools.erase(key);
+
+    g_ioService.post([server, writeNext, readNext, acceptNext]() {
+        boost::system::error_code ec;
+        server->acceptor.close(ec);
+        for(const StandInSessionPtr& session : server->sessions)
+            session->socket.close(ec);
+    });
+    if(!Connection::isNetworkThreadRunning())
+        Connection::poll();
+
+    if(completed < requests)
+        g_logger.warning(stdext::format("benchmark completed only %d of %d requests", completed, requests));
+
+    result["requests"] = completed;
+    result["failed"] = failed;
+    result["seconds"] = seconds;
+    result["requestsPerSecond"] = completed / std::max<double>(seconds, 1e-6);
+    result["cpuMicrosPerRequest"] = cpuSeconds * 1000000.0 / std::max<int>(completed, 1);
+    result["connections"] = peakConnections;
+    return result;
+}
@@ -32,6 +32,17 @@
 class ProtocolHttp : public LuaObject
 {
 public:
+    typedef std::map<std::string, std::string> Headers;
+    // id, status, body, response headers and an error message, status is 0 when the request failed
+    typedef std::function<void(uint, int, const std::string&, const Headers&, const std::string&)> ResponseCallback;
+
+    enum {
+        MAX_CONNECTIONS = 4, // per host
+        MAX_PIPELINE = 4, // requests sent ahead on one connection
+        MAX_HEADER_SIZE = 65536,
+        MAX_RETRIES = 1 // idempotent requests are resent once when a reused connection drops them
+    };
+
     ProtocolHttp();
     virtual ~ProtocolHttp();
 
@@ -43,13 +54,102 @@ public:
 
     ProtocolHttpPtr asProtocolHttp() { return static_self_cast<ProtocolHttp>(); }
 
+    // pooled http/1.1 client, keep-alive connections shared by every request to the same host
+    // when the callback is empty the response goes to ProtocolHttp.onResponse(id, status, body, headers, error)
+    static uint request(const std::string& method, const std::string& url, const Headers& headers, const std::string& body,
+                        const std::string& outputFile, const ResponseCallback& callback);
+    static uint get(const std::string& url, const ResponseCallback& callback) { return request("GET", url, Headers(), std::string(), std::string(), callback); }
+    static bool cancel(uint id);
+    static void cancelAll();
+    static void terminate();
+
+    static void setMaxConnections(int maxConnections) { m_maxConnections = std::max<int>(maxConnections, 1); }
+    static int getMaxConnections() { return m_maxConnections; }
+    static void setMaxPipeline(int maxPipeline) { m_maxPipeline = std::max<int>(maxPipeline, 1); }
+    static int getMaxPipeline() { return m_maxPipeline; }
+    static int getPendingRequests();
+    static int getOpenConnections();
+
+    static std::map<std::string, double> benchmarkRequests(int requests, int bodySize);
+
 protected:
     void onConnect();
     void onRecv(uint8* buffer, uint16 size);
     void onError(const boost::system::error_code& err);
 
 private:
+    struct Request {
+        uint id;
+        std::string method;
+        std::string host;
+        uint16 port;
+        std::string path;
+        Headers headers;
+        std::string body;
+        std::string outputFile;
+        ResponseCallback callback;
+        int retries;
+        bool canceled;
+        bool isIdempotent() const { return method == "GET" || method == "HEAD" || method == "OPTIONS"; }
+    };
+    typedef std::shared_ptr<Request> RequestPtr;
+
+    struct HostPool {
+        std::vector<ProtocolHttpPtr> connections;
+        std::deque<RequestPtr> queue;
+    };
+
+    enum ParseState {
+        ParseHeaders,
+        ParseBody,
+        ParseChunkSize,
+        ParseChunkData,
+        ParseChunkEnd,
+        ParseTrailer,
+        ParseUntilClose
+    };
+
+    static bool parseUrl(const std::string& url, std::string& host, uint16& port, std::string& path);
+    static std::string poolKey(const std::string& host, uint16 port) { return stdext::format("%s:%d", host, port); }
+    static void dispatch(const std::string& key);
+    static void deliver(const RequestPtr& request, int status, const std::string& body, const Headers& headers, const std::string& error);
+
+    void open(const std::string& host, uint16 port);
+    bool canTake(const RequestPtr& request);
+    void sendRequest(const RequestPtr& request);
+    void writeRequest(const RequestPtr& request);
+    void readMore();
+    void onPooledConnect();
+    void onPooledRecv(uint8* buffer, uint16 size);
+    void onPooledError(const boost::system::error_code& err);
+    bool parse();
+    bool parseHeaders(const std::string& block);
+    void appendBody(const char* data, size_t size);
+    void finishResponse();
+    void closePooled(const std::string& error);
+
     ConnectionPtr m_connection;
+
+    // pooled connection state
+    std::string m_poolKey;
+    std::deque<RequestPtr> m_inFlight; // sent and waiting for their response, in order
+    std::string m_recvData;
+    size_t m_recvPos;
+    ParseState m_parseState;
+    size_t m_remaining;
+    int m_status;
+    int m_responses;
+    Headers m_responseHeaders;
+    std::string m_responseBody;
+    FileStreamPtr m_responseFile;
+    std::string m_fileError;
+    bool m_keepAlive;
+    bool m_closing;
+
+    static std::map<std::string, HostPool> m_pools;
+    static uint m_lastRequestId;
+    static int m_maxConnections;
+    static int m_maxPipeline;
 };
 
 #endif
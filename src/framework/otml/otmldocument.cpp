@@ -25,6 +25,9 @@
 #include "otmlemitter.h"
 
 #include <framework/core/resourcemanager.h>
+#include <framework/core/asyncdispatcher.h>
+
+std::unordered_map<std::string, OTMLDocumentPtr> OTMLDocument::m_preloaded;
 
 OTMLDocumentPtr OTMLDocument::create()
 {
@@ -37,6 +40,14 @@ OTMLDocumentPtr OTMLDocument::parse(const std::string& fileName)
 {
     std::stringstream fin;
     std::string source = g_resources.resolvePath(fileName);
+
+    auto it = m_preloaded.find(source);
+    if(it != m_preloaded.end()) {
+        OTMLDocumentPtr doc = it->second;
+        m_preloaded.erase(it);
+        return doc;
+    }
+
     g_resources.readFileStream(source, fin);
     return parse(fin, source);
 }
@@ -50,6 +61,46 @@ OTMLDocumentPtr OTMLDocument::parse(std::istream& in, const std::string& source)
     return doc;
 }
 
+void OTMLDocument::preload(const std::vector<std::string>& fileNames)
+{
+    // documents are built entirely on one worker and handed over with a reference taken there,
+    // the non atomic reference counts are never touched by two threads at once
+    typedef std::pair<OTMLDocument*, std::string> ParseResult;
+
+    std::vector<boost::shared_future<ParseResult>> results;
+    for(const std::string& fileName : fileNames) {
+        std::string source = g_resources.resolvePath(fileName);
+        results.push_back(g_asyncDispatcher.schedule([source]() {
+            ParseResult result(nullptr, std::string());
+            try {
+                std::stringstream fin(g_resources.readFileContents(source));
+                OTMLDocumentPtr doc = parse(fin, source);
+                doc->add_ref();
+                result.first = doc.get();
+            } catch(stdext::exception& e) {
+                result.second = e.what();
+            }
+            return result;
+        }));
+    }
+
+    for(uint i = 0; i < results.size(); ++i) {
+        const ParseResult& result = results[i].get();
+        if(result.first) {
+            OTMLDocumentPtr doc(result.first, false);
+            m_preloaded[doc->source()] = doc;
+        } else {
+            // the error shows up again when the file is really parsed
+            g_logger.debug(stdext::format("Unable to preload '%s': %s", fileNames[i], result.second));
+        }
+    }
+}
+
+void OTMLDocument::clearPreloaded()
+{
+    m_preloaded.clear();
+}
+
 std::string OTMLDocument::emit()
 {
     return OTMLEmitter::emitNode(asOTMLNode()) + "\n";
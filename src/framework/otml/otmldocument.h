@@ -40,6 +40,10 @@ public:
     /// @param source is the file name that will be used to show errors messages
     static OTMLDocumentPtr parse(std::istream& in, const std::string& source);
 
+    /// Reads and parses files on worker threads, the next parse of each file takes its document
+    static void preload(const std::vector<std::string>& fileNames);
+    static void clearPreloaded();
+
     /// Emits this document and all it's children to a std::string
     std::string emit();
 
@@ -48,6 +52,8 @@ public:
 
 private:
     OTMLDocument() { }
+
+    static std::unordered_map<std::string, OTMLDocumentPtr> m_preloaded;
 };
 
 #endif
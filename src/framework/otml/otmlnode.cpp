@@ -24,6 +24,8 @@
 #include "otmlemitter.h"
 #include "otmldocument.h"
 
+#include <mutex>
+
 OTMLNodePtr OTMLNode::create(std::string tag, bool unique)
 {
     OTMLNodePtr node(new OTMLNode);
@@ -41,6 +43,20 @@ OTMLNodePtr OTMLNode::create(std::string tag, std::string value)
     return node;
 }
 
+int OTMLNode::internTag(const std::string& tag)
+{
+    // documents may be parsed outside the main thread
+    static std::mutex mutex;
+    static std::unordered_map<std::string, int> tags = { { "", 0 } };
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = tags.find(tag);
+    if(it != tags.end())
+        return it->second;
+    int id = tags.size();
+    tags[tag] = id;
+    return id;
+}
+
 bool OTMLNode::hasChildren()
 {
     int count = 0;
@@ -179,7 +195,8 @@ OTMLNodeList OTMLNode::children()
 OTMLNodePtr OTMLNode::clone()
 {
     OTMLNodePtr myClone(new OTMLNode);
-    myClone->setTag(m_tag);
+    myClone->m_tag = m_tag;
+    myClone->m_tagId = m_tagId;
     myClone->setValue(m_value);
     myClone->setUnique(m_unique);
     myClone->setNull(m_null);
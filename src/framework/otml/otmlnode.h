@@ -33,7 +33,8 @@ public:
     static OTMLNodePtr create(std::string tag = "", bool unique = false);
     static OTMLNodePtr create(std::string tag, std::string value);
 
-    std::string tag() { return m_tag; }
+    const std::string& tag() { return m_tag; }
+    int tagId() { return m_tagId; }
     int size() { return m_children.size(); }
     std::string source() { return m_source; }
     std::string rawValue() { return m_value; }
@@ -47,7 +48,7 @@ public:
     bool hasChildAt(const std::string& childTag) { return !!get(childTag); }
     bool hasChildAtIndex(int childIndex) { return !!getIndex(childIndex); }
 
-    void setTag(const std::string& tag) { m_tag = tag; }
+    void setTag(const std::string& tag) { m_tag = tag; m_tagId = internTag(tag); }
     void setValue(const std::string& value) { m_value = value; }
     void setNull(bool null) { m_null = null; }
     void setUnique(bool unique) { m_unique = unique; }
@@ -91,11 +92,15 @@ public:
 
     OTMLNodePtr asOTMLNode() { return static_self_cast<OTMLNode>(); }
 
+    // every distinct tag gets a small id once, readers switch on ids instead of comparing strings
+    static int internTag(const std::string& tag);
+
 protected:
-    OTMLNode() : m_unique(false), m_null(false) { }
+    OTMLNode() : m_tagId(0), m_unique(false), m_null(false) { }
 
     OTMLNodeList m_children;
     std::string m_tag;
+    int m_tagId;
     std::string m_value;
     std::string m_source;
     bool m_unique;
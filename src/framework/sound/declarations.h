@@ -38,6 +38,7 @@ class SoundChannel;
 class StreamSoundSource;
 class CombinedSoundSource;
 class OggSoundFile;
+class StreamDecoder;
 
 typedef stdext::shared_object_ptr<SoundSource> SoundSourcePtr;
 typedef stdext::shared_object_ptr<SoundFile> SoundFilePtr;
@@ -47,4 +48,7 @@ typedef stdext::shared_object_ptr<StreamSoundSource> StreamSoundSourcePtr;
 typedef stdext::shared_object_ptr<CombinedSoundSource> CombinedSoundSourcePtr;
 typedef stdext::shared_object_ptr<OggSoundFile> OggSoundFilePtr;
 
+// shared with the audio thread, so reference counted by std::shared_ptr
+typedef std::shared_ptr<StreamDecoder> StreamDecoderPtr;
+
 #endif
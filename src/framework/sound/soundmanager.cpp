@@ -26,6 +26,7 @@
 #include "soundfile.h"
 #include "streamsoundsource.h"
 #include "combinedsoundsource.h"
+#include "streamdecoder.h"
 
 #include <framework/core/clock.h>
 #include <framework/core/eventdispatcher.h>
@@ -37,10 +38,22 @@ SoundManager g_sounds;
 
 void SoundManager::init()
 {
+    resetStreamStats();
+    resetBufferCacheStats();
+    m_bufferCacheBudget = BUFFER_CACHE_BUDGET;
+    m_bufferCacheMemory = 0;
+    m_decoding = true;
+    m_decodeThread = std::thread(std::bind(&SoundManager::decodeLoop, this));
+
     m_device = alcOpenDevice(nullptr);
     if(!m_device) {
-        g_logger.error("unable to open audio device");
-        return;
+        // openal soft null backend, streams keep decoding and timing as if a device was there
+        m_device = alcOpenDevice("No Output");
+        if(!m_device) {
+            g_logger.error("unable to open audio device");
+            return;
+        }
+        g_logger.warning("no audio device available, using the null output device");
     }
 
     m_context = alcCreateContext(m_device, nullptr);
@@ -57,6 +70,14 @@ void SoundManager::init()
 
 void SoundManager::terminate()
 {
+    {
+        std::lock_guard<std::mutex> lock(m_decodeMutex);
+        m_decoding = false;
+    }
+    m_decodeCondition.notify_all();
+    if(m_decodeThread.joinable())
+        m_decodeThread.join();
+
     ensureContext();
 
     for(auto &streamFile: m_streamFiles) {
@@ -65,8 +86,12 @@ void SoundManager::terminate()
     }
     m_streamFiles.clear();
 
+    for(auto& preload : m_preloads)
+        preload.second.wait();
+    m_preloads.clear();
+
     m_sources.clear();
-    m_buffers.clear();
+    clearBufferCache();
     m_channels.clear();
 
     m_audioEnabled = false;
@@ -101,17 +126,39 @@ void SoundManager::poll()
         auto& future = it->second;
 
         if(future.is_ready()) {
-            SoundFilePtr sound = future.get();
-            if(sound)
-                source->setSoundFile(sound);
-            else
+            const LoadedSoundFile& loaded = future.get();
+            if(loaded.first)
+                source->setSoundFile(loaded.first);
+            else {
+                g_logger.error(stdext::format("unable to stream sound: %s", loaded.second));
                 source->stop();
+            }
             it = m_streamFiles.erase(it);
         } else {
             ++it;
         }
     }
 
+    for(auto it = m_preloads.begin(); it != m_preloads.end();) {
+        auto& future = it->second;
+        if(!future.is_ready()) {
+            ++it;
+            continue;
+        }
+
+        const DecodedSoundPtr& decoded = future.get();
+        if(decoded->tooLarge)
+            m_streamedFiles.insert(it->first);
+        else if(!decoded->error.empty())
+            g_logger.error(stdext::format("unable to preload sound '%s': %s", it->first, decoded->error));
+        else {
+            SoundBufferPtr buffer = SoundBufferPtr(new SoundBuffer);
+            if(buffer->fillBuffer(decoded->format, decoded->samples, decoded->samples.size(), decoded->rate))
+                cacheBuffer(it->first, buffer, decoded->samples.size());
+        }
+        it = m_preloads.erase(it);
+    }
+
     for(auto it = m_sources.begin(); it != m_sources.end();) {
         SoundSourcePtr source = *it;
 
@@ -154,16 +201,27 @@ void SoundManager::preload(std::string filename)
     if(it != m_buffers.end())
         return;
 
-    ensureContext();
-    SoundFilePtr soundFile = SoundFile::loadSoundFile(filename);
+    schedulePreload(filename);
+}
 
-    // only keep small files
-    if(!soundFile || soundFile->getSize() > MAX_CACHE_SIZE)
-        return;
+bool SoundManager::preloadManifest(const std::string& manifestFile)
+{
+    // one sound per line, blank lines and lines starting with # are skipped
+    std::string contents;
+    try {
+        contents = g_resources.readFileContents(manifestFile);
+    } catch(stdext::exception& e) {
+        g_logger.error(stdext::format("unable to read sound preload manifest '%s': %s", manifestFile, e.what()));
+        return false;
+    }
 
-    SoundBufferPtr buffer = SoundBufferPtr(new SoundBuffer);
-    if(buffer->fillBuffer(soundFile))
-        m_buffers[filename] = buffer;
+    for(std::string line : stdext::split(contents, "\n")) {
+        stdext::trim(line);
+        if(line.empty() || line[0] == '#')
+            continue;
+        preload(line);
+    }
+    return true;
 }
 
 SoundSourcePtr SoundManager::play(std::string filename, float fadetime, float gain)
@@ -224,9 +282,15 @@ SoundSourcePtr SoundManager::createSoundSource(const std::string& filename)
     try {
         auto it = m_buffers.find(filename);
         if(it != m_buffers.end()) {
+            m_bufferCacheHits++;
+            m_buffersLru.splice(m_buffersLru.begin(), m_buffersLru, it->second.lruIt);
             source = SoundSourcePtr(new SoundSource);
-            source->setBuffer(it->second);
+            source->setBuffer(it->second.buffer);
         } else {
+            // stream this time, decode in background so the next play comes from the cache
+            m_bufferCacheMisses++;
+            schedulePreload(filename);
+
 #if defined __linux && !defined OPENGL_ES
             // due to OpenAL implementation bug, stereo buffers are always downmixed to mono on linux systems
             // this is hack to work around the issue
@@ -239,41 +303,19 @@ SoundSourcePtr SoundManager::createSoundSource(const std::string& filename)
             streamSource->setRelative(true);
             streamSource->setPosition(Point(-128, 0));
             combinedSource->addSource(streamSource);
-            m_streamFiles[streamSource] = g_asyncDispatcher.schedule([=]() -> SoundFilePtr {
-                stdext::timer a;
-                try {
-                    return SoundFile::loadSoundFile(filename);
-                } catch(std::exception& e) {
-                    g_logger.error(e.what());
-                    return nullptr;
-                }
-            });
+            scheduleStream(streamSource, filename);
 
             streamSource = StreamSoundSourcePtr(new StreamSoundSource);
             streamSource->downMix(StreamSoundSource::DownMixRight);
             streamSource->setRelative(true);
             streamSource->setPosition(Point(128,0));
             combinedSource->addSource(streamSource);
-            m_streamFiles[streamSource] = g_asyncDispatcher.schedule([=]() -> SoundFilePtr {
-                try {
-                    return SoundFile::loadSoundFile(filename);
-                } catch(std::exception& e) {
-                    g_logger.error(e.what());
-                    return nullptr;
-                }
-            });
+            scheduleStream(streamSource, filename);
 
             source = combinedSource;
 #else
             StreamSoundSourcePtr streamSource(new StreamSoundSource);
-            m_streamFiles[streamSource] = g_asyncDispatcher.schedule([=]() -> SoundFilePtr {
-                try {
-                    return SoundFile::loadSoundFile(filename);
-                } catch(std::exception& e) {
-                    g_logger.error(e.what());
-                    return nullptr;
-                }
-            });
+            scheduleStream(streamSource, filename);
             source = streamSource;
 #endif
         }
@@ -285,6 +327,178 @@ SoundSourcePtr SoundManager::createSoundSource(const std::string& filename)
     return source;
 }
 
+void SoundManager::addStreamDecoder(const StreamDecoderPtr& decoder)
+{
+    std::lock_guard<std::mutex> lock(m_decodeMutex);
+    m_decoders.push_back(decoder);
+    m_decodeCondition.notify_all();
+}
+
+void SoundManager::removeStreamDecoder(const StreamDecoderPtr& decoder)
+{
+    std::lock_guard<std::mutex> lock(m_decodeMutex);
+    auto it = std::find(m_decoders.begin(), m_decoders.end(), decoder);
+    if(it != m_decoders.end())
+        m_decoders.erase(it);
+}
+
+void SoundManager::resetStreamStats()
+{
+    m_streamUnderruns = 0;
+    m_decodedFragments = 0;
+    m_decodeMicros = 0;
+    m_peakDecodeMicros = 0;
+}
+
+void SoundManager::decodeLoop()
+{
+    std::unique_lock<std::mutex> lock(m_decodeMutex);
+    while(m_decoding) {
+        std::vector<StreamDecoderPtr> decoders = m_decoders;
+        lock.unlock();
+
+        // one fragment per stream and pass, so a long file can't starve the others
+        bool decoded = false;
+        for(const StreamDecoderPtr& decoder : decoders) {
+            stdext::timer timer;
+            if(!decoder->decode())
+                continue;
+            int64 micros = timer.elapsed_micros();
+            m_decodedFragments++;
+            m_decodeMicros += micros;
+            if(micros > m_peakDecodeMicros)
+                m_peakDecodeMicros = micros;
+            decoded = true;
+        }
+        decoders.clear();
+
+        lock.lock();
+        if(!decoded && m_decoding)
+            m_decodeCondition.wait_for(lock, std::chrono::milliseconds(DECODE_IDLE_DELAY));
+    }
+}
+
+void SoundManager::setBufferCacheBudget(int budget)
+{
+    m_bufferCacheBudget = std::max<int>(budget, 0);
+    evictBuffers(m_bufferCacheBudget);
+}
+
+void SoundManager::clearBufferCache()
+{
+    m_buffers.clear();
+    m_buffersLru.clear();
+    m_bufferCacheMemory = 0;
+}
+
+void SoundManager::resetBufferCacheStats()
+{
+    m_bufferCacheHits = 0;
+    m_bufferCacheMisses = 0;
+}
+
+void SoundManager::schedulePreload(const std::string& filename)
+{
+    if(m_preloads.find(filename) != m_preloads.end() || m_streamedFiles.find(filename) != m_streamedFiles.end())
+        return;
+
+    // compressed sounds never decode to less than their file size, music and other
+    // large files are known to be streamed without reading them
+    if(g_resources.getFileSize(filename) > MAX_CACHE_SIZE) {
+        m_streamedFiles.insert(filename);
+        return;
+    }
+
+    m_preloads[filename] = g_asyncDispatcher.schedule([=]() -> DecodedSoundPtr {
+        return decodeSound(filename);
+    });
+}
+
+void SoundManager::scheduleStream(const StreamSoundSourcePtr& source, const std::string& filename)
+{
+    // runs on the async dispatcher, errors are logged by the main thread in poll
+    m_streamFiles[source] = g_asyncDispatcher.schedule([=]() -> LoadedSoundFile {
+        try {
+            SoundFilePtr soundFile = SoundFile::loadSoundFile(filename);
+            if(!soundFile)
+                return LoadedSoundFile(nullptr, stdext::format("unsupported sound file %s", filename));
+            return LoadedSoundFile(soundFile, std::string());
+        } catch(std::exception& e) {
+            return LoadedSoundFile(nullptr, e.what());
+        }
+    });
+}
+
+void SoundManager::cacheBuffer(const std::string& filename, const SoundBufferPtr& buffer, int size)
+{
+    if(size > m_bufferCacheBudget)
+        return;
+
+    auto it = m_buffers.find(filename);
+    if(it != m_buffers.end()) {
+        m_bufferCacheMemory -= it->second.size;
+        m_buffersLru.erase(it->second.lruIt);
+        m_buffers.erase(it);
+    }
+
+    evictBuffers(m_bufferCacheBudget - size);
+
+    m_buffersLru.push_front(filename);
+    CachedBuffer& cached = m_buffers[filename];
+    cached.buffer = buffer;
+    cached.size = size;
+    cached.lruIt = m_buffersLru.begin();
+    m_bufferCacheMemory += size;
+}
+
+void SoundManager::evictBuffers(int budget)
+{
+    // sources still playing an evicted buffer keep it alive until they are done
+    while(m_bufferCacheMemory > budget && !m_buffersLru.empty()) {
+        auto it = m_buffers.find(m_buffersLru.back());
+        m_bufferCacheMemory -= it->second.size;
+        m_buffers.erase(it);
+        m_buffersLru.pop_back();
+    }
+}
+
+SoundManager::DecodedSoundPtr SoundManager::decodeSound(const std::string& filename)
+{
+    // runs on the async dispatcher, errors are reported back instead of logged from here
+    DecodedSoundPtr decoded = DecodedSoundPtr(new DecodedSound);
+    try {
+        SoundFilePtr soundFile = SoundFile::loadSoundFile(filename);
+        if(!soundFile) {
+            decoded->error = "unsupported sound file";
+            return decoded;
+        }
+
+        // only keep small files
+        if(soundFile->getSize() > MAX_CACHE_SIZE) {
+            decoded->tooLarge = true;
+            return decoded;
+        }
+
+        decoded->format = soundFile->getSampleFormat();
+        decoded->rate = soundFile->getRate();
+        if(decoded->format == AL_UNDETERMINED) {
+            decoded->error = "unable to determine sample format";
+            return decoded;
+        }
+
+        decoded->samples.resize(soundFile->getSize());
+        int read = soundFile->read(&decoded->samples[0], soundFile->getSize());
+        if(read <= 0) {
+            decoded->error = "unable to read sound data";
+            return decoded;
+        }
+        decoded->samples.resize(read);
+    } catch(std::exception& e) {
+        decoded->error = e.what();
+    }
+    return decoded;
+}
+
 std::string SoundManager::resolveSoundFile(std::string file)
 {
     file = g_resources.guessFilePath(file, "ogg");
@@ -25,13 +25,17 @@
 
 #include "declarations.h"
 #include "soundchannel.h"
+#include <framework/util/databuffer.h>
+#include <atomic>
 
 //@bindsingleton g_sounds
 class SoundManager
 {
     enum {
-        MAX_CACHE_SIZE = 100000,
-        POLL_DELAY = 100
+        MAX_CACHE_SIZE = 100000, // larger files are always streamed
+        BUFFER_CACHE_BUDGET = 16 * 1024 * 1024, // default bytes of decoded pcm kept in the buffer cache
+        POLL_DELAY = 100,
+        DECODE_IDLE_DELAY = 10 // ms the audio thread sleeps when every stream is decoded ahead
     };
 public:
     void init();
@@ -45,23 +49,84 @@ public:
     void stopAll();
 
     void preload(std::string filename);
+    bool preloadManifest(const std::string& manifestFile);
     SoundSourcePtr play(std::string filename, float fadetime = 0, float gain = 0);
     SoundChannelPtr getChannel(int channel);
 
     std::string resolveSoundFile(std::string file);
     void ensureContext();
 
+    void addStreamDecoder(const StreamDecoderPtr& decoder);
+    void removeStreamDecoder(const StreamDecoderPtr& decoder);
+    void addStreamUnderrun() { m_streamUnderruns++; }
+
+    int getStreamUnderruns() { return m_streamUnderruns; }
+    int getDecodedFragments() { return m_decodedFragments; }
+    double getDecodeTime() { return m_decodeMicros / 1000000.0; }
+    double getPeakDecodeTime() { return m_peakDecodeMicros / 1000000.0; }
+    void resetStreamStats();
+
+    void setBufferCacheBudget(int budget);
+    int getBufferCacheBudget() { return m_bufferCacheBudget; }
+    int getBufferCacheMemory() { return m_bufferCacheMemory; }
+    int getBufferCacheCount() { return m_buffers.size(); }
+    int getBufferCacheHits() { return m_bufferCacheHits; }
+    int getBufferCacheMisses() { return m_bufferCacheMisses; }
+    int getPendingPreloads() { return m_preloads.size(); }
+    void clearBufferCache();
+    void resetBufferCacheStats();
+
 private:
+    struct DecodedSound {
+        DecodedSound() : format(AL_UNDETERMINED), rate(0), tooLarge(false) { }
+        DataBuffer<char> samples;
+        ALenum format;
+        int rate;
+        bool tooLarge;
+        std::string error;
+    };
+    typedef std::shared_ptr<DecodedSound> DecodedSoundPtr;
+    typedef std::pair<SoundFilePtr, std::string> LoadedSoundFile; // the file, or the error why it failed
+
+    struct CachedBuffer {
+        SoundBufferPtr buffer;
+        int size;
+        std::list<std::string>::iterator lruIt;
+    };
+
     SoundSourcePtr createSoundSource(const std::string& filename);
+    void decodeLoop();
+    void schedulePreload(const std::string& filename);
+    void scheduleStream(const StreamSoundSourcePtr& source, const std::string& filename);
+    void cacheBuffer(const std::string& filename, const SoundBufferPtr& buffer, int size);
+    void evictBuffers(int budget);
+    static DecodedSoundPtr decodeSound(const std::string& filename);
 
     ALCdevice *m_device;
     ALCcontext *m_context;
 
-    std::map<StreamSoundSourcePtr, boost::shared_future<SoundFilePtr>> m_streamFiles;
-    std::unordered_map<std::string, SoundBufferPtr> m_buffers;
+    std::map<StreamSoundSourcePtr, boost::shared_future<LoadedSoundFile>> m_streamFiles;
+    std::unordered_map<std::string, CachedBuffer> m_buffers;
+    std::list<std::string> m_buffersLru; // most recently played first
+    std::unordered_map<std::string, boost::shared_future<DecodedSoundPtr>> m_preloads;
+    std::set<std::string> m_streamedFiles; // too large for the cache, don't decode them again
+    int m_bufferCacheBudget;
+    int m_bufferCacheMemory;
+    int m_bufferCacheHits;
+    int m_bufferCacheMisses;
     std::vector<SoundSourcePtr> m_sources;
     stdext::boolean<true> m_audioEnabled;
     std::unordered_map<int, SoundChannelPtr> m_channels;
+
+    std::thread m_decodeThread;
+    std::mutex m_decodeMutex;
+    std::condition_variable m_decodeCondition;
+    std::vector<StreamDecoderPtr> m_decoders;
+    bool m_decoding;
+    int m_streamUnderruns;
+    std::atomic<int> m_decodedFragments;
+    std::atomic<int64> m_decodeMicros;
+    std::atomic<int64> m_peakDecodeMicros;
 };
 
 extern SoundManager g_sounds;
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "streamdecoder.h"
+#include "soundfile.h"
+
+StreamDecoder::StreamDecoder(const SoundFilePtr& soundFile, int fragmentSize, int fragments) :
+    m_file(soundFile.get()),
+    m_fragments(fragments),
+    m_head(0),
+    m_count(0),
+    m_eof(false),
+    m_fragmentSize(fragmentSize),
+    m_format(soundFile->getSampleFormat()),
+    m_rate(soundFile->getRate()),
+    m_downMix(NoDownMix),
+    m_looping(false)
+{
+}
+
+bool StreamDecoder::decode()
+{
+    std::lock_guard<std::mutex> fileLock(m_fileMutex);
+    if(!m_file)
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_eof || m_count == m_fragments.size())
+            return false;
+    }
+
+    DownMix downMix = m_downMix;
+    int maxRead = m_fragmentSize;
+    if(downMix != NoDownMix)
+        maxRead *= 2;
+    m_decodeBuffer.resize(maxRead);
+
+    int bytesRead = 0;
+    bool eof = false;
+    bool rewound = false;
+    try {
+        do {
+            int read = m_file->read(&m_decodeBuffer[bytesRead], maxRead - bytesRead);
+            if(read > 0) {
+                bytesRead += read;
+                rewound = false;
+            }
+
+            // end of sound file, a looping file that gives nothing after a rewind is empty
+            if(bytesRead < maxRead) {
+                if(m_looping && !rewound) {
+                    m_file->reset();
+                    rewound = true;
+                } else {
+                    eof = true;
+                    break;
+                }
+            }
+        } while(bytesRead < maxRead);
+    } catch(std::exception&) {
+        // a broken file ends the stream where it broke
+        eof = true;
+    }
+    m_decodeBuffer.resize(bytesRead);
+
+    if(downMix != NoDownMix && m_format == AL_FORMAT_STEREO16) {
+        assert(bytesRead % 2 == 0);
+        bytesRead /= 2;
+        uint16_t *data = (uint16_t*)m_decodeBuffer.data();
+        for(int i=0;i<bytesRead/2;i++)
+            data[i] = data[2*i + (downMix == DownMixLeft ? 0 : 1)];
+        m_decodeBuffer.resize(bytesRead);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(bytesRead > 0) {
+        m_fragments[(m_head + m_count) % m_fragments.size()].swap(m_decodeBuffer);
+        m_count++;
+    }
+    m_eof = eof;
+    return true;
+}
+
+bool StreamDecoder::pop(std::vector<char>& fragment)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_count == 0)
+        return false;
+    fragment.swap(m_fragments[m_head]);
+    m_head = (m_head + 1) % m_fragments.size();
+    m_count--;
+    return true;
+}
+
+void StreamDecoder::rewind()
+{
+    std::lock_guard<std::mutex> fileLock(m_fileMutex);
+    if(!m_file)
+        return;
+    m_file->reset();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_head = 0;
+    m_count = 0;
+    m_eof = false;
+}
+
+void StreamDecoder::close()
+{
+    // waits for a decode in progress, the file may go away right after this
+    std::lock_guard<std::mutex> fileLock(m_fileMutex);
+    m_file = nullptr;
+}
+
+ALenum StreamDecoder::getFormat()
+{
+    if(m_downMix != NoDownMix && m_format == AL_FORMAT_STEREO16)
+        return AL_FORMAT_MONO16;
+    return m_format;
+}
+
+int StreamDecoder::getReadyCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_count;
+}
+
+bool StreamDecoder::isFinished()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_eof && m_count == 0;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef STREAMDECODER_H
+#define STREAMDECODER_H
+
+#include "declarations.h"
+#include <atomic>
+
+// decodes a sound file into a ring of pcm fragments ahead of playback,
+// filled by the sound manager audio thread and drained by the main thread
+class StreamDecoder
+{
+public:
+    enum DownMix { NoDownMix, DownMixLeft, DownMixRight };
+
+    StreamDecoder(const SoundFilePtr& soundFile, int fragmentSize, int fragments);
+
+    // audio thread, returns false when there was nothing to decode
+    bool decode();
+
+    // main thread
+    bool pop(std::vector<char>& fragment);
+    void rewind();
+    void close();
+
+    void setDownMix(DownMix downMix) { m_downMix = downMix; }
+    void setLooping(bool looping) { m_looping = looping; }
+
+    ALenum getFormat();
+    int getRate() { return m_rate; }
+    int getReadyCount();
+    bool isFinished();
+
+private:
+    std::mutex m_fileMutex; // held while decoding, keeps close and rewind away from the file
+    std::mutex m_mutex;
+    SoundFile *m_file;
+    std::vector<char> m_decodeBuffer;
+    std::vector<std::vector<char>> m_fragments;
+    uint m_head;
+    uint m_count;
+    bool m_eof;
+    int m_fragmentSize;
+    ALenum m_format;
+    int m_rate;
+    std::atomic<DownMix> m_downMix;
+    std::atomic<bool> m_looping;
+};
+
+#endif
@@ -21,27 +21,38 @@
  */
 
 #include "streamsoundsource.h"
+#include "streamdecoder.h"
 #include "soundbuffer.h"
 #include "soundfile.h"
-
-#include <framework/util/databuffer.h>
-#include <boost/concept_check.hpp>
+#include "soundmanager.h"
 
 StreamSoundSource::StreamSoundSource()
 {
-    for(auto& buffer : m_buffers)
+    for(auto& buffer : m_buffers) {
         buffer = SoundBufferPtr(new SoundBuffer);
+        m_freeBuffers.push_back(buffer->getBufferId());
+    }
     m_downMix = NoDownMix;
+    m_underruns = 0;
 }
 
 StreamSoundSource::~StreamSoundSource()
 {
     stop();
+    closeDecoder();
 }
 
 void StreamSoundSource::setSoundFile(const SoundFilePtr& soundFile)
 {
+    closeDecoder();
     m_soundFile = soundFile;
+    if(m_soundFile) {
+        m_decoder = StreamDecoderPtr(new StreamDecoder(m_soundFile, STREAM_FRAGMENT_SIZE, STREAM_DECODE_AHEAD));
+        m_decoder->setDownMix((StreamDecoder::DownMix)m_downMix);
+        m_decoder->setLooping(m_looping);
+        g_sounds.addStreamDecoder(m_decoder);
+    }
+
     if(m_waitingFile) {
         m_waitingFile = false;
         play();
@@ -57,19 +68,21 @@ void StreamSoundSource::play()
         return;
     }
 
-    if(m_eof) {
-        m_soundFile->reset();
-        m_eof = false;
-    }
+    if(m_decoder->isFinished())
+        m_decoder->rewind();
 
-    queueBuffers();
+    // buffers queued on a stopped source count as processed, rewinding keeps them pending
+    alSourceRewind(m_sourceId);
 
-    SoundSource::play();
+    // the source starts on a later update, once the audio thread filled every buffer
+    m_starting = true;
+    queueBuffers();
 }
 
 void StreamSoundSource::stop()
 {
     m_playing = false;
+    m_starting = false;
 
     if(m_waitingFile)
         return;
@@ -80,11 +93,21 @@ void StreamSoundSource::stop()
 
 void StreamSoundSource::queueBuffers()
 {
-    int queued;
-    alGetSourcei(m_sourceId, AL_BUFFERS_QUEUED, &queued);
-    for(int i = 0; i < STREAM_FRAGMENTS - queued; ++i) {
-        if(!fillBufferAndQueue(m_buffers[i]->getBufferId()))
+    while(!m_freeBuffers.empty() && m_decoder->pop(m_fragment)) {
+        uint buffer = m_freeBuffers.back();
+
+        alBufferData(buffer, m_decoder->getFormat(), m_fragment.data(), m_fragment.size(), m_decoder->getRate());
+        ALenum err = alGetError();
+        if(err != AL_NO_ERROR)
+            g_logger.error(stdext::format("unable to refill audio buffer for '%s': %s", m_soundFile->getName(), alGetString(err)));
+
+        alSourceQueueBuffers(m_sourceId, 1, &buffer);
+        err = alGetError();
+        if(err != AL_NO_ERROR) {
+            g_logger.error(stdext::format("unable to queue audio buffer for '%s': %s", m_soundFile->getName(), alGetString(err)));
             break;
+        }
+        m_freeBuffers.pop_back();
     }
 }
 
@@ -95,9 +118,20 @@ void StreamSoundSource::unqueueBuffers()
     for(int i = 0; i < queued; ++i) {
         uint buffer;
         alSourceUnqueueBuffers(m_sourceId, 1, &buffer);
+        m_freeBuffers.push_back(buffer);
     }
 }
 
+void StreamSoundSource::closeDecoder()
+{
+    if(!m_decoder)
+        return;
+
+    m_decoder->close();
+    g_sounds.removeStreamDecoder(m_decoder);
+    m_decoder = nullptr;
+}
+
 void StreamSoundSource::update()
 {
     if(m_waitingFile)
@@ -111,79 +145,42 @@ void StreamSoundSource::update()
         uint buffer;
         alSourceUnqueueBuffers(m_sourceId, 1, &buffer);
         //SoundManager::check_al_error("Couldn't unqueue audio buffer: ");
-
-        if(!fillBufferAndQueue(buffer))
-            break;
+        m_freeBuffers.push_back(buffer);
     }
 
-    if(!isBuffering() && m_playing) {
-        if(!m_looping && m_eof) {
-            stop();
-        } else if(processed == 0) {
-            g_logger.traceError("audio buffer underrun");
-            play();
-        } else if(m_looping) {
-            play();
+    if(!m_playing)
+        return;
+
+    queueBuffers();
+
+    if(m_starting) {
+        if(m_freeBuffers.empty() || m_decoder->isFinished()) {
+            m_starting = false;
+            if(m_freeBuffers.size() == m_buffers.size())
+                stop(); // nothing left to play
+            else
+                SoundSource::play();
         }
+        return;
     }
-}
 
-bool StreamSoundSource::fillBufferAndQueue(uint buffer)
-{
-    if(m_waitingFile)
-        return false;
-
-    // fill buffer
-    static DataBuffer<char> bufferData(2*STREAM_FRAGMENT_SIZE);
-    ALenum format = m_soundFile->getSampleFormat();
-
-    int maxRead = STREAM_FRAGMENT_SIZE;
-    if(m_downMix != NoDownMix)
-        maxRead *= 2;
-
-    int bytesRead = 0;
-    do {
-        bytesRead += m_soundFile->read(&bufferData[bytesRead], maxRead - bytesRead);
-
-        // end of sound file
-        if(bytesRead < maxRead) {
-            if(m_looping)
-                m_soundFile->reset();
-            else {
-                m_eof = true;
-                break;
-            }
-        }
-    } while(bytesRead < maxRead);
-
-    if(bytesRead > 0) {
-        if(m_downMix != NoDownMix) {
-            if(format == AL_FORMAT_STEREO16) {
-                assert(bytesRead % 2 == 0);
-                bytesRead /= 2;
-                uint16_t *data = (uint16_t*)bufferData.data();
-                for(int i=0;i<bytesRead/2;i++)
-                    data[i] = data[2*i + (m_downMix == DownMixLeft ? 0 : 1)];
-                format = AL_FORMAT_MONO16;
-            }
+    if(!isBuffering()) {
+        if(m_freeBuffers.size() == m_buffers.size() && m_decoder->isFinished()) {
+            stop();
+        } else {
+            // played every queued buffer before the audio thread decoded more
+            g_logger.traceError("audio buffer underrun");
+            m_underruns++;
+            g_sounds.addStreamUnderrun();
+            alSourceRewind(m_sourceId);
+            m_starting = true;
         }
-
-        alBufferData(buffer, format, &bufferData[0], bytesRead, m_soundFile->getRate());
-        ALenum err = alGetError();
-        if(err != AL_NO_ERROR)
-            g_logger.error(stdext::format("unable to refill audio buffer for '%s': %s", m_soundFile->getName(), alGetString(err)));
-
-        alSourceQueueBuffers(m_sourceId, 1, &buffer);
-        err = alGetError();
-        if(err != AL_NO_ERROR)
-            g_logger.error(stdext::format("unable to queue audio buffer for '%s': %s", m_soundFile->getName(), alGetString(err)));
     }
-
-    // return false if there aren't more buffers to fill
-    return (bytesRead >= STREAM_FRAGMENT_SIZE && !m_eof);
 }
 
 void StreamSoundSource::downMix(StreamSoundSource::DownMix downMix)
 {
     m_downMix = downMix;
+    if(m_decoder)
+        m_decoder->setDownMix((StreamDecoder::DownMix)downMix);
 }
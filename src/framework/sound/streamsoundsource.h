@@ -30,7 +30,8 @@ class StreamSoundSource : public SoundSource
     enum {
         STREAM_BUFFER_SIZE = 1024 * 400,
         STREAM_FRAGMENTS = 4,
-        STREAM_FRAGMENT_SIZE = STREAM_BUFFER_SIZE / STREAM_FRAGMENTS
+        STREAM_FRAGMENT_SIZE = STREAM_BUFFER_SIZE / STREAM_FRAGMENTS,
+        STREAM_DECODE_AHEAD = 4 // fragments decoded ahead of the queued ones
     };
 
 public:
@@ -50,17 +51,23 @@ public:
 
     void update();
 
+    int getUnderruns() { return m_underruns; }
+
 private:
     void queueBuffers();
     void unqueueBuffers();
-    bool fillBufferAndQueue(uint buffer);
+    void closeDecoder();
 
     SoundFilePtr m_soundFile;
+    StreamDecoderPtr m_decoder;
     std::array<SoundBufferPtr,STREAM_FRAGMENTS> m_buffers;
+    std::vector<uint> m_freeBuffers;
+    std::vector<char> m_fragment;
     DownMix m_downMix;
+    int m_underruns;
     stdext::boolean<false> m_looping;
     stdext::boolean<false> m_playing;
-    stdext::boolean<false> m_eof;
+    stdext::boolean<false> m_starting; // waiting for the decoder to fill the buffers before playing
     stdext::boolean<false> m_waitingFile;
 };
 
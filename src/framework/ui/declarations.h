@@ -37,9 +37,12 @@ class UIAnchor;
 class UIAnchorGroup;
 class UIAnchorLayout;
 class UIParticles;
+class UIVirtualList;
+class UIStyleSheet;
 
 typedef stdext::shared_object_ptr<UIWidget> UIWidgetPtr;
 typedef stdext::shared_object_ptr<UIParticles> UIParticlesPtr;
+typedef stdext::shared_object_ptr<UIVirtualList> UIVirtualListPtr;
 typedef stdext::shared_object_ptr<UITextEdit> UITextEditPtr;
 typedef stdext::shared_object_ptr<UILayout> UILayoutPtr;
 typedef stdext::shared_object_ptr<UIBoxLayout> UIBoxLayoutPtr;
@@ -49,6 +52,7 @@ typedef stdext::shared_object_ptr<UIGridLayout> UIGridLayoutPtr;
 typedef stdext::shared_object_ptr<UIAnchor> UIAnchorPtr;
 typedef stdext::shared_object_ptr<UIAnchorGroup> UIAnchorGroupPtr;
 typedef stdext::shared_object_ptr<UIAnchorLayout> UIAnchorLayoutPtr;
+typedef stdext::shared_object_ptr<UIStyleSheet> UIStyleSheetPtr;
 
 typedef std::deque<UIWidgetPtr> UIWidgetList;
 typedef std::vector<UIAnchorPtr> UIAnchorList;
@@ -113,21 +113,33 @@ void UIAnchorLayout::addAnchor(const UIWidgetPtr& anchoredWidget, Fw::AnchorEdge
 
     assert(anchoredWidget != getParentWidget());
 
-    UIAnchorPtr anchor(new UIAnchor(anchoredEdge, hookedWidgetId, hookedEdge));
+    addAnchor(anchoredWidget, UIAnchorPtr(new UIAnchor(anchoredEdge, hookedWidgetId, hookedEdge)));
+}
+
+void UIAnchorLayout::addAnchor(const UIWidgetPtr& anchoredWidget, const UIAnchorPtr& anchor)
+{
     UIAnchorGroupPtr& anchorGroup = m_anchorsGroups[anchoredWidget];
     if(!anchorGroup)
         anchorGroup = UIAnchorGroupPtr(new UIAnchorGroup);
 
     anchorGroup->addAnchor(anchor);
+    rehookWidget(anchoredWidget);
 
-    // layout must be updated because a new anchor got in
-    update();
+    // the widget must be solved again, many anchors are usually added at once so it's done later
+    m_dirtyWidgets.insert(anchoredWidget);
+    updateLater();
 }
 
 void UIAnchorLayout::removeAnchors(const UIWidgetPtr& anchoredWidget)
 {
-    m_anchorsGroups.erase(anchoredWidget);
-    update();
+    auto it = m_anchorsGroups.find(anchoredWidget);
+    if(it == m_anchorsGroups.end())
+        return;
+
+    unlinkWidget(anchoredWidget, it->second);
+    m_anchorsGroups.erase(it);
+    m_dirtyWidgets.erase(anchoredWidget);
+    m_unhookedWidgets.erase(anchoredWidget);
 }
 
 bool UIAnchorLayout::hasAnchors(const UIWidgetPtr& anchoredWidget)
@@ -151,12 +163,112 @@ void UIAnchorLayout::fill(const UIWidgetPtr& anchoredWidget, const std::string&
 
 void UIAnchorLayout::addWidget(const UIWidgetPtr& widget)
 {
-    update();
+    updateWidgetHooks(widget);
 }
 
 void UIAnchorLayout::removeWidget(const UIWidgetPtr& widget)
 {
     removeAnchors(widget);
+
+    // widgets anchored to the removed one must find their hooks again
+    auto it = m_dependents.find(widget);
+    if(it != m_dependents.end()) {
+        std::vector<UIWidgetPtr> dependents = it->second;
+        for(const UIWidgetPtr& dependent : dependents)
+            rehookWidget(dependent);
+        m_dependents.erase(widget);
+    }
+    updateLater();
+}
+
+void UIAnchorLayout::invalidateWidget(const UIWidgetPtr& widget)
+{
+    // rects set while solving are already followed by their dependents, anything else waits for the next pass
+    if(m_updating && m_updateVisited.find(widget) != m_updateVisited.end())
+        return;
+    m_dirtyWidgets.insert(widget);
+}
+
+void UIAnchorLayout::updateWidgetHooks(const UIWidgetPtr& widget)
+{
+    UIWidgetPtr parentWidget = getParentWidget();
+    if(!parentWidget)
+        return;
+
+    // the widget id or position among its siblings changed, only anchors that could point to it are resolved again
+    std::vector<UIWidgetPtr> widgets;
+    widgets.push_back(widget);
+    auto it = m_dependents.find(widget);
+    if(it != m_dependents.end())
+        widgets.insert(widgets.end(), it->second.begin(), it->second.end());
+    if(UIWidgetPtr prev = parentWidget->getChildBefore(widget))
+        widgets.push_back(prev);
+    if(UIWidgetPtr next = parentWidget->getChildAfter(widget))
+        widgets.push_back(next);
+    widgets.insert(widgets.end(), m_unhookedWidgets.begin(), m_unhookedWidgets.end());
+
+    for(const UIWidgetPtr& other : widgets)
+        rehookWidget(other);
+    updateLater();
+}
+
+void UIAnchorLayout::rehookWidget(const UIWidgetPtr& widget)
+{
+    auto it = m_anchorsGroups.find(widget);
+    if(it == m_anchorsGroups.end())
+        return;
+
+    UIWidgetPtr parentWidget = getParentWidget();
+    if(!parentWidget)
+        return;
+
+    const UIAnchorGroupPtr& anchorGroup = it->second;
+    std::vector<UIWidgetPtr> hookedWidgets;
+    bool unhooked = false;
+    for(const UIAnchorPtr& anchor : anchorGroup->getAnchors()) {
+        if(anchor->getHookedEdge() == Fw::AnchorNone)
+            continue;
+
+        UIWidgetPtr hookedWidget = anchor->getHookedWidget(widget, parentWidget);
+        if(!hookedWidget)
+            unhooked = true;
+        else if(std::find(hookedWidgets.begin(), hookedWidgets.end(), hookedWidget) == hookedWidgets.end())
+            hookedWidgets.push_back(hookedWidget);
+    }
+
+    // anchors to ids that don't exist yet are retried whenever the children change
+    if(unhooked)
+        m_unhookedWidgets.insert(widget);
+    else
+        m_unhookedWidgets.erase(widget);
+
+    if(hookedWidgets == anchorGroup->getHookedWidgets())
+        return;
+
+    unlinkWidget(widget, anchorGroup);
+    for(const UIWidgetPtr& hookedWidget : hookedWidgets)
+        m_dependents[hookedWidget].push_back(widget);
+    anchorGroup->setHookedWidgets(hookedWidgets);
+    m_dirtyWidgets.insert(widget);
+}
+
+void UIAnchorLayout::unlinkWidget(const UIWidgetPtr& widget, const UIAnchorGroupPtr& anchorGroup)
+{
+    for(const UIWidgetPtr& hookedWidget : anchorGroup->getHookedWidgets()) {
+        auto it = m_dependents.find(hookedWidget);
+        if(it == m_dependents.end())
+            continue;
+
+        std::vector<UIWidgetPtr>& dependents = it->second;
+        auto dit = std::find(dependents.begin(), dependents.end(), widget);
+        if(dit != dependents.end()) {
+            *dit = dependents.back();
+            dependents.pop_back();
+        }
+        if(dependents.empty())
+            m_dependents.erase(it);
+    }
+    anchorGroup->setHookedWidgets(std::vector<UIWidgetPtr>());
 }
 
 bool UIAnchorLayout::updateWidget(const UIWidgetPtr& widget, const UIAnchorGroupPtr& anchorGroup, UIWidgetPtr first)
@@ -253,23 +365,41 @@ bool UIAnchorLayout::updateWidget(const UIWidgetPtr& widget, const UIAnchorGroup
 
 bool UIAnchorLayout::internalUpdate()
 {
-    bool changed = false;
+    if(m_dirtyWidgets.empty())
+        return false;
 
-    // reset all anchors groups update state
-    for(auto& it : m_anchorsGroups) {
-        const UIAnchorGroupPtr& anchorGroup = it.second;
-        anchorGroup->setUpdated(false);
+    // collect dirty widgets and everything anchored to them, the rest of the layout is left untouched
+    std::vector<UIWidgetPtr> pending(m_dirtyWidgets.begin(), m_dirtyWidgets.end());
+    std::vector<std::pair<UIWidgetPtr, UIAnchorGroupPtr>> dirtyGroups;
+    m_dirtyWidgets.clear();
+    m_updateVisited.clear();
+
+    while(!pending.empty()) {
+        UIWidgetPtr widget = pending.back();
+        pending.pop_back();
+        if(!m_updateVisited.insert(widget).second)
+            continue;
+
+        auto git = m_anchorsGroups.find(widget);
+        if(git != m_anchorsGroups.end()) {
+            git->second->setUpdated(false);
+            dirtyGroups.push_back(*git);
+        }
+
+        auto dit = m_dependents.find(widget);
+        if(dit != m_dependents.end())
+            pending.insert(pending.end(), dit->second.begin(), dit->second.end());
     }
 
-    // update all anchors
-    for(auto& it : m_anchorsGroups) {
-        const UIWidgetPtr& widget = it.first;
-        const UIAnchorGroupPtr& anchorGroup = it.second;
-        if(!anchorGroup->isUpdated()) {
-            if(updateWidget(widget, anchorGroup))
+    // hooked widgets out of the dirty set stay updated, so updateWidget won't recurse into them
+    bool changed = false;
+    for(auto& it : dirtyGroups) {
+        if(!it.second->isUpdated()) {
+            if(updateWidget(it.first, it.second))
                 changed = true;
         }
     }
 
+    m_updateVisited.clear();
     return changed;
 }
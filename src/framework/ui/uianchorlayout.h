@@ -24,6 +24,7 @@
 #define UIANCHORLAYOUT_H
 
 #include "uilayout.h"
+#include <unordered_set>
 
 class UIAnchor : public stdext::shared_object
 {
@@ -50,11 +51,14 @@ public:
 
     void addAnchor(const UIAnchorPtr& anchor);
     const UIAnchorList& getAnchors() { return m_anchors; }
+    const std::vector<UIWidgetPtr>& getHookedWidgets() { return m_hookedWidgets; }
     bool isUpdated() { return m_updated; }
     void setUpdated(bool updated) { m_updated = updated; }
+    void setHookedWidgets(const std::vector<UIWidgetPtr>& hookedWidgets) { m_hookedWidgets = hookedWidgets; }
 
 private:
     UIAnchorList m_anchors;
+    std::vector<UIWidgetPtr> m_hookedWidgets;
     bool m_updated;
 };
 
@@ -73,13 +77,22 @@ public:
 
     void addWidget(const UIWidgetPtr& widget);
     void removeWidget(const UIWidgetPtr& widget);
+    void invalidateWidget(const UIWidgetPtr& widget);
+    void updateWidgetHooks(const UIWidgetPtr& widget);
 
     bool isUIAnchorLayout() { return true; }
 
 protected:
+    void addAnchor(const UIWidgetPtr& anchoredWidget, const UIAnchorPtr& anchor);
+    void rehookWidget(const UIWidgetPtr& widget);
+    void unlinkWidget(const UIWidgetPtr& widget, const UIAnchorGroupPtr& anchorGroup);
     virtual bool internalUpdate();
     virtual bool updateWidget(const UIWidgetPtr& widget, const UIAnchorGroupPtr& anchorGroup, UIWidgetPtr first = nullptr);
     std::unordered_map<UIWidgetPtr, UIAnchorGroupPtr> m_anchorsGroups;
+    std::unordered_map<UIWidgetPtr, std::vector<UIWidgetPtr>> m_dependents;
+    std::unordered_set<UIWidgetPtr> m_dirtyWidgets;
+    std::unordered_set<UIWidgetPtr> m_updateVisited;
+    std::unordered_set<UIWidgetPtr> m_unhookedWidgets;
 };
 
 #endif
@@ -39,6 +39,8 @@ public:
     virtual void applyStyle(const OTMLNodePtr& styleNode) { }
     virtual void addWidget(const UIWidgetPtr& widget) { }
     virtual void removeWidget(const UIWidgetPtr& widget) { }
+    virtual void invalidateWidget(const UIWidgetPtr& widget) { }
+    virtual void updateWidgetHooks(const UIWidgetPtr& widget) { }
     void disableUpdates() { m_updateDisabled++; }
     void enableUpdates() { m_updateDisabled = std::max<int>(m_updateDisabled-1,0); }
 
@@ -22,6 +22,7 @@
 
 #include "uimanager.h"
 #include "ui.h"
+#include "uistylesheet.h"
 
 #include <framework/otml/otml.h>
 #include <framework/graphics/graphics.h>
@@ -39,6 +40,8 @@ void UIManager::init()
     m_rootWidget->setId("root");
     m_mouseReceiver = m_rootWidget;
     m_keyboardReceiver = m_rootWidget;
+    m_renderCaches = 0;
+    resetRenderCacheStats();
 }
 
 void UIManager::terminate()
@@ -312,6 +315,7 @@ void UIManager::onWidgetDestroy(const UIWidgetPtr& widget)
 void UIManager::clearStyles()
 {
     m_styles.clear();
+    m_styleSheets.clear();
 }
 
 bool UIManager::importStyle(std::string file)
@@ -371,6 +375,13 @@ void UIManager::importStyleFromOTML(const OTMLNodePtr& styleNode)
         style->merge(styleNode);
         style->setTag(name);
         m_styles[name] = style;
+
+        // state selectors are parsed here once, widgets of this style share the result
+        UIStyleSheetPtr sheet = UIStyleSheet::compile(style);
+        if(sheet)
+            m_styleSheets[name] = sheet;
+        else
+            m_styleSheets.erase(name);
     }
 }
 
@@ -426,6 +437,106 @@ UIWidgetPtr UIManager::loadUI(std::string file, const UIWidgetPtr& parent)
     }
 }
 
+std::map<std::string, double> UIManager::benchmarkLoadUI(const std::string& file, int iterations)
+{
+    std::map<std::string, double> result;
+    iterations = std::max<int>(iterations, 1);
+
+    std::function<int(const UIWidgetPtr&)> countWidgets = [&](const UIWidgetPtr& widget) {
+        int count = 1;
+        for(const UIWidgetPtr& child : widget->getChildren())
+            count += countWidgets(child);
+        return count;
+    };
+
+    // each load parses the file, creates and styles the whole tree, then it is destroyed right away
+    int widgets = 0;
+    int loads = 0;
+    stdext::timer timer;
+    for(int i = 0; i < iterations; ++i) {
+        UIWidgetPtr widget = loadUI(file, m_rootWidget);
+        if(!widget)
+            break;
+        widgets += countWidgets(widget);
+        loads++;
+        widget->destroy();
+    }
+    double seconds = timer.elapsed_seconds();
+
+    result["loads"] = loads;
+    result["widgets"] = widgets;
+    result["seconds"] = seconds;
+    result["widgetsPerSecond"] = widgets / std::max<double>(seconds, 1e-6);
+    result["millisPerLoad"] = seconds * 1000.0 / std::max<int>(loads, 1);
+    return result;
+}
+
+std::map<std::string, double> UIManager::benchmarkAnchorLayout(int children)
+{
+    std::map<std::string, double> result;
+    children = std::max<int>(children, 1);
+
+    // a detached panel stacking rows like a console or a container list
+    UIWidgetPtr panel(new UIWidget);
+    panel->setRect(Rect(0, 0, 200, 200));
+
+    stdext::timer timer;
+    UIWidgetPtr middle, last;
+    for(int i = 0; i < children; ++i) {
+        UIWidgetPtr child(new UIWidget);
+        panel->addChild(child);
+        child->setId(stdext::format("row%d", i));
+        child->setHeight(14);
+        child->addAnchor(Fw::AnchorTop, i == 0 ? "parent" : "prev", i == 0 ? Fw::AnchorTop : Fw::AnchorBottom);
+        child->addAnchor(Fw::AnchorLeft, "parent", Fw::AnchorLeft);
+        child->addAnchor(Fw::AnchorRight, "parent", Fw::AnchorRight);
+        child->setMarginTop(1);
+        if(i == children / 2)
+            middle = child;
+        last = child;
+    }
+    result["addMillis"] = timer.elapsed_seconds() * 1000.0;
+
+    timer.restart();
+    panel->getLayout()->update();
+    result["flushMillis"] = timer.elapsed_seconds() * 1000.0;
+
+    // every row hooks the parent horizontally
+    timer.restart();
+    panel->setWidth(300);
+    result["resizeMillis"] = timer.elapsed_seconds() * 1000.0;
+
+    // only rows below the changed one move
+    timer.restart();
+    middle->setHeight(20);
+    panel->getLayout()->update();
+    result["changeMillis"] = timer.elapsed_seconds() * 1000.0;
+
+    result["children"] = children;
+    result["lastBottom"] = last->getRect().bottom();
+    result["lastWidth"] = last->getWidth();
+    panel->destroy();
+    return result;
+}
+
+std::map<std::string, double> UIManager::getRenderCacheStats()
+{
+    std::map<std::string, double> result;
+    result["caches"] = m_renderCaches;
+    result["hits"] = m_renderCacheHits;
+    result["renders"] = m_renderCacheRenders;
+    result["invalidations"] = m_renderCacheInvalidations;
+    result["hitRatio"] = m_renderCacheHits / std::max<double>(m_renderCacheHits + m_renderCacheRenders, 1);
+    return result;
+}
+
+void UIManager::resetRenderCacheStats()
+{
+    m_renderCacheHits = 0;
+    m_renderCacheRenders = 0;
+    m_renderCacheInvalidations = 0;
+}
+
 UIWidgetPtr UIManager::createWidget(const std::string& styleName, const UIWidgetPtr& parent)
 {
     OTMLNodePtr node = OTMLNode::create(styleName);
@@ -437,6 +548,16 @@ UIWidgetPtr UIManager::createWidget(const std::string& styleName, const UIWidget
     }
 }
 
+UIStyleSheetPtr UIManager::getStyleSheet(const OTMLNodePtr& style)
+{
+    auto it = m_styleSheets.find(style->tag());
+    if(it != m_styleSheets.end() && it->second->matches(style))
+        return it->second;
+
+    // widgets that override state selectors or the values they restore get their own
+    return UIStyleSheet::compile(style);
+}
+
 UIWidgetPtr UIManager::createWidgetFromOTML(const OTMLNodePtr& widgetNode, const UIWidgetPtr& parent)
 {
     OTMLNodePtr originalStyleNode = getStyle(widgetNode->tag());
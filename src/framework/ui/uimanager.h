@@ -47,6 +47,7 @@ public:
     bool importStyle(std::string file);
     void importStyleFromOTML(const OTMLNodePtr& styleNode);
     OTMLNodePtr getStyle(const std::string& styleName);
+    UIStyleSheetPtr getStyleSheet(const OTMLNodePtr& style);
     std::string getStyleClass(const std::string& styleName);
 
     UIWidgetPtr loadUI(std::string file, const UIWidgetPtr& parent);
@@ -54,6 +55,11 @@ public:
     UIWidgetPtr createWidget(const std::string& styleName, const UIWidgetPtr& parent);
     UIWidgetPtr createWidgetFromOTML(const OTMLNodePtr& widgetNode, const UIWidgetPtr& parent);
 
+    std::map<std::string, double> benchmarkLoadUI(const std::string& file, int iterations);
+    std::map<std::string, double> benchmarkAnchorLayout(int children);
+    std::map<std::string, double> getRenderCacheStats();
+    void resetRenderCacheStats();
+
     void setMouseReceiver(const UIWidgetPtr& widget) { m_mouseReceiver = widget; }
     void setKeyboardReceiver(const UIWidgetPtr& widget) { m_keyboardReceiver = widget; }
     void setDebugBoxesDrawing(bool enabled) { m_drawDebugBoxes = enabled; }
@@ -87,8 +93,13 @@ private:
     stdext::boolean<false> m_hoverUpdateScheduled;
     stdext::boolean<false> m_drawDebugBoxes;
     std::unordered_map<std::string, OTMLNodePtr> m_styles;
+    std::unordered_map<std::string, UIStyleSheetPtr> m_styleSheets;
     UIWidgetList m_destroyedWidgets;
     ScheduledEventPtr m_checkEvent;
+    int m_renderCaches;
+    int m_renderCacheHits;
+    int m_renderCacheRenders;
+    int m_renderCacheInvalidations;
 
 };
 
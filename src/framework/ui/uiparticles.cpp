@@ -30,6 +30,9 @@ UIParticles::UIParticles()
 
 void UIParticles::drawSelf(Fw::DrawPane drawPane)
 {
+    // particles move every frame, a cached parent has to keep redrawing
+    invalidateRenderCache();
+
     if(drawPane & Fw::ForegroundPane) {
         if(drawPane != Fw::BothPanes) {
             glDisable(GL_BLEND);
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "uistylesheet.h"
+#include "uitranslator.h"
+#include <framework/otml/otmlnode.h>
+
+UIStyleSheetPtr UIStyleSheet::compile(const OTMLNodePtr& style)
+{
+    UIStyleSheetPtr sheet;
+    for(const OTMLNodePtr& node : style->children()) {
+        if(!stdext::starts_with(node->tag(), "$"))
+            continue;
+
+        if(!sheet) {
+            sheet = UIStyleSheetPtr(new UIStyleSheet);
+            sheet->m_usedStates = 0;
+            sheet->m_dynamic = false;
+        }
+
+        Selector selector;
+        selector.tag = node->tag();
+        selector.onStates = 0;
+        selector.offStates = 0;
+        selector.node = node;
+        for(std::string stateStr : stdext::split(node->tag().substr(1), " ")) {
+            if(stateStr.length() == 0)
+                continue;
+
+            bool notstate = (stateStr[0] == '!');
+            if(notstate)
+                stateStr = stateStr.substr(1);
+
+            Fw::WidgetState state = Fw::translateState(stateStr);
+            if(state == Fw::InvalidState) {
+                g_logger.warning(stdext::format("%s: unknown widget state '%s'", node->source(), stateStr));
+                continue;
+            }
+            if(notstate)
+                selector.offStates |= state;
+            else
+                selector.onStates |= state;
+        }
+        sheet->m_usedStates |= selector.onStates | selector.offStates;
+
+        for(const OTMLNodePtr& property : node->children()) {
+            std::string tag = property->tag();
+            if(stdext::starts_with(tag, "!")) {
+                tag = tag.substr(1);
+                sheet->m_dynamic = true;
+            }
+            selector.properties.push_back(std::make_pair(sheet->propertyIndex(tag), property));
+        }
+        sheet->m_selectors.push_back(selector);
+    }
+
+    if(!sheet)
+        return nullptr;
+
+    // values restored once no selector sets the property anymore
+    for(const std::string& tag : sheet->m_properties) {
+        OTMLNodePtr base = style->get(tag);
+        if(!base && (base = style->get("!" + tag)))
+            sheet->m_dynamic = true;
+        sheet->m_base.push_back(base);
+    }
+    return sheet;
+}
+
+bool UIStyleSheet::matches(const OTMLNodePtr& style)
+{
+    size_t selectorIndex = 0;
+    for(const OTMLNodePtr& node : style->children()) {
+        if(!stdext::starts_with(node->tag(), "$"))
+            continue;
+        if(selectorIndex >= m_selectors.size() || !isSameNode(node, m_selectors[selectorIndex].node))
+            return false;
+        selectorIndex++;
+    }
+    if(selectorIndex != m_selectors.size())
+        return false;
+
+    for(size_t i = 0; i < m_properties.size(); ++i) {
+        OTMLNodePtr base = style->get(m_properties[i]);
+        if(!base)
+            base = style->get("!" + m_properties[i]);
+        if(!isSameNode(base, m_base[i]))
+            return false;
+    }
+    return true;
+}
+
+const OTMLNodePtr& UIStyleSheet::getTransition(int fromStates, int toStates)
+{
+    if(fromStates != Fw::InvalidState)
+        fromStates &= m_usedStates;
+    if(toStates != Fw::InvalidState)
+        toStates &= m_usedStates;
+
+    uint64 key = ((uint64)(uint32)fromStates << 32) | (uint32)toStates;
+    auto it = m_transitions.find(key);
+    if(it != m_transitions.end())
+        return it->second;
+
+    const std::vector<OTMLNodePtr>& from = resolve(fromStates);
+    const std::vector<OTMLNodePtr>& to = resolve(toStates);
+
+    // properties no longer set by any state and without a plain value keep what they had, as before
+    OTMLNodePtr transition = OTMLNode::create();
+    for(size_t i = 0; i < m_properties.size(); ++i) {
+        const OTMLNodePtr& node = to[i];
+        if(!node)
+            continue;
+        if(!stdext::starts_with(node->tag(), "!") && isSameNode(from[i], node))
+            continue;
+        transition->addChild(node->clone());
+    }
+    return m_transitions[key] = transition;
+}
+
+const std::vector<OTMLNodePtr>& UIStyleSheet::resolve(int states)
+{
+    auto it = m_resolved.find(states);
+    if(it != m_resolved.end())
+        return it->second;
+
+    // later selectors override earlier ones, the same order they are merged in
+    std::vector<OTMLNodePtr> properties = m_base;
+    if(states != Fw::InvalidState) {
+        for(const Selector& selector : m_selectors) {
+            if((states & selector.onStates) != selector.onStates || (states & selector.offStates) != 0)
+                continue;
+            for(const auto& property : selector.properties)
+                properties[property.first] = property.second;
+        }
+    }
+    return m_resolved[states] = properties;
+}
+
+int UIStyleSheet::propertyIndex(const std::string& tag)
+{
+    auto it = std::find(m_properties.begin(), m_properties.end(), tag);
+    if(it != m_properties.end())
+        return it - m_properties.begin();
+    m_properties.push_back(tag);
+    return m_properties.size() - 1;
+}
+
+bool UIStyleSheet::isSameNode(const OTMLNodePtr& a, const OTMLNodePtr& b)
+{
+    if(!a || !b)
+        return a == b;
+    if(a->tag() != b->tag() || a->rawValue() != b->rawValue() || a->size() != b->size())
+        return false;
+    for(int i = 0; i < a->size(); ++i) {
+        if(!isSameNode(a->getIndex(i), b->getIndex(i)))
+            return false;
+    }
+    return true;
+}
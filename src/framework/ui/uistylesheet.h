@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef UISTYLESHEET_H
+#define UISTYLESHEET_H
+
+#include "declarations.h"
+#include <framework/otml/declarations.h>
+
+// state selectors of a style ($hover, $!pressed on...) resolved once into state masks,
+// the properties to apply between two state combinations are built on first use and kept
+class UIStyleSheet : public stdext::shared_object
+{
+public:
+    // returns null when the style has no state selectors
+    static UIStyleSheetPtr compile(const OTMLNodePtr& style);
+
+    // whether a widget style has the same selectors and plain values, so it can share this sheet
+    bool matches(const OTMLNodePtr& style);
+
+    // properties that differ between the two state combinations, Fw::InvalidState is the plain style
+    const OTMLNodePtr& getTransition(int fromStates, int toStates);
+
+    int getUsedStates() { return m_usedStates; }
+    bool isDynamic() { return m_dynamic; }
+
+private:
+    struct Selector {
+        std::string tag;
+        int onStates;
+        int offStates;
+        OTMLNodePtr node;
+        std::vector<std::pair<int, OTMLNodePtr>> properties; // property index and node
+    };
+
+    const std::vector<OTMLNodePtr>& resolve(int states);
+    int propertyIndex(const std::string& tag);
+    static bool isSameNode(const OTMLNodePtr& a, const OTMLNodePtr& b);
+
+    std::vector<Selector> m_selectors;
+    std::vector<std::string> m_properties; // tags without the ! expression prefix
+    std::vector<OTMLNodePtr> m_base;
+    std::unordered_map<int, std::vector<OTMLNodePtr>> m_resolved;
+    std::unordered_map<uint64, OTMLNodePtr> m_transitions;
+    int m_usedStates;
+    bool m_dynamic;
+};
+
+#endif
@@ -102,6 +102,9 @@ void UITextEdit::drawSelf(Fw::DrawPane drawPane)
         // draw every 333ms
         const int delay = 333;
         int elapsed = g_clock.millis() - m_cursorTicks;
+
+        // the blinking cursor keeps a cached parent redrawing
+        invalidateRenderCache();
         if(elapsed <= delay) {
             Rect cursorRect;
             // when cursor is at 0
@@ -332,6 +335,7 @@ void UITextEdit::update(bool focusCursor)
     if(fireAreaUpdate)
         onTextAreaUpdate(m_textVirtualOffset, m_textVirtualSize, m_textTotalSize);
 
+    invalidateRenderCache();
     g_app.repaint();
 }
 
@@ -455,6 +459,7 @@ void UITextEdit::removeCharacter(bool right)
 void UITextEdit::blinkCursor()
 {
     m_cursorTicks = g_clock.millis();
+    invalidateRenderCache();
     g_app.repaint();
 }
 
@@ -28,10 +28,111 @@
 
 namespace Fw {
 
+enum StyleProperty {
+    StyleUnknown = 0,
+    StyleColor,
+    StyleX,
+    StyleY,
+    StylePos,
+    StyleWidth,
+    StyleHeight,
+    StyleRect,
+    StyleBackground,
+    StyleBackgroundColor,
+    StyleBackgroundOffsetX,
+    StyleBackgroundOffsetY,
+    StyleBackgroundOffset,
+    StyleBackgroundWidth,
+    StyleBackgroundHeight,
+    StyleBackgroundSize,
+    StyleBackgroundRect,
+    StyleIcon,
+    StyleIconSource,
+    StyleIconColor,
+    StyleIconOffsetX,
+    StyleIconOffsetY,
+    StyleIconOffset,
+    StyleIconWidth,
+    StyleIconHeight,
+    StyleIconSize,
+    StyleIconRect,
+    StyleIconClip,
+    StyleIconAlign,
+    StyleOpacity,
+    StyleRotation,
+    StyleRenderCache,
+    StyleEnabled,
+    StyleVisible,
+    StyleChecked,
+    StyleDraggable,
+    StyleOn,
+    StyleFocusable,
+    StyleAutoFocus,
+    StylePhantom,
+    StyleSize,
+    StyleFixedSize,
+    StyleClipping,
+    StyleBorder,
+    StyleBorderWidth,
+    StyleBorderWidthTop,
+    StyleBorderWidthRight,
+    StyleBorderWidthBottom,
+    StyleBorderWidthLeft,
+    StyleBorderColor,
+    StyleBorderColorTop,
+    StyleBorderColorRight,
+    StyleBorderColorBottom,
+    StyleBorderColorLeft,
+    StyleMarginTop,
+    StyleMarginRight,
+    StyleMarginBottom,
+    StyleMarginLeft,
+    StyleMargin,
+    StylePaddingTop,
+    StylePaddingRight,
+    StylePaddingBottom,
+    StylePaddingLeft,
+    StylePadding,
+    StyleLayout,
+    StyleText,
+    StyleTextAlign,
+    StyleTextOffset,
+    StyleTextWrap,
+    StyleTextAutoResize,
+    StyleTextHorizontalAutoResize,
+    StyleTextVerticalAutoResize,
+    StyleTextOnlyUpperCase,
+    StyleFont,
+    StyleImageSource,
+    StyleImageOffsetX,
+    StyleImageOffsetY,
+    StyleImageOffset,
+    StyleImageWidth,
+    StyleImageHeight,
+    StyleImageSize,
+    StyleImageRect,
+    StyleImageClip,
+    StyleImageFixedRatio,
+    StyleImageRepeated,
+    StyleImageSmooth,
+    StyleImageColor,
+    StyleImageBorderTop,
+    StyleImageBorderRight,
+    StyleImageBorderBottom,
+    StyleImageBorderLeft,
+    StyleImageBorder,
+    StyleImageAutoResize,
+    StyleLuaFunction, // @name
+    StyleLuaField, // &name
+    StyleAnchor, // anchors.edge
+    LastStyleProperty
+};
+
 AlignmentFlag translateAlignment(std::string aligment);
 AnchorEdge translateAnchorEdge(std::string anchorEdge);
 WidgetState translateState(std::string state);
 AutoFocusPolicy translateAutoFocusPolicy(std::string policy);
+StyleProperty translateStyleProperty(int tagId, const std::string& tag);
 
 };
 
@@ -0,0 +1,475 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "uivirtuallist.h"
+#include "uimanager.h"
+#include <framework/core/eventdispatcher.h>
+#include <framework/otml/otmlnode.h>
+
+UIVirtualList::UIVirtualList()
+{
+    m_validOffsets = 0;
+    m_contentHeight = 0;
+    m_notifiedContentHeight = 0;
+    m_rowHeight = 14;
+    m_rowSpacing = 0;
+    m_scrollOffset = 0;
+    m_offsets.push_back(0);
+    setClipping(true);
+}
+
+int UIVirtualList::addItem(const std::string& text, int height)
+{
+    bool stickToEnd = m_autoScroll && isScrolledToEnd();
+    m_items.push_back(Item{text, height});
+    scheduleRowsUpdate();
+    if(stickToEnd)
+        setScrollOffset(getMaxScrollOffset());
+    return m_items.size() - 1;
+}
+
+void UIVirtualList::insertItem(int index, const std::string& text, int height)
+{
+    if(index < 0 || index > (int)m_items.size()) {
+        g_logger.traceError(stdext::format("invalid virtual list index %d", index));
+        return;
+    }
+
+    if(index == (int)m_items.size()) {
+        addItem(text, height);
+        return;
+    }
+
+    m_items.insert(m_items.begin() + index, Item{text, height});
+    invalidateOffsets(index);
+    shiftRows(index, 1);
+    scheduleRowsUpdate();
+}
+
+void UIVirtualList::removeItem(int index)
+{
+    if(!isValidIndex(index)) {
+        g_logger.traceError(stdext::format("invalid virtual list index %d", index));
+        return;
+    }
+
+    auto it = m_rows.find(index);
+    if(it != m_rows.end()) {
+        releaseRow(it->second);
+        m_rows.erase(it);
+    }
+
+    m_items.erase(m_items.begin() + index);
+    invalidateOffsets(index);
+    shiftRows(index + 1, -1);
+    scheduleRowsUpdate();
+}
+
+void UIVirtualList::removeFirstItems(int count)
+{
+    count = std::min<int>(count, m_items.size());
+    if(count <= 0)
+        return;
+
+    // keep the view on the same items while old ones are trimmed, like a console history
+    updateOffsets();
+    int removedHeight = m_offsets[count];
+
+    for(auto it = m_rows.begin(); it != m_rows.end() && it->first < count;) {
+        releaseRow(it->second);
+        it = m_rows.erase(it);
+    }
+
+    m_items.erase(m_items.begin(), m_items.begin() + count);
+    invalidateOffsets(0);
+    shiftRows(count, -count);
+    setScrollOffset(m_scrollOffset - removedHeight);
+    scheduleRowsUpdate();
+}
+
+void UIVirtualList::clearItems()
+{
+    for(auto& it : m_rows)
+        releaseRow(it.second);
+    m_rows.clear();
+    m_items.clear();
+    invalidateOffsets(0);
+    setScrollOffset(0);
+    scheduleRowsUpdate();
+}
+
+void UIVirtualList::setItemText(int index, const std::string& text)
+{
+    if(!isValidIndex(index))
+        return;
+
+    m_items[index].text = text;
+    refreshItem(index);
+}
+
+void UIVirtualList::setItemHeight(int index, int height)
+{
+    if(!isValidIndex(index) || m_items[index].height == height)
+        return;
+
+    m_items[index].height = height;
+    invalidateOffsets(index);
+    scheduleRowsUpdate();
+}
+
+void UIVirtualList::refreshItem(int index)
+{
+    auto it = m_rows.find(index);
+    if(it != m_rows.end())
+        bindRow(it->second, index);
+}
+
+void UIVirtualList::refreshItems()
+{
+    for(auto& it : m_rows)
+        bindRow(it.second, it.first);
+}
+
+void UIVirtualList::setRowStyle(const std::string& rowStyle)
+{
+    if(m_rowStyle == rowStyle)
+        return;
+
+    m_rowStyle = rowStyle;
+    destroyRows();
+
+    // rows without an explicit height take it from their style
+    OTMLNodePtr styleNode = g_ui.getStyle(rowStyle);
+    if(styleNode) {
+        int height = styleNode->valueAt<int>("height", 0);
+        if(height > 0)
+            setRowHeight(height);
+    }
+    scheduleRowsUpdate();
+}
+
+void UIVirtualList::setRowHeight(int height)
+{
+    if(height <= 0 || m_rowHeight == height)
+        return;
+
+    m_rowHeight = height;
+    invalidateOffsets(0);
+    scheduleRowsUpdate();
+}
+
+void UIVirtualList::setRowSpacing(int spacing)
+{
+    if(m_rowSpacing == spacing)
+        return;
+
+    m_rowSpacing = spacing;
+    invalidateOffsets(0);
+    scheduleRowsUpdate();
+}
+
+void UIVirtualList::setScrollOffset(int offset)
+{
+    offset = std::max<int>(std::min<int>(offset, getMaxScrollOffset()), 0);
+    if(m_scrollOffset == offset)
+        return;
+
+    m_scrollOffset = offset;
+    scheduleRowsUpdate();
+    callLuaField("onScrollChange", offset);
+}
+
+void UIVirtualList::scrollToIndex(int index)
+{
+    if(!isValidIndex(index))
+        return;
+
+    updateOffsets();
+    setScrollOffset(m_offsets[index]);
+}
+
+void UIVirtualList::ensureIndexVisible(int index)
+{
+    if(!isValidIndex(index))
+        return;
+
+    updateOffsets();
+    int top = m_offsets[index];
+    int bottom = top + itemHeight(m_items[index]);
+    int viewHeight = getPaddingRect().height();
+    if(top < m_scrollOffset)
+        setScrollOffset(top);
+    else if(bottom > m_scrollOffset + viewHeight)
+        setScrollOffset(bottom - viewHeight);
+}
+
+std::string UIVirtualList::getItemText(int index)
+{
+    if(!isValidIndex(index))
+        return std::string();
+    return m_items[index].text;
+}
+
+int UIVirtualList::getItemHeight(int index)
+{
+    if(!isValidIndex(index))
+        return 0;
+    return itemHeight(m_items[index]);
+}
+
+int UIVirtualList::getItemIndexAt(const Point& point)
+{
+    Rect paddingRect = getPaddingRect();
+    if(m_items.empty() || !paddingRect.contains(point))
+        return -1;
+
+    int offset = m_scrollOffset + point.y - paddingRect.top();
+    int index = indexAtOffset(offset);
+    if(offset >= m_offsets[index] + itemHeight(m_items[index]))
+        return -1;
+    return index;
+}
+
+UIWidgetPtr UIVirtualList::getRowWidget(int index)
+{
+    auto it = m_rows.find(index);
+    if(it != m_rows.end())
+        return it->second;
+    return nullptr;
+}
+
+int UIVirtualList::getMaxScrollOffset()
+{
+    return std::max<int>(getContentHeight() - getPaddingRect().height(), 0);
+}
+
+int UIVirtualList::getContentHeight()
+{
+    updateOffsets();
+    return m_contentHeight;
+}
+
+int UIVirtualList::getFirstVisibleIndex()
+{
+    if(m_items.empty())
+        return -1;
+    return indexAtOffset(m_scrollOffset);
+}
+
+int UIVirtualList::getLastVisibleIndex()
+{
+    if(m_items.empty())
+        return -1;
+    return indexAtOffset(m_scrollOffset + std::max<int>(getPaddingRect().height(), 1) - 1);
+}
+
+void UIVirtualList::onStyleApply(const std::string& styleName, const OTMLNodePtr& styleNode)
+{
+    UIWidget::onStyleApply(styleName, styleNode);
+
+    for(const OTMLNodePtr& node : styleNode->children()) {
+        if(node->tag() == "row-style")
+            setRowStyle(node->value());
+        else if(node->tag() == "row-height")
+            setRowHeight(node->value<int>());
+        else if(node->tag() == "row-spacing")
+            setRowSpacing(node->value<int>());
+        else if(node->tag() == "auto-scroll")
+            setAutoScroll(node->value<bool>());
+    }
+}
+
+void UIVirtualList::onGeometryChange(const Rect& oldRect, const Rect& newRect)
+{
+    UIWidget::onGeometryChange(oldRect, newRect);
+
+    // the base class binds children inside the padding rect, rows must be placed again
+    updateRows();
+}
+
+bool UIVirtualList::onMouseWheel(const Point& mousePos, Fw::MouseWheelDirection direction)
+{
+    if(UIWidget::onMouseWheel(mousePos, direction))
+        return true;
+
+    int oldOffset = m_scrollOffset;
+    int step = 3 * (m_rowHeight + m_rowSpacing);
+    setScrollOffset(m_scrollOffset + (direction == Fw::MouseWheelUp ? -step : step));
+    return m_scrollOffset != oldOffset;
+}
+
+int UIVirtualList::indexAtOffset(int offset)
+{
+    updateOffsets();
+
+    // first item whose bottom edge is past the offset
+    auto it = std::upper_bound(m_offsets.begin() + 1, m_offsets.end(), offset);
+    int index = it - (m_offsets.begin() + 1);
+    return std::max<int>(std::min<int>(index, m_items.size() - 1), 0);
+}
+
+bool UIVirtualList::isScrolledToEnd()
+{
+    return m_scrollOffset >= getMaxScrollOffset();
+}
+
+void UIVirtualList::invalidateOffsets(int fromIndex)
+{
+    m_validOffsets = std::min<int>(m_validOffsets, fromIndex);
+}
+
+void UIVirtualList::updateOffsets()
+{
+    // m_offsets[i] is the top of item i and m_offsets[size] the total height, appends only compute the tail
+    int count = m_items.size();
+    int valid = std::min<int>(m_validOffsets, count);
+    m_offsets.resize(count + 1);
+    for(int i = valid; i < count; ++i)
+        m_offsets[i + 1] = m_offsets[i] + itemHeight(m_items[i]) + m_rowSpacing;
+    m_validOffsets = count;
+    m_contentHeight = count > 0 ? m_offsets[count] - m_rowSpacing : 0;
+}
+
+void UIVirtualList::shiftRows(int fromIndex, int delta)
+{
+    // keep bindings of rows whose items just moved, they still show the same data
+    std::map<int, UIWidgetPtr> rows;
+    for(auto& it : m_rows)
+        rows[it.first >= fromIndex ? it.first + delta : it.first] = it.second;
+    m_rows.swap(rows);
+}
+
+void UIVirtualList::releaseRow(const UIWidgetPtr& row)
+{
+    row->setVisible(false);
+    m_rowPool.push_back(row);
+}
+
+UIWidgetPtr UIVirtualList::acquireRow()
+{
+    if(!m_rowPool.empty()) {
+        UIWidgetPtr row = m_rowPool.back();
+        m_rowPool.pop_back();
+        return row;
+    }
+
+    UIWidgetPtr self = static_self_cast<UIWidget>();
+    UIWidgetPtr row;
+    if(m_rowStyle.empty()) {
+        row = UIWidgetPtr(new UIWidget);
+        addChild(row);
+    } else
+        row = g_ui.createWidget(m_rowStyle, self);
+
+    if(row)
+        callLuaField("onCreateRow", row);
+    return row;
+}
+
+void UIVirtualList::bindRow(const UIWidgetPtr& row, int index)
+{
+    const Item& item = m_items[index];
+    if(!callLuaField<bool>("onBindRow", row, index, item.text))
+        row->setText(item.text);
+}
+
+void UIVirtualList::destroyRows()
+{
+    for(auto& it : m_rows)
+        it.second->destroy();
+    for(const UIWidgetPtr& row : m_rowPool)
+        row->destroy();
+    m_rows.clear();
+    m_rowPool.clear();
+}
+
+void UIVirtualList::scheduleRowsUpdate()
+{
+    if(m_updateScheduled)
+        return;
+
+    // coalesce model changes done in the same frame into a single rows update
+    auto self = static_self_cast<UIVirtualList>();
+    g_dispatcher.addEvent([self] {
+        self->m_updateScheduled = false;
+        self->updateRows();
+    });
+    m_updateScheduled = true;
+}
+
+void UIVirtualList::updateRows()
+{
+    if(isDestroyed())
+        return;
+
+    updateOffsets();
+    int scrollOffset = std::max<int>(std::min<int>(m_scrollOffset, getMaxScrollOffset()), 0);
+    if(scrollOffset != m_scrollOffset) {
+        m_scrollOffset = scrollOffset;
+        callLuaField("onScrollChange", scrollOffset);
+    }
+
+    Rect paddingRect = getPaddingRect();
+    int first = 0, last = -1;
+    if(!m_items.empty() && paddingRect.height() > 0) {
+        first = indexAtOffset(m_scrollOffset);
+        last = indexAtOffset(m_scrollOffset + paddingRect.height() - 1);
+    }
+
+    // recycle rows that left the view
+    for(auto it = m_rows.begin(); it != m_rows.end();) {
+        if(it->first < first || it->first > last) {
+            releaseRow(it->second);
+            it = m_rows.erase(it);
+        } else
+            ++it;
+    }
+
+    for(int i = first; i <= last; ++i) {
+        UIWidgetPtr row;
+        auto it = m_rows.find(i);
+        if(it != m_rows.end())
+            row = it->second;
+        else {
+            row = acquireRow();
+            if(!row)
+                break;
+            m_rows[i] = row;
+            bindRow(row, i);
+        }
+
+        row->setRect(Rect(paddingRect.left(), paddingRect.top() + m_offsets[i] - m_scrollOffset,
+                          paddingRect.width(), itemHeight(m_items[i])));
+        row->setVisible(true);
+    }
+
+    // keep a spare row per visible one, anything beyond was left by a bigger view
+    while(m_rowPool.size() > std::max<size_t>(m_rows.size(), 1)) {
+        m_rowPool.back()->destroy();
+        m_rowPool.pop_back();
+    }
+
+    if(m_notifiedContentHeight != m_contentHeight) {
+        m_notifiedContentHeight = m_contentHeight;
+        callLuaField("onContentHeightChange", m_contentHeight);
+    }
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef UIVIRTUALLIST_H
+#define UIVIRTUALLIST_H
+
+#include "uiwidget.h"
+
+// @bindclass
+class UIVirtualList : public UIWidget
+{
+    struct Item {
+        std::string text;
+        int height;
+    };
+
+public:
+    UIVirtualList();
+
+    int addItem(const std::string& text, int height = 0);
+    void insertItem(int index, const std::string& text, int height = 0);
+    void removeItem(int index);
+    void removeFirstItems(int count);
+    void clearItems();
+    void setItemText(int index, const std::string& text);
+    void setItemHeight(int index, int height);
+    void refreshItem(int index);
+    void refreshItems();
+
+    void setRowStyle(const std::string& rowStyle);
+    void setRowHeight(int height);
+    void setRowSpacing(int spacing);
+    void setScrollOffset(int offset);
+    void setAutoScroll(bool autoScroll) { m_autoScroll = autoScroll; }
+    void scrollToIndex(int index);
+    void ensureIndexVisible(int index);
+
+    std::string getItemText(int index);
+    int getItemHeight(int index);
+    int getItemCount() { return m_items.size(); }
+    int getItemIndexAt(const Point& point);
+    UIWidgetPtr getRowWidget(int index);
+    std::string getRowStyle() { return m_rowStyle; }
+    int getRowHeight() { return m_rowHeight; }
+    int getRowSpacing() { return m_rowSpacing; }
+    int getScrollOffset() { return m_scrollOffset; }
+    int getMaxScrollOffset();
+    int getContentHeight();
+    int getFirstVisibleIndex();
+    int getLastVisibleIndex();
+    bool isAutoScroll() { return m_autoScroll; }
+
+protected:
+    void onStyleApply(const std::string& styleName, const OTMLNodePtr& styleNode);
+    void onGeometryChange(const Rect& oldRect, const Rect& newRect);
+    bool onMouseWheel(const Point& mousePos, Fw::MouseWheelDirection direction);
+
+private:
+    bool isValidIndex(int index) { return index >= 0 && index < (int)m_items.size(); }
+    int itemHeight(const Item& item) { return item.height > 0 ? item.height : m_rowHeight; }
+    int indexAtOffset(int offset);
+    bool isScrolledToEnd();
+    void invalidateOffsets(int fromIndex);
+    void updateOffsets();
+    void shiftRows(int fromIndex, int delta);
+    void releaseRow(const UIWidgetPtr& row);
+    UIWidgetPtr acquireRow();
+    void bindRow(const UIWidgetPtr& row, int index);
+    void destroyRows();
+    void scheduleRowsUpdate();
+    void updateRows();
+
+    std::deque<Item> m_items;
+    std::vector<int> m_offsets;
+    int m_validOffsets;
+    int m_contentHeight;
+    int m_notifiedContentHeight;
+    std::map<int, UIWidgetPtr> m_rows;
+    std::vector<UIWidgetPtr> m_rowPool;
+    std::string m_rowStyle;
+    int m_rowHeight;
+    int m_rowSpacing;
+    int m_scrollOffset;
+    stdext::boolean<false> m_autoScroll;
+    stdext::boolean<false> m_updateScheduled;
+};
+
+#endif
@@ -24,6 +24,7 @@
 #include "uimanager.h"
 #include "uianchorlayout.h"
 #include "uitranslator.h"
+#include "uistylesheet.h"
 
 #include <framework/core/eventdispatcher.h>
 #include <framework/otml/otmlnode.h>
@@ -37,6 +38,7 @@ UIWidget::UIWidget()
 {
     m_lastFocusReason = Fw::ActiveFocusReason;
     m_states = Fw::DefaultState;
+    m_appliedStates = Fw::InvalidState;
     m_autoFocusPolicy = Fw::AutoFocusLast;
     m_clickTimer.stop();
     m_autoRepeatDelay = 500;
@@ -57,6 +59,14 @@ UIWidget::~UIWidget()
 
 void UIWidget::draw(const Rect& visibleRect, Fw::DrawPane drawPane)
 {
+    if(m_renderCache && (drawPane & Fw::ForegroundPane) && !m_renderCacheDrawing && g_graphics.canUseFBO()) {
+        // only the foreground pane is cached, the background pane is still drawn live
+        if(drawPane & Fw::BackgroundPane)
+            draw(visibleRect, Fw::BackgroundPane);
+        drawRenderCache(visibleRect);
+        return;
+    }
+
     Rect oldClipRect;
     if(m_clipping) {
         oldClipRect = g_painter->getClipRect();
@@ -173,6 +183,7 @@ void UIWidget::addChild(const UIWidgetPtr& child)
         oldLastChild->updateState(Fw::LastState);
     }
 
+    invalidateRenderCache();
     g_ui.onWidgetAppear(child);
 }
 
@@ -211,6 +222,7 @@ void UIWidget::insertChild(int index, const UIWidgetPtr& child)
     child->updateStates();
     updateChildrenIndexStates();
 
+    invalidateRenderCache();
     g_ui.onWidgetAppear(child);
 }
 
@@ -244,6 +256,7 @@ void UIWidget::removeChild(UIWidgetPtr child)
         if(m_autoFocusPolicy != Fw::AutoFocusNone && focusAnother && !m_focusedChild)
             focusPreviousChild(Fw::ActiveFocusReason, true);
 
+        invalidateRenderCache();
         g_ui.onWidgetDisappear(child);
     } else
         g_logger.traceError("attempt to remove an unknown child from a UIWidget");
@@ -389,6 +402,9 @@ void UIWidget::lowerChild(UIWidgetPtr child)
     m_children.erase(it);
     m_children.push_front(child);
     updateChildrenIndexStates();
+    invalidateRenderCache();
+    if(m_layout)
+        m_layout->updateWidgetHooks(child);
 }
 
 void UIWidget::raiseChild(UIWidgetPtr child)
@@ -408,6 +424,9 @@ void UIWidget::raiseChild(UIWidgetPtr child)
     m_children.erase(it);
     m_children.push_back(child);
     updateChildrenIndexStates();
+    invalidateRenderCache();
+    if(m_layout)
+        m_layout->updateWidgetHooks(child);
 }
 
 void UIWidget::moveChildToIndex(const UIWidgetPtr& child, int index)
@@ -432,6 +451,9 @@ void UIWidget::moveChildToIndex(const UIWidgetPtr& child, int index)
     m_children.erase(it);
     m_children.insert(m_children.begin() + index - 1, child);
     updateChildrenIndexStates();
+    invalidateRenderCache();
+    if(m_layout)
+        m_layout->updateWidgetHooks(child);
     updateLayout();
 }
 
@@ -520,6 +542,7 @@ void UIWidget::mergeStyle(const OTMLNodePtr& styleNode)
     m_style->merge(styleNode);
     m_style->setTag(name);
     m_style->setSource(source);
+    updateStyleSheet();
     updateStyle();
 }
 
@@ -622,9 +645,17 @@ void UIWidget::updateParentLayout()
     if(m_destroyed)
         return;
 
-    if(UIWidgetPtr parent = getParent())
-        parent->updateLayout();
-    else
+    if(UIWidgetPtr parent = getParent()) {
+        // only this widget changed, the parent geometry is the same
+        if(UILayoutPtr parentLayout = parent->getLayout()) {
+            parentLayout->invalidateWidget(static_self_cast<UIWidget>());
+            parentLayout->update();
+        }
+
+        if(UIWidgetPtr grandParent = parent->getParent())
+            if(UILayoutPtr grandParentLayout = grandParent->getLayout())
+                grandParentLayout->updateLater();
+    } else
         updateLayout();
 }
 
@@ -633,13 +664,18 @@ void UIWidget::updateLayout()
     if(m_destroyed)
         return;
 
-    if(m_layout)
+    if(m_layout) {
+        m_layout->invalidateWidget(static_self_cast<UIWidget>());
         m_layout->update();
+    }
 
     // children can affect the parent layout
-    if(UIWidgetPtr parent = getParent())
-        if(UILayoutPtr parentLayout = parent->getLayout())
+    if(UIWidgetPtr parent = getParent()) {
+        if(UILayoutPtr parentLayout = parent->getLayout()) {
+            parentLayout->invalidateWidget(static_self_cast<UIWidget>());
             parentLayout->updateLater();
+        }
+    }
 }
 
 void UIWidget::lock()
@@ -749,6 +785,7 @@ void UIWidget::bindRectToParent()
 
 void UIWidget::internalDestroy()
 {
+    setRenderCache(false);
     m_destroyed = true;
     m_visible = false;
     m_enabled = false;
@@ -810,6 +847,12 @@ void UIWidget::setId(const std::string& id)
 {
     if(id != m_id) {
         m_id = id;
+
+        // anchors can refer to siblings by id
+        if(UIWidgetPtr parent = getParent())
+            if(UILayoutPtr parentLayout = parent->getLayout())
+                parentLayout->updateWidgetHooks(static_self_cast<UIWidget>());
+
         callLuaField("onIdChange", id);
     }
 }
@@ -881,6 +924,7 @@ bool UIWidget::setRect(const Rect& rect)
         return false;
 
     m_rect = rect;
+    invalidateRenderCache();
 
     // updates own layout
     updateLayout();
@@ -913,6 +957,7 @@ void UIWidget::setStyle(const std::string& styleName)
     styleNode = styleNode->clone();
     applyStyle(styleNode);
     m_style = styleNode;
+    updateStyleSheet();
     updateStyle();
 }
 
@@ -920,6 +965,7 @@ void UIWidget::setStyleFromNode(const OTMLNodePtr& styleNode)
 {
     applyStyle(styleNode);
     m_style = styleNode;
+    updateStyleSheet();
     updateStyle();
 }
 
@@ -949,6 +995,7 @@ void UIWidget::setVisible(bool visible)
 
         updateState(Fw::ActiveState);
         updateState(Fw::HiddenState);
+        invalidateRenderCache();
 
         // visibility can change the current hovered widget
         if(visible)
@@ -1014,8 +1061,10 @@ void UIWidget::setAutoFocusPolicy(Fw::AutoFocusPolicy policy)
 void UIWidget::setVirtualOffset(const Point& offset)
 {
     m_virtualOffset = offset;
-    if(m_layout)
+    if(m_layout) {
+        m_layout->invalidateWidget(static_self_cast<UIWidget>());
         m_layout->update();
+    }
 }
 
 bool UIWidget::isAnchored()
@@ -1412,50 +1461,29 @@ void UIWidget::updateStyle()
         return;
     }
 
-    if(!m_style)
+    if(!m_style || !m_styleSheet)
         return;
 
-    OTMLNodePtr newStateStyle = OTMLNode::create();
-
-    // copy only the changed styles from default style
-    if(m_stateStyle) {
-        for(OTMLNodePtr node : m_stateStyle->children()) {
-            if(OTMLNodePtr otherNode = m_style->get(node->tag()))
-                newStateStyle->addChild(otherNode->clone());
-        }
-    }
-
-    // checks for states combination
-    for(const OTMLNodePtr& style : m_style->children()) {
-        if(stdext::starts_with(style->tag(), "$")) {
-            std::string statesStr = style->tag().substr(1);
-            std::vector<std::string> statesSplit = stdext::split(statesStr, " ");
-
-            bool match = true;
-            for(std::string stateStr : statesSplit) {
-                if(stateStr.length() == 0)
-                    continue;
-
-                bool notstate = (stateStr[0] == '!');
-                if(notstate)
-                    stateStr = stateStr.substr(1);
-
-                bool stateOn = hasState(Fw::translateState(stateStr));
-                if((!notstate && !stateOn) || (notstate && stateOn))
-                    match = false;
-            }
+    // only the properties that differ from the last applied states are set again
+    int states = m_states & m_styleSheet->getUsedStates();
+    if(states == m_appliedStates)
+        return;
 
-            // merge states styles
-            if(match) {
-                newStateStyle->merge(style);
-            }
-        }
-    }
+    UIStyleSheetPtr styleSheet = m_styleSheet;
+    OTMLNodePtr transition = styleSheet->getTransition(m_appliedStates, states);
+    m_appliedStates = states;
+    if(transition->size() == 0)
+        return;
 
-    //TODO: prevent setting already set proprieties
+    // ! expressions are translated in place by applyStyle, they must be evaluated on every change
+    applyStyle(styleSheet->isDynamic() ? transition->clone() : transition);
+}
 
-    applyStyle(newStateStyle);
-    m_stateStyle = newStateStyle;
+void UIWidget::updateStyleSheet()
+{
+    // the whole style was just applied, the next update starts from its plain values
+    m_styleSheet = g_ui.getStyleSheet(m_style);
+    m_appliedStates = Fw::InvalidState;
 }
 
 void UIWidget::onStyleApply(const std::string& styleName, const OTMLNodePtr& styleNode)
@@ -1471,6 +1499,7 @@ void UIWidget::onStyleApply(const std::string& styleName, const OTMLNodePtr& sty
     parseImageStyle(styleNode);
     parseTextStyle(styleNode);
 
+    invalidateRenderCache();
     g_app.repaint();
 }
 
@@ -1487,6 +1516,7 @@ void UIWidget::onGeometryChange(const Rect& oldRect, const Rect& newRect)
 
     callLuaField("onGeometryChange", oldRect, newRect);
 
+    invalidateRenderCache();
     g_app.repaint();
 }
 
@@ -50,8 +50,9 @@ void UIWidget::parseBaseStyle(const OTMLNodePtr& styleNode)
 {
     // parse lua variables and callbacks first
     for(const OTMLNodePtr& node : styleNode->children()) {
+        Fw::StyleProperty property = Fw::translateStyleProperty(node->tagId(), node->tag());
         // lua functions
-        if(stdext::starts_with(node->tag(), "@")) {
+        if(property == Fw::StyleLuaFunction) {
             // load once
             if(m_firstOnStyle) {
                 std::string funcName = node->tag().substr(1);
@@ -60,7 +61,7 @@ void UIWidget::parseBaseStyle(const OTMLNodePtr& styleNode)
                 luaSetField(funcName);
             }
         // lua fields value
-        } else if(stdext::starts_with(node->tag(), "&")) {
+        } else if(property == Fw::StyleLuaField) {
             std::string fieldName = node->tag().substr(1);
             std::string fieldOrigin = "@" + node->source() + ": [" + node->tag() + "]";
 
@@ -70,265 +71,334 @@ void UIWidget::parseBaseStyle(const OTMLNodePtr& styleNode)
     }
     // load styles used by all widgets
     for(const OTMLNodePtr& node : styleNode->children()) {
-        if(node->tag() == "color")
-            setColor(node->value<Color>());
-        else if(node->tag() == "x")
-            setX(node->value<int>());
-        else if(node->tag() == "y")
-            setY(node->value<int>());
-        else if(node->tag() == "pos")
-            setPosition(node->value<Point>());
-        else if(node->tag() == "width")
-            setWidth(node->value<int>());
-        else if(node->tag() == "height")
-            setHeight(node->value<int>());
-        else if(node->tag() == "rect")
-            setRect(node->value<Rect>());
-        else if(node->tag() == "background")
-            setBackgroundColor(node->value<Color>());
-        else if(node->tag() == "background-color")
-            setBackgroundColor(node->value<Color>());
-        else if(node->tag() == "background-offset-x")
-            setBackgroundOffsetX(node->value<int>());
-        else if(node->tag() == "background-offset-y")
-            setBackgroundOffsetY(node->value<int>());
-        else if(node->tag() == "background-offset")
-            setBackgroundOffset(node->value<Point>());
-        else if(node->tag() == "background-width")
-            setBackgroundWidth(node->value<int>());
-        else if(node->tag() == "background-height")
-            setBackgroundHeight(node->value<int>());
-        else if(node->tag() == "background-size")
-            setBackgroundSize(node->value<Size>());
-        else if(node->tag() == "background-rect")
-            setBackgroundRect(node->value<Rect>());
-        else if(node->tag() == "icon")
-            setIcon(stdext::resolve_path(node->value(), node->source()));
-        else if(node->tag() == "icon-source")
-            setIcon(stdext::resolve_path(node->value(), node->source()));
-        else if(node->tag() == "icon-color")
-            setIconColor(node->value<Color>());
-        else if(node->tag() == "icon-offset-x")
-            setIconOffsetX(node->value<int>());
-        else if(node->tag() == "icon-offset-y")
-            setIconOffsetY(node->value<int>());
-        else if(node->tag() == "icon-offset")
-            setIconOffset(node->value<Point>());
-        else if(node->tag() == "icon-width")
-            setIconWidth(node->value<int>());
-        else if(node->tag() == "icon-height")
-            setIconHeight(node->value<int>());
-        else if(node->tag() == "icon-size")
-            setIconSize(node->value<Size>());
-        else if(node->tag() == "icon-rect")
-            setIconRect(node->value<Rect>());
-        else if(node->tag() == "icon-clip")
-            setIconClip(node->value<Rect>());
-        else if(node->tag() == "icon-align")
-            setIconAlign(Fw::translateAlignment(node->value()));
-        else if(node->tag() == "opacity")
-            setOpacity(node->value<float>());
-        else if(node->tag() == "rotation")
-            setRotation(node->value<float>());
-        else if(node->tag() == "enabled")
-            setEnabled(node->value<bool>());
-        else if(node->tag() == "visible")
-            setVisible(node->value<bool>());
-        else if(node->tag() == "checked")
-            setChecked(node->value<bool>());
-        else if(node->tag() == "draggable")
-            setDraggable(node->value<bool>());
-        else if(node->tag() == "on")
-            setOn(node->value<bool>());
-        else if(node->tag() == "focusable")
-            setFocusable(node->value<bool>());
-        else if(node->tag() == "auto-focus")
-            setAutoFocusPolicy(Fw::translateAutoFocusPolicy(node->value()));
-        else if(node->tag() == "phantom")
-            setPhantom(node->value<bool>());
-        else if(node->tag() == "size")
-            setSize(node->value<Size>());
-        else if(node->tag() == "fixed-size")
-            setFixedSize(node->value<bool>());
-        else if(node->tag() == "clipping")
-            setClipping(node->value<bool>());
-        else if(node->tag() == "border") {
-            auto split = stdext::split(node->value(), " ");
-            if(split.size() == 2) {
-                setBorderWidth(stdext::safe_cast<int>(split[0]));
-                setBorderColor(stdext::safe_cast<Color>(split[1]));
-            } else
-                throw OTMLException(node, "border param must have its width followed by its color");
-        }
-        else if(node->tag() == "border-width")
-            setBorderWidth(node->value<int>());
-        else if(node->tag() == "border-width-top")
-            setBorderWidthTop(node->value<int>());
-        else if(node->tag() == "border-width-right")
-            setBorderWidthRight(node->value<int>());
-        else if(node->tag() == "border-width-bottom")
-            setBorderWidthBottom(node->value<int>());
-        else if(node->tag() == "border-width-left")
-            setBorderWidthLeft(node->value<int>());
-        else if(node->tag() == "border-color")
-            setBorderColor(node->value<Color>());
-        else if(node->tag() == "border-color-top")
-            setBorderColorTop(node->value<Color>());
-        else if(node->tag() == "border-color-right")
-            setBorderColorRight(node->value<Color>());
-        else if(node->tag() == "border-color-bottom")
-            setBorderColorBottom(node->value<Color>());
-        else if(node->tag() == "border-color-left")
-            setBorderColorLeft(node->value<Color>());
-        else if(node->tag() == "margin-top")
-            setMarginTop(node->value<int>());
-        else if(node->tag() == "margin-right")
-            setMarginRight(node->value<int>());
-        else if(node->tag() == "margin-bottom")
-            setMarginBottom(node->value<int>());
-        else if(node->tag() == "margin-left")
-            setMarginLeft(node->value<int>());
-        else if(node->tag() == "margin") {
-            std::string marginDesc = node->value();
-            std::vector<std::string> split = stdext::split(marginDesc, " ");
-            if(split.size() == 4) {
-                setMarginTop(stdext::safe_cast<int>(split[0]));
-                setMarginRight(stdext::safe_cast<int>(split[1]));
-                setMarginBottom(stdext::safe_cast<int>(split[2]));
-                setMarginLeft(stdext::safe_cast<int>(split[3]));
-            } else if(split.size() == 3) {
-                int marginTop = stdext::safe_cast<int>(split[0]);
-                int marginHorizontal = stdext::safe_cast<int>(split[1]);
-                int marginBottom = stdext::safe_cast<int>(split[2]);
-                setMarginTop(marginTop);
-                setMarginRight(marginHorizontal);
-                setMarginBottom(marginBottom);
-                setMarginLeft(marginHorizontal);
-            } else if(split.size() == 2) {
-                int marginVertical = stdext::safe_cast<int>(split[0]);
-                int marginHorizontal = stdext::safe_cast<int>(split[1]);
-                setMarginTop(marginVertical);
-                setMarginRight(marginHorizontal);
-                setMarginBottom(marginVertical);
-                setMarginLeft(marginHorizontal);
-            } else if(split.size() == 1) {
-                int margin = stdext::safe_cast<int>(split[0]);
-                setMarginTop(margin);
-                setMarginRight(margin);
-                setMarginBottom(margin);
-                setMarginLeft(margin);
+        switch(Fw::translateStyleProperty(node->tagId(), node->tag())) {
+            case Fw::StyleColor:
+                setColor(node->value<Color>());
+                break;
+            case Fw::StyleX:
+                setX(node->value<int>());
+                break;
+            case Fw::StyleY:
+                setY(node->value<int>());
+                break;
+            case Fw::StylePos:
+                setPosition(node->value<Point>());
+                break;
+            case Fw::StyleWidth:
+                setWidth(node->value<int>());
+                break;
+            case Fw::StyleHeight:
+                setHeight(node->value<int>());
+                break;
+            case Fw::StyleRect:
+                setRect(node->value<Rect>());
+                break;
+            case Fw::StyleBackground:
+                setBackgroundColor(node->value<Color>());
+                break;
+            case Fw::StyleBackgroundColor:
+                setBackgroundColor(node->value<Color>());
+                break;
+            case Fw::StyleBackgroundOffsetX:
+                setBackgroundOffsetX(node->value<int>());
+                break;
+            case Fw::StyleBackgroundOffsetY:
+                setBackgroundOffsetY(node->value<int>());
+                break;
+            case Fw::StyleBackgroundOffset:
+                setBackgroundOffset(node->value<Point>());
+                break;
+            case Fw::StyleBackgroundWidth:
+                setBackgroundWidth(node->value<int>());
+                break;
+            case Fw::StyleBackgroundHeight:
+                setBackgroundHeight(node->value<int>());
+                break;
+            case Fw::StyleBackgroundSize:
+                setBackgroundSize(node->value<Size>());
+                break;
+            case Fw::StyleBackgroundRect:
+                setBackgroundRect(node->value<Rect>());
+                break;
+            case Fw::StyleIcon:
+                setIcon(stdext::resolve_path(node->value(), node->source()));
+                break;
+            case Fw::StyleIconSource:
+                setIcon(stdext::resolve_path(node->value(), node->source()));
+                break;
+            case Fw::StyleIconColor:
+                setIconColor(node->value<Color>());
+                break;
+            case Fw::StyleIconOffsetX:
+                setIconOffsetX(node->value<int>());
+                break;
+            case Fw::StyleIconOffsetY:
+                setIconOffsetY(node->value<int>());
+                break;
+            case Fw::StyleIconOffset:
+                setIconOffset(node->value<Point>());
+                break;
+            case Fw::StyleIconWidth:
+                setIconWidth(node->value<int>());
+                break;
+            case Fw::StyleIconHeight:
+                setIconHeight(node->value<int>());
+                break;
+            case Fw::StyleIconSize:
+                setIconSize(node->value<Size>());
+                break;
+            case Fw::StyleIconRect:
+                setIconRect(node->value<Rect>());
+                break;
+            case Fw::StyleIconClip:
+                setIconClip(node->value<Rect>());
+                break;
+            case Fw::StyleIconAlign:
+                setIconAlign(Fw::translateAlignment(node->value()));
+                break;
+            case Fw::StyleOpacity:
+                setOpacity(node->value<float>());
+                break;
+            case Fw::StyleRotation:
+                setRotation(node->value<float>());
+                break;
+            case Fw::StyleRenderCache:
+                setRenderCache(node->value<bool>());
+                break;
+            case Fw::StyleEnabled:
+                setEnabled(node->value<bool>());
+                break;
+            case Fw::StyleVisible:
+                setVisible(node->value<bool>());
+                break;
+            case Fw::StyleChecked:
+                setChecked(node->value<bool>());
+                break;
+            case Fw::StyleDraggable:
+                setDraggable(node->value<bool>());
+                break;
+            case Fw::StyleOn:
+                setOn(node->value<bool>());
+                break;
+            case Fw::StyleFocusable:
+                setFocusable(node->value<bool>());
+                break;
+            case Fw::StyleAutoFocus:
+                setAutoFocusPolicy(Fw::translateAutoFocusPolicy(node->value()));
+                break;
+            case Fw::StylePhantom:
+                setPhantom(node->value<bool>());
+                break;
+            case Fw::StyleSize:
+                setSize(node->value<Size>());
+                break;
+            case Fw::StyleFixedSize:
+                setFixedSize(node->value<bool>());
+                break;
+            case Fw::StyleClipping:
+                setClipping(node->value<bool>());
+                break;
+            case Fw::StyleBorder: {
+                auto split = stdext::split(node->value(), " ");
+                if(split.size() == 2) {
+                    setBorderWidth(stdext::safe_cast<int>(split[0]));
+                    setBorderColor(stdext::safe_cast<Color>(split[1]));
+                } else
+                    throw OTMLException(node, "border param must have its width followed by its color");
+                break;
             }
-        }
-        else if(node->tag() == "padding-top")
-            setPaddingTop(node->value<int>());
-        else if(node->tag() == "padding-right")
-            setPaddingRight(node->value<int>());
-        else if(node->tag() == "padding-bottom")
-            setPaddingBottom(node->value<int>());
-        else if(node->tag() == "padding-left")
-            setPaddingLeft(node->value<int>());
-        else if(node->tag() == "padding") {
-            std::string paddingDesc = node->value();
-            std::vector<std::string> split = stdext::split(paddingDesc, " ");
-            if(split.size() == 4) {
-                setPaddingTop(stdext::safe_cast<int>(split[0]));
-                setPaddingRight(stdext::safe_cast<int>(split[1]));
-                setPaddingBottom(stdext::safe_cast<int>(split[2]));
-                setPaddingLeft(stdext::safe_cast<int>(split[3]));
-            } else if(split.size() == 3) {
-                int paddingTop = stdext::safe_cast<int>(split[0]);
-                int paddingHorizontal = stdext::safe_cast<int>(split[1]);
-                int paddingBottom = stdext::safe_cast<int>(split[2]);
-                setPaddingTop(paddingTop);
-                setPaddingRight(paddingHorizontal);
-                setPaddingBottom(paddingBottom);
-                setPaddingLeft(paddingHorizontal);
-            } else if(split.size() == 2) {
-                int paddingVertical = stdext::safe_cast<int>(split[0]);
-                int paddingHorizontal = stdext::safe_cast<int>(split[1]);
-                setPaddingTop(paddingVertical);
-                setPaddingRight(paddingHorizontal);
-                setPaddingBottom(paddingVertical);
-                setPaddingLeft(paddingHorizontal);
-            } else if(split.size() == 1) {
-                int padding = stdext::safe_cast<int>(split[0]);
-                setPaddingTop(padding);
-                setPaddingRight(padding);
-                setPaddingBottom(padding);
-                setPaddingLeft(padding);
+            case Fw::StyleBorderWidth:
+                setBorderWidth(node->value<int>());
+                break;
+            case Fw::StyleBorderWidthTop:
+                setBorderWidthTop(node->value<int>());
+                break;
+            case Fw::StyleBorderWidthRight:
+                setBorderWidthRight(node->value<int>());
+                break;
+            case Fw::StyleBorderWidthBottom:
+                setBorderWidthBottom(node->value<int>());
+                break;
+            case Fw::StyleBorderWidthLeft:
+                setBorderWidthLeft(node->value<int>());
+                break;
+            case Fw::StyleBorderColor:
+                setBorderColor(node->value<Color>());
+                break;
+            case Fw::StyleBorderColorTop:
+                setBorderColorTop(node->value<Color>());
+                break;
+            case Fw::StyleBorderColorRight:
+                setBorderColorRight(node->value<Color>());
+                break;
+            case Fw::StyleBorderColorBottom:
+                setBorderColorBottom(node->value<Color>());
+                break;
+            case Fw::StyleBorderColorLeft:
+                setBorderColorLeft(node->value<Color>());
+                break;
+            case Fw::StyleMarginTop:
+                setMarginTop(node->value<int>());
+                break;
+            case Fw::StyleMarginRight:
+                setMarginRight(node->value<int>());
+                break;
+            case Fw::StyleMarginBottom:
+                setMarginBottom(node->value<int>());
+                break;
+            case Fw::StyleMarginLeft:
+                setMarginLeft(node->value<int>());
+                break;
+            case Fw::StyleMargin: {
+                std::string marginDesc = node->value();
+                std::vector<std::string> split = stdext::split(marginDesc, " ");
+                if(split.size() == 4) {
+                    setMarginTop(stdext::safe_cast<int>(split[0]));
+                    setMarginRight(stdext::safe_cast<int>(split[1]));
+                    setMarginBottom(stdext::safe_cast<int>(split[2]));
+                    setMarginLeft(stdext::safe_cast<int>(split[3]));
+                } else if(split.size() == 3) {
+                    int marginTop = stdext::safe_cast<int>(split[0]);
+                    int marginHorizontal = stdext::safe_cast<int>(split[1]);
+                    int marginBottom = stdext::safe_cast<int>(split[2]);
+                    setMarginTop(marginTop);
+                    setMarginRight(marginHorizontal);
+                    setMarginBottom(marginBottom);
+                    setMarginLeft(marginHorizontal);
+                } else if(split.size() == 2) {
+                    int marginVertical = stdext::safe_cast<int>(split[0]);
+                    int marginHorizontal = stdext::safe_cast<int>(split[1]);
+                    setMarginTop(marginVertical);
+                    setMarginRight(marginHorizontal);
+                    setMarginBottom(marginVertical);
+                    setMarginLeft(marginHorizontal);
+                } else if(split.size() == 1) {
+                    int margin = stdext::safe_cast<int>(split[0]);
+                    setMarginTop(margin);
+                    setMarginRight(margin);
+                    setMarginBottom(margin);
+                    setMarginLeft(margin);
+                }
+                break;
             }
-        }
-        // layouts
-        else if(node->tag() == "layout") {
-            std::string layoutType;
-            if(node->hasValue())
-                layoutType = node->value();
-            else
-                layoutType = node->valueAt<std::string>("type", "");
-
-            if(!layoutType.empty()) {
-                UILayoutPtr layout;
-                if(layoutType == "horizontalBox")
-                    layout = UIHorizontalLayoutPtr(new UIHorizontalLayout(static_self_cast<UIWidget>()));
-                else if(layoutType == "verticalBox")
-                    layout = UIVerticalLayoutPtr(new UIVerticalLayout(static_self_cast<UIWidget>()));
-                else if(layoutType == "grid")
-                    layout = UIGridLayoutPtr(new UIGridLayout(static_self_cast<UIWidget>()));
-                else if(layoutType == "anchor")
-                    layout = UIAnchorLayoutPtr(new UIAnchorLayout(static_self_cast<UIWidget>()));
-                else
-                    throw OTMLException(node, "cannot determine layout type");
-                setLayout(layout);
+            case Fw::StylePaddingTop:
+                setPaddingTop(node->value<int>());
+                break;
+            case Fw::StylePaddingRight:
+                setPaddingRight(node->value<int>());
+                break;
+            case Fw::StylePaddingBottom:
+                setPaddingBottom(node->value<int>());
+                break;
+            case Fw::StylePaddingLeft:
+                setPaddingLeft(node->value<int>());
+                break;
+            case Fw::StylePadding: {
+                std::string paddingDesc = node->value();
+                std::vector<std::string> split = stdext::split(paddingDesc, " ");
+                if(split.size() == 4) {
+                    setPaddingTop(stdext::safe_cast<int>(split[0]));
+                    setPaddingRight(stdext::safe_cast<int>(split[1]));
+                    setPaddingBottom(stdext::safe_cast<int>(split[2]));
+                    setPaddingLeft(stdext::safe_cast<int>(split[3]));
+                } else if(split.size() == 3) {
+                    int paddingTop = stdext::safe_cast<int>(split[0]);
+                    int paddingHorizontal = stdext::safe_cast<int>(split[1]);
+                    int paddingBottom = stdext::safe_cast<int>(split[2]);
+                    setPaddingTop(paddingTop);
+                    setPaddingRight(paddingHorizontal);
+                    setPaddingBottom(paddingBottom);
+                    setPaddingLeft(paddingHorizontal);
+                } else if(split.size() == 2) {
+                    int paddingVertical = stdext::safe_cast<int>(split[0]);
+                    int paddingHorizontal = stdext::safe_cast<int>(split[1]);
+                    setPaddingTop(paddingVertical);
+                    setPaddingRight(paddingHorizontal);
+                    setPaddingBottom(paddingVertical);
+                    setPaddingLeft(paddingHorizontal);
+                } else if(split.size() == 1) {
+                    int padding = stdext::safe_cast<int>(split[0]);
+                    setPaddingTop(padding);
+                    setPaddingRight(padding);
+                    setPaddingBottom(padding);
+                    setPaddingLeft(padding);
+                }
+                break;
             }
-
-            if(node->hasChildren())
-                m_layout->applyStyle(node);
-        }
-        // anchors
-        else if(stdext::starts_with(node->tag(), "anchors.")) {
-            UIWidgetPtr parent = getParent();
-            if(!parent) {
-                if(m_firstOnStyle)
-                    throw OTMLException(node, "cannot create anchor, there is no parent widget!");
+            case Fw::StyleLayout: {
+                std::string layoutType;
+                if(node->hasValue())
+                    layoutType = node->value();
                 else
-                    continue;
-            }
+                    layoutType = node->valueAt<std::string>("type", "");
+
+                if(!layoutType.empty()) {
+                    UILayoutPtr layout;
+                    if(layoutType == "horizontalBox")
+                        layout = UIHorizontalLayoutPtr(new UIHorizontalLayout(static_self_cast<UIWidget>()));
+                    else if(layoutType == "verticalBox")
+                        layout = UIVerticalLayoutPtr(new UIVerticalLayout(static_self_cast<UIWidget>()));
+                    else if(layoutType == "grid")
+                        layout = UIGridLayoutPtr(new UIGridLayout(static_self_cast<UIWidget>()));
+                    else if(layoutType == "anchor")
+                        layout = UIAnchorLayoutPtr(new UIAnchorLayout(static_self_cast<UIWidget>()));
+                    else
+                        throw OTMLException(node, "cannot determine layout type");
+                    setLayout(layout);
+                }
 
-            UILayoutPtr layout = parent->getLayout();
-            UIAnchorLayoutPtr anchorLayout;
-            if(layout->isUIAnchorLayout())
-                anchorLayout = layout->static_self_cast<UIAnchorLayout>();
+                if(node->hasChildren())
+                    m_layout->applyStyle(node);
+                break;
+            }
+            case Fw::StyleAnchor: {
+                UIWidgetPtr parent = getParent();
+                if(!parent) {
+                    if(m_firstOnStyle)
+                        throw OTMLException(node, "cannot create anchor, there is no parent widget!");
+                    else
+                        break;
+                }
 
-            if(!anchorLayout)
-                throw OTMLException(node, "cannot create anchor, the parent widget doesn't use anchor layout!");
+                UILayoutPtr layout = parent->getLayout();
+                UIAnchorLayoutPtr anchorLayout;
+                if(layout->isUIAnchorLayout())
+                    anchorLayout = layout->static_self_cast<UIAnchorLayout>();
 
-            std::string what = node->tag().substr(8);
-            if(what == "fill") {
-                fill(node->value());
-            } else if(what == "centerIn") {
-                centerIn(node->value());
-            } else {
-                Fw::AnchorEdge anchoredEdge = Fw::translateAnchorEdge(what);
+                if(!anchorLayout)
+                    throw OTMLException(node, "cannot create anchor, the parent widget doesn't use anchor layout!");
 
-                if(node->value() == "none") {
-                    removeAnchor(anchoredEdge);
+                std::string what = node->tag().substr(8);
+                if(what == "fill") {
+                    fill(node->value());
+                } else if(what == "centerIn") {
+                    centerIn(node->value());
                 } else {
-                    std::vector<std::string> split = stdext::split(node->value(), ".");
-                    if(split.size() != 2)
-                        throw OTMLException(node, "invalid anchor description");
+                    Fw::AnchorEdge anchoredEdge = Fw::translateAnchorEdge(what);
+
+                    if(node->value() == "none") {
+                        removeAnchor(anchoredEdge);
+                    } else {
+                        std::vector<std::string> split = stdext::split(node->value(), ".");
+                        if(split.size() != 2)
+                            throw OTMLException(node, "invalid anchor description");
 
-                    std::string hookedWidgetId = split[0];
-                    Fw::AnchorEdge hookedEdge = Fw::translateAnchorEdge(split[1]);
+                        std::string hookedWidgetId = split[0];
+                        Fw::AnchorEdge hookedEdge = Fw::translateAnchorEdge(split[1]);
 
-                    if(anchoredEdge == Fw::AnchorNone)
-                        throw OTMLException(node, "invalid anchor edge");
+                        if(anchoredEdge == Fw::AnchorNone)
+                            throw OTMLException(node, "invalid anchor edge");
 
-                    if(hookedEdge == Fw::AnchorNone)
-                        throw OTMLException(node, "invalid anchor target edge");
+                        if(hookedEdge == Fw::AnchorNone)
+                            throw OTMLException(node, "invalid anchor target edge");
 
-                    addAnchor(anchoredEdge, hookedWidgetId, hookedEdge);
+                        addAnchor(anchoredEdge, hookedWidgetId, hookedEdge);
+                    }
                 }
+                break;
             }
+            default:
+                break;
         }
     }
 }
@@ -407,4 +477,5 @@ void UIWidget::setIcon(const std::string& iconFile)
         m_icon = g_textures.getTexture(iconFile);
     if(m_icon && !m_iconClipRect.isValid())
         m_iconClipRect = Rect(0, 0, m_icon->getSize());
+    invalidateRenderCache();
 }
@@ -21,6 +21,7 @@
  */
 
 #include "uiwidget.h"
+#include "uitranslator.h"
 #include <framework/graphics/painter.h>
 #include <framework/graphics/texture.h>
 #include <framework/graphics/texturemanager.h>
@@ -34,44 +35,67 @@ void UIWidget::initImage()
 void UIWidget::parseImageStyle(const OTMLNodePtr& styleNode)
 {
     for(const OTMLNodePtr& node : styleNode->children()) {
-        if(node->tag() == "image-source")
-            setImageSource(stdext::resolve_path(node->value(), node->source()));
-        else if(node->tag() == "image-offset-x")
-            setImageOffsetX(node->value<int>());
-        else if(node->tag() == "image-offset-y")
-            setImageOffsetY(node->value<int>());
-        else if(node->tag() == "image-offset")
-            setImageOffset(node->value<Point>());
-        else if(node->tag() == "image-width")
-            setImageWidth(node->value<int>());
-        else if(node->tag() == "image-height")
-            setImageHeight(node->value<int>());
-        else if(node->tag() == "image-size")
-            setImageSize(node->value<Size>());
-        else if(node->tag() == "image-rect")
-            setImageRect(node->value<Rect>());
-        else if(node->tag() == "image-clip")
-            setImageClip(node->value<Rect>());
-        else if(node->tag() == "image-fixed-ratio")
-            setImageFixedRatio(node->value<bool>());
-        else if(node->tag() == "image-repeated")
-            setImageRepeated(node->value<bool>());
-        else if(node->tag() == "image-smooth")
-            setImageSmooth(node->value<bool>());
-        else if(node->tag() == "image-color")
-            setImageColor(node->value<Color>());
-        else if(node->tag() == "image-border-top")
-            setImageBorderTop(node->value<int>());
-        else if(node->tag() == "image-border-right")
-            setImageBorderRight(node->value<int>());
-        else if(node->tag() == "image-border-bottom")
-            setImageBorderBottom(node->value<int>());
-        else if(node->tag() == "image-border-left")
-            setImageBorderLeft(node->value<int>());
-        else if(node->tag() == "image-border")
-            setImageBorder(node->value<int>());
-        else if(node->tag() == "image-auto-resize")
-            setImageAutoResize(node->value<bool>());
+        switch(Fw::translateStyleProperty(node->tagId(), node->tag())) {
+            case Fw::StyleImageSource:
+                setImageSource(stdext::resolve_path(node->value(), node->source()));
+                break;
+            case Fw::StyleImageOffsetX:
+                setImageOffsetX(node->value<int>());
+                break;
+            case Fw::StyleImageOffsetY:
+                setImageOffsetY(node->value<int>());
+                break;
+            case Fw::StyleImageOffset:
+                setImageOffset(node->value<Point>());
+                break;
+            case Fw::StyleImageWidth:
+                setImageWidth(node->value<int>());
+                break;
+            case Fw::StyleImageHeight:
+                setImageHeight(node->value<int>());
+                break;
+            case Fw::StyleImageSize:
+                setImageSize(node->value<Size>());
+                break;
+            case Fw::StyleImageRect:
+                setImageRect(node->value<Rect>());
+                break;
+            case Fw::StyleImageClip:
+                setImageClip(node->value<Rect>());
+                break;
+            case Fw::StyleImageFixedRatio:
+                setImageFixedRatio(node->value<bool>());
+                break;
+            case Fw::StyleImageRepeated:
+                setImageRepeated(node->value<bool>());
+                break;
+            case Fw::StyleImageSmooth:
+                setImageSmooth(node->value<bool>());
+                break;
+            case Fw::StyleImageColor:
+                setImageColor(node->value<Color>());
+                break;
+            case Fw::StyleImageBorderTop:
+                setImageBorderTop(node->value<int>());
+                break;
+            case Fw::StyleImageBorderRight:
+                setImageBorderRight(node->value<int>());
+                break;
+            case Fw::StyleImageBorderBottom:
+                setImageBorderBottom(node->value<int>());
+                break;
+            case Fw::StyleImageBorderLeft:
+                setImageBorderLeft(node->value<int>());
+                break;
+            case Fw::StyleImageBorder:
+                setImageBorder(node->value<int>());
+                break;
+            case Fw::StyleImageAutoResize:
+                setImageAutoResize(node->value<bool>());
+                break;
+            default:
+                break;
+        }
     }
 }
 
@@ -173,6 +197,10 @@ void UIWidget::drawImage(const Rect& screenCoords)
 
     g_painter->setColor(m_imageColor);
     g_painter->drawTextureCoords(m_imageCoordsBuffer, m_imageTexture);
+
+    // animated images must be drawn again on the next frame
+    if(m_imageTexture->isAnimatedTexture())
+        invalidateRenderCache();
 }
 
 void UIWidget::setImageSource(const std::string& source)
@@ -181,6 +209,7 @@ void UIWidget::setImageSource(const std::string& source)
         m_imageTexture = nullptr;
     else
         m_imageTexture = g_textures.getTexture(source);
+    invalidateRenderCache();
 
     if(m_imageTexture && (!m_rect.isValid() || m_imageAutoResize)) {
         Size size = getSize();
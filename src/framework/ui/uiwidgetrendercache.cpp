@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "uiwidget.h"
+#include "uimanager.h"
+#include <framework/graphics/painter.h>
+#include <framework/graphics/graphics.h>
+#include <framework/graphics/framebuffer.h>
+#include <framework/graphics/framebuffermanager.h>
+
+void UIWidget::setRenderCache(bool enable)
+{
+    if(m_renderCache == enable)
+        return;
+
+    m_renderCache = enable;
+    m_renderCacheDirty = true;
+    if(enable)
+        g_ui.m_renderCaches++;
+    else {
+        g_ui.m_renderCaches--;
+        m_renderCacheBuffer = nullptr;
+    }
+
+    // a cached ancestor holds a picture of this widget too
+    invalidateRenderCache();
+}
+
+void UIWidget::invalidateRenderCache()
+{
+    // nothing to do while no widget is caching
+    if(g_ui.m_renderCaches == 0)
+        return;
+
+    for(UIWidget *widget = this; widget; widget = widget->m_parent.get()) {
+        if(widget->m_renderCache && !widget->m_renderCacheDirty) {
+            widget->m_renderCacheDirty = true;
+            g_ui.m_renderCacheInvalidations++;
+        }
+    }
+}
+
+void UIWidget::drawRenderCache(const Rect& visibleRect)
+{
+    if(!m_renderCacheBuffer) {
+        m_renderCacheBuffer = g_framebuffers.createFrameBuffer();
+        m_renderCacheBuffer->setSmooth(false);
+        m_renderCacheDirty = true;
+    }
+
+    if(m_renderCacheDirty || m_renderCacheBuffer->getSize() != m_rect.size()) {
+        // cleared first so invalidations raised while drawing, like animations, stick for the next frame
+        m_renderCacheDirty = false;
+        m_renderCacheBuffer->resize(m_rect.size());
+        m_renderCacheBuffer->bind();
+        g_painter->setAlphaWriting(true);
+        g_painter->clear(Color::alpha);
+        g_painter->translate(-m_rect.left(), -m_rect.top());
+        g_painter->setClipOffset(m_rect.topLeft());
+
+        m_renderCacheDrawing = true;
+        draw(m_rect, Fw::ForegroundPane);
+        m_renderCacheDrawing = false;
+
+        m_renderCacheBuffer->release();
+        g_ui.m_renderCacheRenders++;
+    } else
+        g_ui.m_renderCacheHits++;
+
+    // the cache was blended onto a transparent target, its colors already carry their alpha,
+    // so the painter opacity has to fade the colors as well and not only the alpha
+    Painter::CompositionMode oldCompositionMode = g_painter->getCompositionMode();
+    Color oldColor = g_painter->getColor();
+    float opacity = g_painter->getOpacity();
+    g_painter->setCompositionMode(Painter::CompositionMode_Premultiplied);
+    g_painter->setColor(Color(opacity, opacity, opacity, opacity));
+    g_painter->resetOpacity();
+    m_renderCacheBuffer->draw(visibleRect, Rect(visibleRect.topLeft() - m_rect.topLeft(), visibleRect.size()));
+    g_painter->setOpacity(opacity);
+    g_painter->setColor(oldColor);
+    g_painter->setCompositionMode(oldCompositionMode);
+}
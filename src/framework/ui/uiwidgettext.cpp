@@ -54,29 +54,43 @@ void UIWidget::updateText()
     }
 
     m_textMustRecache = true;
+    invalidateRenderCache();
 }
 
 void UIWidget::parseTextStyle(const OTMLNodePtr& styleNode)
 {
     for(const OTMLNodePtr& node : styleNode->children()) {
-        if(node->tag() == "text")
-            setText(node->value());
-        else if(node->tag() == "text-align")
-            setTextAlign(Fw::translateAlignment(node->value()));
-        else if(node->tag() == "text-offset")
-            setTextOffset(node->value<Point>());
-        else if(node->tag() == "text-wrap")
-            setTextWrap(node->value<bool>());
-        else if(node->tag() == "text-auto-resize")
-            setTextAutoResize(node->value<bool>());
-        else if(node->tag() == "text-horizontal-auto-resize")
-            setTextHorizontalAutoResize(node->value<bool>());
-        else if(node->tag() == "text-vertical-auto-resize")
-            setTextVerticalAutoResize(node->value<bool>());
-        else if(node->tag() == "text-only-upper-case")
-            setTextOnlyUpperCase(node->value<bool>());
-        else if(node->tag() == "font")
-            setFont(node->value());
+        switch(Fw::translateStyleProperty(node->tagId(), node->tag())) {
+            case Fw::StyleText:
+                setText(node->value());
+                break;
+            case Fw::StyleTextAlign:
+                setTextAlign(Fw::translateAlignment(node->value()));
+                break;
+            case Fw::StyleTextOffset:
+                setTextOffset(node->value<Point>());
+                break;
+            case Fw::StyleTextWrap:
+                setTextWrap(node->value<bool>());
+                break;
+            case Fw::StyleTextAutoResize:
+                setTextAutoResize(node->value<bool>());
+                break;
+            case Fw::StyleTextHorizontalAutoResize:
+                setTextHorizontalAutoResize(node->value<bool>());
+                break;
+            case Fw::StyleTextVerticalAutoResize:
+                setTextVerticalAutoResize(node->value<bool>());
+                break;
+            case Fw::StyleTextOnlyUpperCase:
+                setTextOnlyUpperCase(node->value<bool>());
+                break;
+            case Fw::StyleFont:
+                setFont(node->value());
+                break;
+            default:
+                break;
+        }
     }
 }
 
@@ -105,6 +119,7 @@ void UIWidget::drawText(const Rect& screenCoords)
 
 void UIWidget::onTextChange(const std::string& text, const std::string& oldText)
 {
+    invalidateRenderCache();
     g_app.repaint();
     callLuaField("onTextChange", text, oldText);
 }
@@ -54,6 +54,7 @@ Crypt::Crypt()
 #else
     m_rsa = RSA_new();
 #endif
+    initXtea();
 }
 
 Crypt::~Crypt()
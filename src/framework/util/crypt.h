@@ -25,6 +25,8 @@
 
 #include "../stdext/types.h"
 #include <string>
+#include <vector>
+#include <map>
 
 #include <boost/uuid/uuid.hpp>
 #ifdef USE_GMP
@@ -54,11 +56,22 @@ public:
     bool rsaDecrypt(unsigned char *msg, int size);
     int rsaGetSize();
 
+    void xteaEncrypt(uint8* buffer, size_t size, const uint32* key);
+    void xteaDecrypt(uint8* buffer, size_t size, const uint32* key);
+    bool setXteaImplementation(const std::string& name);
+    std::string getXteaImplementation();
+    std::vector<std::string> getXteaImplementations();
+    bool xteaSelfTest();
+    std::map<std::string, double> xteaBenchmark(int size);
+
 private:
+    void initXtea();
+
     std::string _encrypt(const std::string& decrypted_string, bool useMachineUUID);
     std::string _decrypt(const std::string& encrypted_string, bool useMachineUUID);
     std::string getCryptKey(bool useMachineUUID);
     boost::uuids::uuid m_machineUUID;
+    int m_xteaImplementation;
 #ifdef USE_GMP
     mpz_t m_p, m_q, m_n, m_e, m_d;
 #else
@@ -0,0 +1,325 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "crypt.h"
+#include <framework/core/logger.h>
+#include <framework/stdext/time.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define XTEA_X86
+#include <immintrin.h>
+#endif
+
+// rounds of the game protocol XTEA, blocks are two native endian 32 bit words
+static const int XTEA_ROUNDS = 32;
+static const uint32 XTEA_DELTA = 0x61C88647;
+static const uint32 XTEA_DECRYPT_SUM = 0xC6EF3720;
+
+enum XteaImplementation {
+    XteaScalar = 0,
+    XteaSSE2,
+    XteaAVX2,
+    XteaLastImplementation
+};
+
+static const char* xteaImplementationNames[XteaLastImplementation] = { "scalar", "sse2", "avx2" };
+
+// the sum and key words only depend on the round, so both are added up front for all blocks
+struct XteaSchedule {
+    uint32 first[XTEA_ROUNDS];
+    uint32 second[XTEA_ROUNDS];
+};
+
+static void xteaEncryptSchedule(XteaSchedule& schedule, const uint32* key)
+{
+    uint32 sum = 0;
+    for(int i = 0; i < XTEA_ROUNDS; ++i) {
+        schedule.first[i] = sum + key[sum & 3];
+        sum -= XTEA_DELTA;
+        schedule.second[i] = sum + key[sum >> 11 & 3];
+    }
+}
+
+static void xteaDecryptSchedule(XteaSchedule& schedule, const uint32* key)
+{
+    uint32 sum = XTEA_DECRYPT_SUM;
+    for(int i = 0; i < XTEA_ROUNDS; ++i) {
+        schedule.first[i] = sum + key[sum >> 11 & 3];
+        sum += XTEA_DELTA;
+        schedule.second[i] = sum + key[sum & 3];
+    }
+}
+
+static void xteaEncryptScalar(uint32* buffer, size_t blocks, const XteaSchedule& schedule)
+{
+    for(size_t block = 0; block < blocks; ++block, buffer += 2) {
+        uint32 v0 = buffer[0], v1 = buffer[1];
+        for(int i = 0; i < XTEA_ROUNDS; ++i) {
+            v0 += ((v1 << 4 ^ v1 >> 5) + v1) ^ schedule.first[i];
+            v1 += ((v0 << 4 ^ v0 >> 5) + v0) ^ schedule.second[i];
+        }
+        buffer[0] = v0; buffer[1] = v1;
+    }
+}
+
+static void xteaDecryptScalar(uint32* buffer, size_t blocks, const XteaSchedule& schedule)
+{
+    for(size_t block = 0; block < blocks; ++block, buffer += 2) {
+        uint32 v0 = buffer[0], v1 = buffer[1];
+        for(int i = 0; i < XTEA_ROUNDS; ++i) {
+            v1 -= ((v0 << 4 ^ v0 >> 5) + v0) ^ schedule.first[i];
+            v0 -= ((v1 << 4 ^ v1 >> 5) + v1) ^ schedule.second[i];
+        }
+        buffer[0] = v0; buffer[1] = v1;
+    }
+}
+
+#ifdef XTEA_X86
+// 4 blocks per iteration, the first words of every block are gathered in one register and the second ones in another
+__attribute__((target("sse2")))
+static size_t xteaCryptSSE2(uint32* buffer, size_t blocks, const XteaSchedule& schedule, bool encrypt)
+{
+    size_t done = 0;
+    for(; done + 4 <= blocks; done += 4, buffer += 8) {
+        __m128i a = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)buffer), _MM_SHUFFLE(3, 1, 2, 0));
+        __m128i b = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(buffer + 4)), _MM_SHUFFLE(3, 1, 2, 0));
+        __m128i v0 = _mm_unpacklo_epi64(a, b);
+        __m128i v1 = _mm_unpackhi_epi64(a, b);
+
+        if(encrypt) {
+            for(int i = 0; i < XTEA_ROUNDS; ++i) {
+                __m128i f = _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v1, 4), _mm_srli_epi32(v1, 5)), v1);
+                v0 = _mm_add_epi32(v0, _mm_xor_si128(f, _mm_set1_epi32(schedule.first[i])));
+                f = _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v0, 4), _mm_srli_epi32(v0, 5)), v0);
+                v1 = _mm_add_epi32(v1, _mm_xor_si128(f, _mm_set1_epi32(schedule.second[i])));
+            }
+        } else {
+            for(int i = 0; i < XTEA_ROUNDS; ++i) {
+                __m128i f = _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v0, 4), _mm_srli_epi32(v0, 5)), v0);
+                v1 = _mm_sub_epi32(v1, _mm_xor_si128(f, _mm_set1_epi32(schedule.first[i])));
+                f = _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v1, 4), _mm_srli_epi32(v1, 5)), v1);
+                v0 = _mm_sub_epi32(v0, _mm_xor_si128(f, _mm_set1_epi32(schedule.second[i])));
+            }
+        }
+
+        a = _mm_shuffle_epi32(_mm_unpacklo_epi64(v0, v1), _MM_SHUFFLE(3, 1, 2, 0));
+        b = _mm_shuffle_epi32(_mm_unpackhi_epi64(v0, v1), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_si128((__m128i*)buffer, a);
+        _mm_storeu_si128((__m128i*)(buffer + 4), b);
+    }
+    return done;
+}
+
+// same as above with 8 blocks, the shuffles work inside each 128 bit lane and undo each other
+__attribute__((target("avx2")))
+static size_t xteaCryptAVX2(uint32* buffer, size_t blocks, const XteaSchedule& schedule, bool encrypt)
+{
+    size_t done = 0;
+    for(; done + 8 <= blocks; done += 8, buffer += 16) {
+        __m256i a = _mm256_shuffle_epi32(_mm256_loadu_si256((const __m256i*)buffer), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i b = _mm256_shuffle_epi32(_mm256_loadu_si256((const __m256i*)(buffer + 8)), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i v0 = _mm256_unpacklo_epi64(a, b);
+        __m256i v1 = _mm256_unpackhi_epi64(a, b);
+
+        if(encrypt) {
+            for(int i = 0; i < XTEA_ROUNDS; ++i) {
+                __m256i f = _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v1, 4), _mm256_srli_epi32(v1, 5)), v1);
+                v0 = _mm256_add_epi32(v0, _mm256_xor_si256(f, _mm256_set1_epi32(schedule.first[i])));
+                f = _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v0, 4), _mm256_srli_epi32(v0, 5)), v0);
+                v1 = _mm256_add_epi32(v1, _mm256_xor_si256(f, _mm256_set1_epi32(schedule.second[i])));
+            }
+        } else {
+            for(int i = 0; i < XTEA_ROUNDS; ++i) {
+                __m256i f = _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v0, 4), _mm256_srli_epi32(v0, 5)), v0);
+                v1 = _mm256_sub_epi32(v1, _mm256_xor_si256(f, _mm256_set1_epi32(schedule.first[i])));
+                f = _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v1, 4), _mm256_srli_epi32(v1, 5)), v1);
+                v0 = _mm256_sub_epi32(v0, _mm256_xor_si256(f, _mm256_set1_epi32(schedule.second[i])));
+            }
+        }
+
+        a = _mm256_shuffle_epi32(_mm256_unpacklo_epi64(v0, v1), _MM_SHUFFLE(3, 1, 2, 0));
+        b = _mm256_shuffle_epi32(_mm256_unpackhi_epi64(v0, v1), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i*)buffer, a);
+        _mm256_storeu_si256((__m256i*)(buffer + 8), b);
+    }
+    return done;
+}
+#endif
+
+static bool isXteaImplementationSupported(int implementation)
+{
+    switch(implementation) {
+    case XteaScalar:
+        return true;
+#ifdef XTEA_X86
+    case XteaSSE2:
+        return __builtin_cpu_supports("sse2");
+    case XteaAVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+static void xteaCrypt(int implementation, uint8* buffer, size_t size, const uint32* key, bool encrypt)
+{
+    XteaSchedule schedule;
+    if(encrypt)
+        xteaEncryptSchedule(schedule, key);
+    else
+        xteaDecryptSchedule(schedule, key);
+
+    uint32* words = (uint32*)buffer;
+    size_t blocks = size / 8;
+    size_t done = 0;
+#ifdef XTEA_X86
+    if(implementation == XteaAVX2)
+        done = xteaCryptAVX2(words, blocks, schedule, encrypt);
+    if(implementation >= XteaSSE2)
+        done += xteaCryptSSE2(words + done * 2, blocks - done, schedule, encrypt);
+#endif
+
+    // remaining blocks that don't fill a whole vector
+    if(encrypt)
+        xteaEncryptScalar(words + done * 2, blocks - done, schedule);
+    else
+        xteaDecryptScalar(words + done * 2, blocks - done, schedule);
+}
+
+void Crypt::initXtea()
+{
+#ifdef XTEA_X86
+    // cpu detection may be used before global constructors ran
+    __builtin_cpu_init();
+#endif
+    m_xteaImplementation = XteaScalar;
+    for(int implementation = XteaLastImplementation - 1; implementation > XteaScalar; --implementation) {
+        if(isXteaImplementationSupported(implementation)) {
+            m_xteaImplementation = implementation;
+            break;
+        }
+    }
+}
+
+void Crypt::xteaEncrypt(uint8* buffer, size_t size, const uint32* key)
+{
+    xteaCrypt(m_xteaImplementation, buffer, size, key, true);
+}
+
+void Crypt::xteaDecrypt(uint8* buffer, size_t size, const uint32* key)
+{
+    xteaCrypt(m_xteaImplementation, buffer, size, key, false);
+}
+
+bool Crypt::setXteaImplementation(const std::string& name)
+{
+    for(int implementation = XteaScalar; implementation < XteaLastImplementation; ++implementation) {
+        if(name == xteaImplementationNames[implementation]) {
+            if(!isXteaImplementationSupported(implementation)) {
+                g_logger.error(stdext::format("xtea implementation '%s' is not supported by this cpu", name));
+                return false;
+            }
+            m_xteaImplementation = implementation;
+            return true;
+        }
+    }
+    g_logger.error(stdext::format("unknown xtea implementation '%s'", name));
+    return false;
+}
+
+std::string Crypt::getXteaImplementation()
+{
+    return xteaImplementationNames[m_xteaImplementation];
+}
+
+std::vector<std::string> Crypt::getXteaImplementations()
+{
+    std::vector<std::string> implementations;
+    for(int implementation = XteaScalar; implementation < XteaLastImplementation; ++implementation) {
+        if(isXteaImplementationSupported(implementation))
+            implementations.push_back(xteaImplementationNames[implementation]);
+    }
+    return implementations;
+}
+
+bool Crypt::xteaSelfTest()
+{
+    // the first block is the published XTEA vector 4142434445464748 -> 497DF3D072612CB5, read as words
+    static const uint32 key[4] = { 0x00010203, 0x04050607, 0x08090A0B, 0x0C0D0E0F };
+    static const uint32 plain[4] = { 0x41424344, 0x45464748, 0x00000000, 0xFFFFFFFF };
+    static const uint32 cipher[4] = { 0x497DF3D0, 0x72612CB5, 0x4EF17F25, 0x0FCFBDD9 };
+
+    bool ok = true;
+    for(int implementation = XteaScalar; implementation < XteaLastImplementation; ++implementation) {
+        if(!isXteaImplementationSupported(implementation))
+            continue;
+
+        // the known blocks are repeated so every vector width and the scalar tail get to see them
+        std::vector<uint32> buffer;
+        for(int i = 0; i < 19; ++i)
+            buffer.insert(buffer.end(), plain, plain + 4);
+
+        xteaCrypt(implementation, (uint8*)buffer.data(), buffer.size() * 4, key, true);
+        bool encrypted = true;
+        for(size_t i = 0; i < buffer.size(); ++i)
+            encrypted = encrypted && buffer[i] == cipher[i % 4];
+
+        xteaCrypt(implementation, (uint8*)buffer.data(), buffer.size() * 4, key, false);
+        bool decrypted = true;
+        for(size_t i = 0; i < buffer.size(); ++i)
+            decrypted = decrypted && buffer[i] == plain[i % 4];
+
+        if(!encrypted || !decrypted) {
+            g_logger.error(stdext::format("xtea implementation '%s' failed the self test", xteaImplementationNames[implementation]));
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+std::map<std::string, double> Crypt::xteaBenchmark(int size)
+{
+    std::map<std::string, double> result;
+    size = std::max<int>(size / 8, 1) * 8;
+
+    static const uint32 key[4] = { 0x9E3779B9, 0x7F4A7C15, 0xF39CC060, 0x5CEDC834 };
+    std::vector<uint8> buffer(size);
+    for(int i = 0; i < size; ++i)
+        buffer[i] = (uint8)(i * 31);
+
+    // megabytes per second of encrypt plus decrypt, running each for about a tenth of a second
+    for(int implementation = XteaScalar; implementation < XteaLastImplementation; ++implementation) {
+        if(!isXteaImplementationSupported(implementation))
+            continue;
+
+        stdext::timer timer;
+        double bytes = 0;
+        while(timer.elapsed_seconds() < 0.1f) {
+            xteaCrypt(implementation, buffer.data(), size, key, true);
+            xteaCrypt(implementation, buffer.data(), size, key, false);
+            bytes += size * 2;
+        }
+        result[xteaImplementationNames[implementation]] = bytes / timer.elapsed_seconds() / (1024 * 1024);
+    }
+    return result;
+}